@@ -0,0 +1,259 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "app/cycles_distributed.h"
+
+#include "session/merge.h"
+
+#include "util/algorithm.h"
+#include "util/path.h"
+#include "util/task.h"
+
+#ifdef _WIN32
+#  include <process.h>
+#else
+#  include <sys/wait.h>
+#  include <unistd.h>
+#endif
+
+CCL_NAMESPACE_BEGIN
+
+#ifdef _WIN32
+/* Quote an argument for the command line of a new process, which Windows passes as a single
+ * string that the C runtime of the process splits into arguments again. Backslashes only need
+ * escaping when they precede a double quote. */
+static string quote_argument(const string &arg)
+{
+  if (!arg.empty() && arg.find_first_of(" \t\n\v\"") == string::npos) {
+    return arg;
+  }
+
+  string result = "\"";
+  size_t num_backslashes = 0;
+  for (const char c : arg) {
+    if (c == '\\') {
+      num_backslashes++;
+      continue;
+    }
+    if (c == '"') {
+      /* Escape the preceding backslashes and the quote itself. */
+      result.append(num_backslashes * 2 + 1, '\\');
+    }
+    else {
+      result.append(num_backslashes, '\\');
+    }
+    num_backslashes = 0;
+    result += c;
+  }
+  /* Escape trailing backslashes, so they do not escape the closing quote. */
+  result.append(num_backslashes * 2, '\\');
+  return result + "\"";
+}
+#endif
+
+DistributedRender::DistributedRender(const DistributedRenderParams &params, LogFunction log)
+    : params_(params), log_(log)
+{
+}
+
+bool DistributedRender::spawn(Worker &worker)
+{
+  vector<string> args;
+  args.push_back(params_.executable);
+  args.insert(args.end(), params_.args.begin(), params_.args.end());
+  args.push_back("--samples");
+  args.push_back(to_string(worker.samples));
+  args.push_back("--sample-offset");
+  args.push_back(to_string(worker.sample_offset));
+  args.push_back("--threads");
+  args.push_back(to_string(worker.threads));
+  args.push_back("--output");
+  args.push_back(worker.output_filepath);
+  args.push_back("--quiet");
+  /* Workers never open a window, whatever the coordinator was started with. */
+  args.push_back("--background");
+
+#ifdef _WIN32
+  for (string &arg : args) {
+    arg = quote_argument(arg);
+  }
+#endif
+
+  vector<char *> argv;
+  for (string &arg : args) {
+    argv.push_back(const_cast<char *>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+
+#ifdef _WIN32
+  worker.process = _spawnvp(_P_NOWAIT, params_.executable.c_str(), argv.data());
+  if (worker.process == -1) {
+    worker.process = 0;
+    error = "Failed to start worker process " + params_.executable;
+    return false;
+  }
+#else
+  const pid_t pid = fork();
+  if (pid == 0) {
+    execvp(argv[0], argv.data());
+    /* Only reached if the executable could not be started. */
+    _exit(EXIT_FAILURE);
+  }
+  if (pid < 0) {
+    error = "Failed to start worker process " + params_.executable;
+    return false;
+  }
+  worker.process = pid;
+#endif
+
+  return true;
+}
+
+bool DistributedRender::wait_any(int &worker_index)
+{
+  int status = 0;
+
+#ifdef _WIN32
+  /* Wait in order of the workers, merging still happens while later workers are rendering. */
+  worker_index = -1;
+  for (int i = 0; i < workers_.size(); i++) {
+    if (workers_[i].process) {
+      worker_index = i;
+      break;
+    }
+  }
+  if (worker_index == -1 || _cwait(&status, workers_[worker_index].process, _WAIT_CHILD) == -1) {
+    error = "Failed to wait for worker process";
+    return false;
+  }
+  workers_[worker_index].process = 0;
+  const bool success = (status == 0);
+#else
+  const pid_t pid = waitpid(-1, &status, 0);
+  if (pid <= 0) {
+    error = "Failed to wait for worker process";
+    return false;
+  }
+
+  worker_index = -1;
+  for (int i = 0; i < workers_.size(); i++) {
+    if (workers_[i].process == pid) {
+      worker_index = i;
+      break;
+    }
+  }
+  if (worker_index == -1) {
+    /* Not one of our workers. */
+    return wait_any(worker_index);
+  }
+  workers_[worker_index].process = 0;
+  const bool success = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+
+  if (!success) {
+    error = string_printf("Worker %d failed to render samples %d to %d",
+                          worker_index,
+                          workers_[worker_index].sample_offset,
+                          workers_[worker_index].sample_offset + workers_[worker_index].samples);
+    return false;
+  }
+
+  return true;
+}
+
+bool DistributedRender::merge(const Worker &worker)
+{
+  /* Merge into the output image as parts arrive, so that the coordinator never holds more than
+   * two images and a partial result is available while workers are still rendering. */
+  ImageMerger merger;
+  if (num_merged_ > 0) {
+    merger.input.push_back(params_.output_filepath);
+  }
+  merger.input.push_back(worker.output_filepath);
+  merger.output = params_.output_filepath;
+
+  if (!merger.run()) {
+    error = merger.error;
+    return false;
+  }
+
+  path_remove(worker.output_filepath);
+  num_merged_++;
+
+  log_(string_printf("Merged %d/%d parts into %s",
+                     num_merged_,
+                     (int)workers_.size(),
+                     params_.output_filepath.c_str()));
+  return true;
+}
+
+bool DistributedRender::run()
+{
+  if (!string_endswith(string_to_lower(params_.output_filepath), ".exr")) {
+    error = "Rendering with multiple workers requires an EXR output file path";
+    return false;
+  }
+  if (params_.samples < 1) {
+    error = "Rendering with multiple workers requires a number of samples";
+    return false;
+  }
+
+  /* Shared directory for the parts rendered by each worker. */
+  const string parts_dir = params_.output_filepath + ".parts";
+
+  const int num_workers = min(params_.num_workers, params_.samples);
+  const int total_threads = (params_.threads > 0) ? params_.threads :
+                                                    TaskScheduler::max_concurrency();
+
+  for (int i = 0; i < num_workers; i++) {
+    const int range_start = (params_.samples * i) / num_workers;
+    const int range_end = (params_.samples * (i + 1)) / num_workers;
+
+    Worker worker;
+    worker.sample_offset = params_.sample_offset + range_start;
+    worker.samples = range_end - range_start;
+    worker.threads = max(total_threads / num_workers, 1);
+    worker.output_filepath = path_join(parts_dir, string_printf("part_%04d.exr", i));
+    workers_.push_back(worker);
+  }
+
+  /* Creates the parent directory of the part files. */
+  path_create_directories(workers_[0].output_filepath);
+
+  log_(string_printf("Rendering %d samples with %d workers of %d threads",
+                     params_.samples,
+                     num_workers,
+                     workers_[0].threads));
+
+  bool success = true;
+  int num_running = 0;
+  for (Worker &worker : workers_) {
+    if (!spawn(worker)) {
+      success = false;
+      break;
+    }
+    num_running++;
+  }
+
+  /* Wait for all started workers, even after a failure so no processes are left behind. */
+  for (; num_running > 0; num_running--) {
+    int worker_index;
+    if (!wait_any(worker_index)) {
+      success = false;
+      continue;
+    }
+
+    if (success && !merge(workers_[worker_index])) {
+      success = false;
+    }
+  }
+
+  if (success) {
+    path_remove(parts_dir);
+  }
+
+  return success;
+}
+
+CCL_NAMESPACE_END
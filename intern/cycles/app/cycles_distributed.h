@@ -0,0 +1,75 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __CYCLES_DISTRIBUTED_H__
+#define __CYCLES_DISTRIBUTED_H__
+
+#include "util/function.h"
+#include "util/string.h"
+#include "util/types.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Render a single frame with multiple worker processes.
+ *
+ * The samples of the frame are split into contiguous ranges, one per worker. Every worker is a
+ * separate background process of the standalone executable that renders its sample range into an
+ * EXR with sample count metadata, in a directory shared with the coordinator. Parts are merged
+ * into the output image as soon as the worker that rendered them finishes, weighted by their
+ * number of samples. */
+
+struct DistributedRenderParams {
+  /* Executable to run for workers. */
+  string executable;
+  /* Arguments passed to every worker, in addition to the per-worker sample range, thread count
+   * and output file path. */
+  vector<string> args;
+
+  /* Output file path of the merged image, must be an EXR file. */
+  string output_filepath;
+
+  int num_workers = 0;
+  int samples = 0;
+  /* Index of the first sample of the whole render, the ranges of the workers start from it. */
+  int sample_offset = 0;
+  /* Total number of threads to distribute over the workers, 0 to use all. */
+  int threads = 0;
+};
+
+class DistributedRender {
+ public:
+  typedef function<void(const string &)> LogFunction;
+
+  DistributedRender(const DistributedRenderParams &params, LogFunction log);
+
+  bool run();
+
+  /* Error message after running, in case of failure. */
+  string error;
+
+ protected:
+  struct Worker {
+    int sample_offset;
+    int samples;
+    int threads;
+    string output_filepath;
+    /* Process handle or identifier. */
+    intptr_t process = 0;
+  };
+
+  bool spawn(Worker &worker);
+  bool wait_any(int &worker_index);
+  bool merge(const Worker &worker);
+
+  DistributedRenderParams params_;
+  LogFunction log_;
+
+  vector<Worker> workers_;
+  int num_merged_ = 0;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __CYCLES_DISTRIBUTED_H__ */
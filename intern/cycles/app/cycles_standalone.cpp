@@ -28,6 +28,7 @@
 #  include "hydra/file_reader.h"
 #endif
 
+#include "app/cycles_distributed.h"
 #include "app/cycles_xml.h"
 #include "app/oiio_output_driver.h"
 
@@ -49,6 +50,10 @@ struct Options {
   bool show_help, interactive, pause;
   string output_filepath;
   string output_pass;
+  int workers;
+  /* Arguments for worker processes when rendering with multiple workers. */
+  string executable;
+  vector<string> worker_args;
 } options;
 
 static void session_print(const string &str)
@@ -139,8 +144,10 @@ static void session_init()
 #endif
 
   if (!options.output_filepath.empty()) {
-    options.session->set_output_driver(make_unique<OIIOOutputDriver>(
-        options.output_filepath, options.output_pass, session_print));
+    unique_ptr<OIIOOutputDriver> output_driver = make_unique<OIIOOutputDriver>(
+        options.output_filepath, options.output_pass, session_print);
+    output_driver->set_samples(options.session_params.samples);
+    options.session->set_output_driver(std::move(output_driver));
   }
 
   if (options.session_params.background && !options.quiet) {
@@ -348,6 +355,53 @@ static void keyboard(unsigned char key)
 }
 #endif
 
+static bool distributed_render()
+{
+  DistributedRenderParams params;
+  params.executable = options.executable;
+  params.args = options.worker_args;
+  params.output_filepath = options.output_filepath;
+  params.num_workers = options.workers;
+  params.samples = options.session_params.samples;
+  params.sample_offset = options.session_params.sample_offset;
+  params.threads = options.session_params.threads;
+
+  DistributedRender render(params, [](const string &str) {
+    if (!options.quiet) {
+      printf("%s\n", str.c_str());
+    }
+  });
+
+  if (!render.run()) {
+    fprintf(stderr, "%s\n", render.error.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+/* Arguments for worker processes, which are the same as for the coordinator except for the
+ * options that the coordinator sets per worker. */
+static void worker_args_init(int argc, const char **argv)
+{
+  options.executable = argv[0];
+  options.worker_args.clear();
+
+  for (int i = 1; i < argc; i++) {
+    const string arg = argv[i];
+    if (arg == "--workers" || arg == "--samples" || arg == "--sample-offset" ||
+        arg == "--threads" || arg == "--output")
+    {
+      i++;
+      continue;
+    }
+    if (arg == "--quiet" || arg == "--background") {
+      continue;
+    }
+    options.worker_args.push_back(arg);
+  }
+}
+
 static int files_parse(int argc, const char *argv[])
 {
   if (argc > 0) {
@@ -364,6 +418,7 @@ static void options_parse(int argc, const char **argv)
   options.filepath = "";
   options.session = NULL;
   options.quiet = false;
+  options.workers = 0;
   options.session_params.use_auto_tile = false;
   options.session_params.tile_size = 0;
 
@@ -411,6 +466,12 @@ static void options_parse(int argc, const char **argv)
              "--samples %d",
              &options.session_params.samples,
              "Number of samples to render",
+             "--sample-offset %d",
+             &options.session_params.sample_offset,
+             "Index of the first sample to render",
+             "--workers %d",
+             &options.workers,
+             "Render samples with multiple worker processes, merged into the EXR output",
              "--output %s",
              &options.output_filepath,
              "File path to write output image",
@@ -529,6 +590,14 @@ static void options_parse(int argc, const char **argv)
     fprintf(stderr, "Invalid number of samples: %d\n", options.session_params.samples);
     exit(EXIT_FAILURE);
   }
+  else if (options.session_params.sample_offset < 0) {
+    fprintf(stderr, "Invalid sample offset: %d\n", options.session_params.sample_offset);
+    exit(EXIT_FAILURE);
+  }
+  else if (options.workers > 1 && options.output_filepath.empty()) {
+    fprintf(stderr, "Rendering with multiple workers requires an output file path\n");
+    exit(EXIT_FAILURE);
+  }
   else if (options.filepath == "") {
     fprintf(stderr, "No file path specified\n");
     exit(EXIT_FAILURE);
@@ -545,6 +614,11 @@ int main(int argc, const char **argv)
   path_init();
   options_parse(argc, argv);
 
+  if (options.workers > 1) {
+    worker_args_init(argc, argv);
+    return distributed_render() ? 0 : 1;
+  }
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
   if (options.session_params.background) {
 #endif
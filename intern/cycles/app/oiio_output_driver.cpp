@@ -20,30 +20,24 @@ OIIOOutputDriver::OIIOOutputDriver(const string_view filepath,
 
 OIIOOutputDriver::~OIIOOutputDriver() {}
 
-void OIIOOutputDriver::write_render_tile(const Tile &tile)
+ImageSpec OIIOOutputDriver::image_spec(const Tile &tile) const
 {
-  /* Only write the full buffer, no intermediate tiles. */
-  if (!(tile.size == tile.full_size)) {
-    return;
-  }
-
-  log_(string_printf("Writing image %s", filepath_.c_str()));
-
-  unique_ptr<ImageOutput> image_output(ImageOutput::create(filepath_));
-  if (image_output == nullptr) {
-    log_("Failed to create image file");
-    return;
+  ImageSpec spec(tile.full_size.x, tile.full_size.y, 4, TypeDesc::FLOAT);
+  if (samples_ > 0) {
+    const string layer = tile.layer.empty() ? "View Layer" : tile.layer;
+    spec.attribute("cycles." + layer + ".samples", TypeDesc::STRING, to_string(samples_));
   }
+  return spec;
+}
 
+void OIIOOutputDriver::write_pixels(ImageOutput *image_output,
+                                    const Tile &tile,
+                                    const ImageSpec &spec,
+                                    const int ybegin)
+{
   const int width = tile.size.x;
   const int height = tile.size.y;
 
-  ImageSpec spec(width, height, 4, TypeDesc::FLOAT);
-  if (!image_output->open(filepath_, spec)) {
-    log_("Failed to create image file");
-    return;
-  }
-
   vector<float> pixels(width * height * 4);
   if (!tile.get_pass_pixels(pass_, 4, pixels.data())) {
     log_("Failed to read render pass pixels");
@@ -51,7 +45,8 @@ void OIIOOutputDriver::write_render_tile(const Tile &tile)
   }
 
   /* Manipulate offset and stride to convert from bottom-up to top-down convention. */
-  ImageBuf image_buffer(spec,
+  ImageSpec tile_spec(width, height, 4, TypeDesc::FLOAT);
+  ImageBuf image_buffer(tile_spec,
                         pixels.data() + (height - 1) * width * 4,
                         AutoStride,
                         -width * 4 * sizeof(float),
@@ -66,10 +61,82 @@ void OIIOOutputDriver::write_render_tile(const Tile &tile)
     ImageBufAlgo::pow(image_buffer, image_buffer, {g, g, g, 1.0f});
   }
 
-  /* Write to disk and close */
-  image_buffer.set_write_format(TypeDesc::FLOAT);
-  image_buffer.write(image_output.get());
-  image_output->close();
+  if (height == spec.height) {
+    /* Write to disk. */
+    image_buffer.set_write_format(TypeDesc::FLOAT);
+    image_buffer.write(image_output);
+    return;
+  }
+
+  /* Write band of scanlines, with the same flipped stride as the image buffer. */
+  if (!image_output->write_scanlines(ybegin,
+                                     ybegin + height,
+                                     0,
+                                     TypeDesc::FLOAT,
+                                     pixels.data() + (height - 1) * width * 4,
+                                     AutoStride,
+                                     -width * 4 * sizeof(float)))
+  {
+    log_("Failed to write image scanlines: " + image_output->geterror());
+  }
+}
+
+void OIIOOutputDriver::write_render_tile(const Tile &tile)
+{
+  if (tile.size == tile.full_size) {
+    log_(string_printf("Writing image %s", filepath_.c_str()));
+
+    unique_ptr<ImageOutput> image_output(ImageOutput::create(filepath_));
+    if (image_output == nullptr) {
+      log_("Failed to create image file");
+      return;
+    }
+
+    const ImageSpec spec = image_spec(tile);
+    if (!image_output->open(filepath_, spec)) {
+      log_("Failed to create image file");
+      return;
+    }
+
+    write_pixels(image_output.get(), tile, spec, 0);
+    image_output->close();
+    return;
+  }
+
+  /* Only write bands of the full frame, no intermediate tiles. */
+  if (tile.size.x != tile.full_size.x) {
+    return;
+  }
+
+  /* Bands arrive from the top of the image, the first one opens the image. */
+  if (tile.offset.y + tile.size.y == tile.full_size.y) {
+    log_(string_printf("Writing image %s", filepath_.c_str()));
+
+    partial_output_ = ImageOutput::create(filepath_);
+    if (partial_output_ == nullptr) {
+      log_("Failed to create image file");
+      return;
+    }
+
+    if (!partial_output_->open(filepath_, image_spec(tile))) {
+      log_("Failed to create image file");
+      partial_output_ = nullptr;
+      return;
+    }
+  }
+
+  if (partial_output_ == nullptr) {
+    return;
+  }
+
+  const int ybegin = tile.full_size.y - (tile.offset.y + tile.size.y);
+  write_pixels(partial_output_.get(), tile, partial_output_->spec(), ybegin);
+
+  /* The last band closes the image. */
+  if (tile.offset.y == 0) {
+    partial_output_->close();
+    partial_output_ = nullptr;
+  }
 }
 
 CCL_NAMESPACE_END
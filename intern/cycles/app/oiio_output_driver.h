@@ -21,10 +21,33 @@ class OIIOOutputDriver : public OutputDriver {
 
   void write_render_tile(const Tile &tile) override;
 
+  /* The full frame of tiled renders is written in bands of rows as they arrive. */
+  bool supports_partial_write() override
+  {
+    return true;
+  }
+
+  /* Number of samples written to the image metadata, so that images rendered with different
+   * sample ranges can be merged. */
+  void set_samples(const int samples)
+  {
+    samples_ = samples;
+  }
+
  protected:
   string filepath_;
   string pass_;
   LogFunction log_;
+  int samples_ = 0;
+
+  ImageSpec image_spec(const Tile &tile) const;
+  void write_pixels(ImageOutput *image_output,
+                    const Tile &tile,
+                    const ImageSpec &spec,
+                    const int ybegin);
+
+  /* Image which is being written in bands, open until its last band is written. */
+  unique_ptr<ImageOutput> partial_output_;
 };
 
 CCL_NAMESPACE_END
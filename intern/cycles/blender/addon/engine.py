@@ -13,6 +13,9 @@ def _configure_argument_parser():
     parser.add_argument("--cycles-print-stats",
                         help="Print rendering statistics to stderr",
                         action='store_true')
+    parser.add_argument("--cycles-profile",
+                        help="Collect kernel profiling statistics of CPU renders, available as JSON from Python",
+                        action='store_true')
     parser.add_argument("--cycles-device",
                         help="Set the device to use for Cycles, overriding user preferences and the scene setting."
                              "Valid options are 'CPU', 'CUDA', 'OPTIX', 'HIP', 'ONEAPI', or 'METAL'."
@@ -35,6 +38,10 @@ def _parse_command_line():
         import _cycles
         _cycles.enable_print_stats()
 
+    if args.cycles_profile:
+        import _cycles
+        _cycles.enable_profiling()
+
     if args.cycles_device:
         import _cycles
         _cycles.set_device_override(args.cycles_device)
@@ -173,6 +180,18 @@ def system_info():
     return _cycles.system_info()
 
 
+def enable_profiling():
+    import _cycles
+    _cycles.enable_profiling()
+
+
+def render_stats_json():
+    # Profiling statistics of the last final render as a JSON string, None until a render
+    # finished with profiling enabled.
+    import _cycles
+    return _cycles.get_render_stats_json()
+
+
 def list_render_passes(scene, srl):
     import _cycles
 
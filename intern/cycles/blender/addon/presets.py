@@ -104,10 +104,12 @@ class AddPresetPerformance(AddPresetBase, Operator):
         "render.use_persistent_data",
         "cycles.debug_use_spatial_splits",
         "cycles.debug_use_compact_bvh",
+        "cycles.debug_use_compact_curves_bvh",
         "cycles.debug_use_hair_bvh",
         "cycles.debug_bvh_time_steps",
         "cycles.use_auto_tile",
         "cycles.tile_size",
+        "cycles.use_half_precision_attributes",
     ]
 
     preset_subdir = "cycles/performance"
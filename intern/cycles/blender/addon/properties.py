@@ -865,6 +865,17 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="Use compact BVH structure (uses less ram but renders slower)",
         default=False,
     )
+    debug_use_compact_curves_bvh: BoolProperty(
+        name="Use Compact Curves BVH",
+        description="Group multiple curve segments into each BVH leaf (uses less ram but renders slower)",
+        default=False,
+    )
+    use_half_precision_attributes: BoolProperty(
+        name="Half Precision Attributes",
+        description="Store mesh UV maps in half precision (uses less memory, but reduces precision of texture "
+        "coordinates)",
+        default=False,
+    )
     debug_bvh_time_steps: IntProperty(
         name="BVH Time Steps",
         description="Split BVH primitives by this number of time steps to speed up render time in cost of memory",
@@ -130,6 +130,19 @@ def use_oneapi(context):
     return (get_device_type(context) == 'ONEAPI' and cscene.device == 'GPU' and backend_has_active_gpu(context))
 
 
+def use_bvh2(context):
+    # Devices that traverse the BVH2 built by Cycles itself, rather than a hardware ray tracing BVH.
+    cprefs = context.preferences.addons[__package__].preferences
+
+    if use_cuda(context):
+        return True
+    if use_hip(context):
+        return not cprefs.use_hiprt
+    if use_metal(context):
+        return cprefs.metalrt == 'OFF'
+    return False
+
+
 def use_multi_device(context):
     cscene = context.scene.cycles
     if cscene.device != 'GPU':
@@ -848,6 +861,8 @@ class CYCLES_RENDER_PT_performance_memory(CyclesButtonsPanel, Panel):
         sub.active = cscene.use_auto_tile
         sub.prop(cscene, "tile_size")
 
+        col.prop(cscene, "use_half_precision_attributes")
+
 
 class CYCLES_RENDER_PT_performance_acceleration_structure(CyclesButtonsPanel, Panel):
     bl_label = "Acceleration Structure"
@@ -881,6 +896,7 @@ class CYCLES_RENDER_PT_performance_acceleration_structure(CyclesButtonsPanel, Pa
                 sub.prop(cscene, "debug_bvh_time_steps")
 
                 col.prop(cscene, "debug_use_hair_bvh")
+                col.prop(cscene, "debug_use_compact_curves_bvh")
 
                 sub = col.column(align=True)
                 sub.label(text="Cycles built without Embree support")
@@ -893,6 +909,10 @@ class CYCLES_RENDER_PT_performance_acceleration_structure(CyclesButtonsPanel, Pa
 
             col.prop(cscene, "debug_use_hair_bvh")
 
+            # BVH2 on the GPU.
+            if use_bvh2(context):
+                col.prop(cscene, "debug_use_compact_curves_bvh")
+
             # CPU is used in addition to a GPU
             if use_multi_device(context) and use_embree:
                 col.prop(cscene, "debug_use_compact_bvh")
@@ -33,6 +33,8 @@
 #include "BKE_customdata.hh"
 #include "BKE_mesh.hh"
 
+#include "BLI_task.hh"
+
 CCL_NAMESPACE_BEGIN
 
 /* Tangent Space */
@@ -327,20 +329,26 @@ static void attr_create_generic(Scene *scene,
       uchar4 *data = attr->data_uchar4();
       const blender::VArraySpan src = b_attr.varray.typed<blender::ColorGeometry4b>();
       if (subdivision) {
-        for (const int i : src.index_range()) {
-          data[i] = make_uchar4(src[i][0], src[i][1], src[i][2], src[i][3]);
-        }
+        blender::threading::parallel_for(
+            src.index_range(), 4096, [&](const blender::IndexRange range) {
+              for (const int i : range) {
+                data[i] = make_uchar4(src[i][0], src[i][1], src[i][2], src[i][3]);
+              }
+            });
       }
       else {
-        for (const int i : corner_tris.index_range()) {
-          const blender::int3 &tri = corner_tris[i];
-          data[i * 3 + 0] = make_uchar4(
-              src[tri[0]][0], src[tri[0]][1], src[tri[0]][2], src[tri[0]][3]);
-          data[i * 3 + 1] = make_uchar4(
-              src[tri[1]][0], src[tri[1]][1], src[tri[1]][2], src[tri[1]][3]);
-          data[i * 3 + 2] = make_uchar4(
-              src[tri[2]][0], src[tri[2]][1], src[tri[2]][2], src[tri[2]][3]);
-        }
+        blender::threading::parallel_for(
+            corner_tris.index_range(), 4096, [&](const blender::IndexRange range) {
+              for (const int i : range) {
+                const blender::int3 &tri = corner_tris[i];
+                data[i * 3 + 0] = make_uchar4(
+                    src[tri[0]][0], src[tri[0]][1], src[tri[0]][2], src[tri[0]][3]);
+                data[i * 3 + 1] = make_uchar4(
+                    src[tri[1]][0], src[tri[1]][1], src[tri[1]][2], src[tri[1]][3]);
+                data[i * 3 + 2] = make_uchar4(
+                    src[tri[2]][0], src[tri[2]][1], src[tri[2]][2], src[tri[2]][3]);
+              }
+            });
       }
       return true;
     }
@@ -374,39 +382,47 @@ static void attr_create_generic(Scene *scene,
         CyclesT *data = reinterpret_cast<CyclesT *>(attr->data());
 
         const blender::VArraySpan src = b_attr.varray.typed<BlenderT>();
+        auto convert_direct = [&]() {
+          blender::threading::parallel_for(
+              src.index_range(), 4096, [&](const blender::IndexRange range) {
+                for (const int i : range) {
+                  data[i] = Converter::convert(src[i]);
+                }
+              });
+        };
         switch (b_attr.domain) {
           case blender::bke::AttrDomain::Corner: {
             if (subdivision) {
-              for (const int i : src.index_range()) {
-                data[i] = Converter::convert(src[i]);
-              }
+              convert_direct();
             }
             else {
-              for (const int i : corner_tris.index_range()) {
-                const blender::int3 &tri = corner_tris[i];
-                data[i * 3 + 0] = Converter::convert(src[tri[0]]);
-                data[i * 3 + 1] = Converter::convert(src[tri[1]]);
-                data[i * 3 + 2] = Converter::convert(src[tri[2]]);
-              }
+              blender::threading::parallel_for(
+                  corner_tris.index_range(), 4096, [&](const blender::IndexRange range) {
+                    for (const int i : range) {
+                      const blender::int3 &tri = corner_tris[i];
+                      data[i * 3 + 0] = Converter::convert(src[tri[0]]);
+                      data[i * 3 + 1] = Converter::convert(src[tri[1]]);
+                      data[i * 3 + 2] = Converter::convert(src[tri[2]]);
+                    }
+                  });
             }
             break;
           }
           case blender::bke::AttrDomain::Point: {
-            for (const int i : src.index_range()) {
-              data[i] = Converter::convert(src[i]);
-            }
+            convert_direct();
             break;
           }
           case blender::bke::AttrDomain::Face: {
             if (subdivision) {
-              for (const int i : src.index_range()) {
-                data[i] = Converter::convert(src[i]);
-              }
+              convert_direct();
             }
             else {
-              for (const int i : corner_tris.index_range()) {
-                data[i] = Converter::convert(src[tri_faces[i]]);
-              }
+              blender::threading::parallel_for(
+                  corner_tris.index_range(), 4096, [&](const blender::IndexRange range) {
+                    for (const int i : range) {
+                      data[i] = Converter::convert(src[tri_faces[i]]);
+                    }
+                  });
             }
             break;
           }
@@ -477,12 +493,15 @@ static void attr_create_uv_map(Scene *scene,
         const blender::VArraySpan b_uv_map = *b_attributes.lookup<blender::float2>(
             uv_name.c_str(), blender::bke::AttrDomain::Corner);
         float2 *fdata = uv_attr->data_float2();
-        for (const int i : corner_tris.index_range()) {
-          const blender::int3 &tri = corner_tris[i];
-          fdata[i * 3 + 0] = make_float2(b_uv_map[tri[0]][0], b_uv_map[tri[0]][1]);
-          fdata[i * 3 + 1] = make_float2(b_uv_map[tri[1]][0], b_uv_map[tri[1]][1]);
-          fdata[i * 3 + 2] = make_float2(b_uv_map[tri[2]][0], b_uv_map[tri[2]][1]);
-        }
+        blender::threading::parallel_for(
+            corner_tris.index_range(), 4096, [&](const blender::IndexRange range) {
+              for (const int i : range) {
+                const blender::int3 &tri = corner_tris[i];
+                fdata[i * 3 + 0] = make_float2(b_uv_map[tri[0]][0], b_uv_map[tri[0]][1]);
+                fdata[i * 3 + 1] = make_float2(b_uv_map[tri[1]][0], b_uv_map[tri[1]][1]);
+                fdata[i * 3 + 2] = make_float2(b_uv_map[tri[2]][0], b_uv_map[tri[2]][1]);
+              }
+            });
       }
 
       /* UV tangent */
@@ -865,9 +884,12 @@ static void create_mesh(Scene *scene,
   mesh->resize_mesh(positions.size(), numtris);
 
   float3 *verts = mesh->get_verts().data();
-  for (const int i : positions.index_range()) {
-    verts[i] = make_float3(positions[i][0], positions[i][1], positions[i][2]);
-  }
+  blender::threading::parallel_for(
+      positions.index_range(), 4096, [&](const blender::IndexRange range) {
+        for (const int i : range) {
+          verts[i] = make_float3(positions[i][0], positions[i][1], positions[i][2]);
+        }
+      });
 
   AttributeSet &attributes = (subdivision) ? mesh->subd_attributes : mesh->attributes;
   Attribute *attr_N = attributes.add(ATTR_STD_VERTEX_NORMAL);
@@ -875,9 +897,12 @@ static void create_mesh(Scene *scene,
 
   if (subdivision || !(use_corner_normals && !corner_normals.is_empty())) {
     const blender::Span<blender::float3> vert_normals = b_mesh.vert_normals();
-    for (const int i : vert_normals.index_range()) {
-      N[i] = make_float3(vert_normals[i][0], vert_normals[i][1], vert_normals[i][2]);
-    }
+    blender::threading::parallel_for(
+        vert_normals.index_range(), 4096, [&](const blender::IndexRange range) {
+          for (const int i : range) {
+            N[i] = make_float3(vert_normals[i][0], vert_normals[i][1], vert_normals[i][2]);
+          }
+        });
   }
 
   const set<ustring> blender_uv_names = get_blender_uv_names(b_mesh);
@@ -901,16 +926,19 @@ static void create_mesh(Scene *scene,
 
     float3 *generated = attr->data_float3();
 
-    for (const int i : positions.index_range()) {
-      blender::float3 value;
-      if (orco) {
-        madd_v3_v3v3v3(value, texspace_location, orco[i], texspace_size);
-      }
-      else {
-        value = positions[i];
-      }
-      generated[i] = make_float3(value[0], value[1], value[2]) * size - loc;
-    }
+    blender::threading::parallel_for(
+        positions.index_range(), 4096, [&](const blender::IndexRange range) {
+          for (const int i : range) {
+            blender::float3 value;
+            if (orco) {
+              madd_v3_v3v3v3(value, texspace_location, orco[i], texspace_size);
+            }
+            else {
+              value = positions[i];
+            }
+            generated[i] = make_float3(value[0], value[1], value[2]) * size - loc;
+          }
+        });
   }
 
   auto clamp_material_index = [&](const int material_index) -> int {
@@ -924,18 +952,24 @@ static void create_mesh(Scene *scene,
     int *shader = mesh->get_shader().data();
 
     const blender::Span<blender::int3> corner_tris = b_mesh.corner_tris();
-    for (const int i : corner_tris.index_range()) {
-      const blender::int3 &tri = corner_tris[i];
-      triangles[i * 3 + 0] = corner_verts[tri[0]];
-      triangles[i * 3 + 1] = corner_verts[tri[1]];
-      triangles[i * 3 + 2] = corner_verts[tri[2]];
-    }
+    blender::threading::parallel_for(
+        corner_tris.index_range(), 4096, [&](const blender::IndexRange range) {
+          for (const int i : range) {
+            const blender::int3 &tri = corner_tris[i];
+            triangles[i * 3 + 0] = corner_verts[tri[0]];
+            triangles[i * 3 + 1] = corner_verts[tri[1]];
+            triangles[i * 3 + 2] = corner_verts[tri[2]];
+          }
+        });
 
     if (!material_indices.is_empty()) {
       const blender::Span<int> tri_faces = b_mesh.corner_tri_faces();
-      for (const int i : corner_tris.index_range()) {
-        shader[i] = clamp_material_index(material_indices[tri_faces[i]]);
-      }
+      blender::threading::parallel_for(
+          corner_tris.index_range(), 4096, [&](const blender::IndexRange range) {
+            for (const int i : range) {
+              shader[i] = clamp_material_index(material_indices[tri_faces[i]]);
+            }
+          });
     }
     else {
       std::fill(shader, shader + numtris, 0);
@@ -943,9 +977,12 @@ static void create_mesh(Scene *scene,
 
     if (!sharp_faces.is_empty() && !(use_corner_normals && !corner_normals.is_empty())) {
       const blender::Span<int> tri_faces = b_mesh.corner_tri_faces();
-      for (const int i : corner_tris.index_range()) {
-        smooth[i] = !sharp_faces[tri_faces[i]];
-      }
+      blender::threading::parallel_for(
+          corner_tris.index_range(), 4096, [&](const blender::IndexRange range) {
+            for (const int i : range) {
+              smooth[i] = !sharp_faces[tri_faces[i]];
+            }
+          });
     }
     else {
       /* If only face normals are needed, all faces are sharp. */
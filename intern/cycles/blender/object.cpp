@@ -369,6 +369,7 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
     object->set_blocker_shadow_set(BlenderLightLink::get_blocker_shadow_set(b_parent, b_ob));
 
     object->tag_update(scene);
+    num_objects_synced_++;
   }
 
   sync_object_motion_init(b_parent, b_ob, object);
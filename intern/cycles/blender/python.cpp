@@ -876,6 +876,20 @@ static PyObject *enable_print_stats_func(PyObject * /*self*/, PyObject * /*args*
   Py_RETURN_NONE;
 }
 
+static PyObject *enable_profiling_func(PyObject * /*self*/, PyObject * /*args*/)
+{
+  BlenderSession::use_render_profiling = true;
+  Py_RETURN_NONE;
+}
+
+static PyObject *get_render_stats_json_func(PyObject * /*self*/, PyObject * /*args*/)
+{
+  if (BlenderSession::render_stats_json.empty()) {
+    Py_RETURN_NONE;
+  }
+  return PyUnicode_FromString(BlenderSession::render_stats_json.c_str());
+}
+
 static PyObject *get_device_types_func(PyObject * /*self*/, PyObject * /*args*/)
 {
   vector<DeviceType> device_types = Device::available_types();
@@ -972,6 +986,8 @@ static PyMethodDef methods[] = {
 
     /* Statistics. */
     {"enable_print_stats", enable_print_stats_func, METH_NOARGS, ""},
+    {"enable_profiling", enable_profiling_func, METH_NOARGS, ""},
+    {"get_render_stats_json", get_render_stats_json_func, METH_NOARGS, ""},
 
     /* Compute Device selection */
     {"get_device_types", get_device_types_func, METH_VARARGS, ""},
@@ -41,6 +41,8 @@ CCL_NAMESPACE_BEGIN
 DeviceTypeMask BlenderSession::device_override = DEVICE_MASK_ALL;
 bool BlenderSession::headless = false;
 bool BlenderSession::print_render_stats = false;
+bool BlenderSession::use_render_profiling = false;
+string BlenderSession::render_stats_json;
 
 BlenderSession::BlenderSession(BL::RenderEngine &b_engine,
                                BL::Preferences &b_userpref,
@@ -452,10 +454,16 @@ void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
     session->start();
     session->wait();
 
-    if (!b_engine.is_preview() && background && print_render_stats) {
+    if (!b_engine.is_preview() && background && (print_render_stats || use_render_profiling)) {
       RenderStats stats;
       session->collect_statistics(&stats);
-      printf("Render statistics:\n%s\n", stats.full_report().c_str());
+      sync->collect_statistics(&stats);
+      if (print_render_stats) {
+        printf("Render statistics:\n%s\n", stats.full_report().c_str());
+      }
+      if (use_render_profiling) {
+        render_stats_json = stats.json_report();
+      }
     }
 
     if (session->progress.get_cancel()) {
@@ -120,6 +120,10 @@ class BlenderSession {
 
   static bool print_render_stats;
 
+  /* Collect profiling statistics of final renders, available to Python as JSON afterwards. */
+  static bool use_render_profiling;
+  static string render_stats_json;
+
  protected:
   void stamp_view_layer_metadata(Scene *scene, const string &view_layer_name);
 
@@ -233,6 +233,11 @@ void BlenderSync::sync_recalc(BL::Depsgraph &b_depsgraph, BL::SpaceView3D &b_v3d
       BL::Volume b_volume(b_id);
       geometry_map.set_recalc(b_volume);
     }
+    /* Curves and point clouds. Their data can be tagged without the object being tagged, which
+     * with persistent data would otherwise keep the geometry of the previous frame. */
+    else if (b_id.is_a(&RNA_Curves) || b_id.is_a(&RNA_PointCloud)) {
+      geometry_map.set_recalc(b_id);
+    }
   }
 
   if (b_v3d) {
@@ -262,10 +267,16 @@ void BlenderSync::sync_data(BL::RenderSettings &b_render,
   const bool auto_refresh_update = image_manager->set_animation_frame_update(frame);
 
   if (!has_updates_ && !auto_refresh_update) {
+    if (full_sync_time_ > 0.0) {
+      VLOG_INFO << "Scene is unchanged, saved " << full_sync_time_
+                << " seconds of synchronization compared to full synchronization.";
+    }
     return;
   }
 
   scoped_timer timer;
+  num_objects_synced_ = 0;
+  sync_time_stats_.clear();
 
   BL::ViewLayer b_view_layer = b_depsgraph.view_layer_eval();
 
@@ -276,25 +287,54 @@ void BlenderSync::sync_data(BL::RenderSettings &b_render,
   sync_view_layer(b_view_layer);
   sync_integrator(b_view_layer, background, device_info);
   sync_film(b_view_layer, b_v3d);
-  sync_shaders(b_depsgraph, b_v3d, auto_refresh_update);
-  sync_images();
+  {
+    scoped_callback_timer shaders_timer(
+        [this](double time) { sync_time_stats_.add_entry({"shaders", time}); });
+    sync_shaders(b_depsgraph, b_v3d, auto_refresh_update);
+  }
+  {
+    scoped_callback_timer images_timer(
+        [this](double time) { sync_time_stats_.add_entry({"images", time}); });
+    sync_images();
+  }
 
   geometry_synced.clear(); /* use for objects and motion sync */
 
   if (scene->need_motion() == Scene::MOTION_PASS || scene->need_motion() == Scene::MOTION_NONE ||
       scene->camera->get_motion_position() == MOTION_POSITION_CENTER)
   {
+    scoped_callback_timer objects_timer(
+        [this](double time) { sync_time_stats_.add_entry({"objects and geometry", time}); });
     sync_objects(b_depsgraph, b_v3d);
   }
-  sync_motion(b_render, b_depsgraph, b_v3d, b_override, width, height, python_thread_state);
+  {
+    scoped_callback_timer motion_timer(
+        [this](double time) { sync_time_stats_.add_entry({"motion", time}); });
+    sync_motion(b_render, b_depsgraph, b_v3d, b_override, width, height, python_thread_state);
+  }
 
+  const int num_geometry_synced = geometry_synced.size();
   geometry_synced.clear();
 
   /* Shader sync done at the end, since object sync uses it.
    * false = don't delete unused shaders, not supported. */
   shader_map.post_sync(false);
 
-  VLOG_INFO << "Total time spent synchronizing data: " << timer.get_time();
+  const double sync_time = timer.get_time();
+  VLOG_INFO << "Total time spent synchronizing data: " << sync_time;
+
+  /* The first synchronization exports everything, use it as a reference to report how much time
+   * is saved by only synchronizing the changed objects when the sync is re-used across frames
+   * (persistent data). */
+  if (full_sync_time_ == 0.0) {
+    full_sync_time_ = sync_time;
+  }
+  else {
+    VLOG_INFO << "Synchronized " << num_geometry_synced << " of " << scene->geometry.size()
+              << " geometries and " << num_objects_synced_ << " of " << scene->objects.size()
+              << " objects, saved " << max(full_sync_time_ - sync_time, 0.0)
+              << " seconds compared to full synchronization.";
+  }
 
   has_updates_ = false;
 }
@@ -804,6 +844,11 @@ void BlenderSync::free_data_after_sync(BL::Depsgraph &b_depsgraph)
   }
 }
 
+void BlenderSync::collect_statistics(RenderStats *stats)
+{
+  stats->sync = sync_time_stats_;
+}
+
 /* Scene Parameters */
 
 SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene,
@@ -830,8 +875,11 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene,
 
   params.use_bvh_spatial_split = RNA_boolean_get(&cscene, "debug_use_spatial_splits");
   params.use_bvh_compact_structure = RNA_boolean_get(&cscene, "debug_use_compact_bvh");
+  params.use_bvh_compact_curves = RNA_boolean_get(&cscene, "debug_use_compact_curves_bvh");
   params.use_bvh_unaligned_nodes = RNA_boolean_get(&cscene, "debug_use_hair_bvh");
   params.num_bvh_time_steps = RNA_int_get(&cscene, "debug_bvh_time_steps");
+  params.use_half_precision_attributes = RNA_boolean_get(&cscene,
+                                                         "use_half_precision_attributes");
 
   PointerRNA csscene = RNA_pointer_get(&b_scene.ptr, "cycles_curves");
   params.hair_subdivisions = get_int(csscene, "subdivisions");
@@ -949,7 +997,8 @@ SessionParams BlenderSync::get_session_params(BL::RenderEngine &b_engine,
 
   /* Profiling. */
   params.use_profiling = params.device.has_profiling && !b_engine.is_preview() && background &&
-                         BlenderSession::print_render_stats;
+                         (BlenderSession::print_render_stats ||
+                          BlenderSession::use_render_profiling);
 
   if (background) {
     params.use_auto_tile = RNA_boolean_get(&cscene, "use_auto_tile");
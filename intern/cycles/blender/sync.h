@@ -16,6 +16,7 @@
 #include "blender/viewport.h"
 
 #include "scene/scene.h"
+#include "scene/stats.h"
 #include "session/session.h"
 
 #include "util/map.h"
@@ -90,6 +91,9 @@ class BlenderSync {
   /* Early data free. */
   void free_data_after_sync(BL::Depsgraph &b_depsgraph);
 
+  /* Statistics about the time spent in the last synchronization. */
+  void collect_statistics(RenderStats *stats);
+
   /* get parameters */
   static SceneParams get_scene_params(BL::Scene &b_scene,
                                       const bool background,
@@ -278,6 +282,15 @@ class BlenderSync {
 
   Progress &progress;
 
+  /* Time spent in the first (full) synchronization, and number of objects which were tagged for
+   * update in the last synchronization. Used to report the time saved by re-using the scene when
+   * rendering with persistent data. */
+  double full_sync_time_ = 0.0;
+  int num_objects_synced_ = 0;
+
+  /* Time spent in the different stages of the last synchronization. */
+  NamedTimeStats sync_time_stats_;
+
   /* Indicates that `sync_recalc()` detected changes in the scene.
    * If this flag is false then the data is considered to be up-to-date and will not be
    * synchronized at all. */
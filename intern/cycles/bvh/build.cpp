@@ -637,7 +637,11 @@ bool BVHBuild::range_within_max_leaf_size(const BVHRange &range,
                                           const vector<BVHReference> &references) const
 {
   size_t size = range.size();
-  size_t max_leaf_size = max(max(params.max_triangle_leaf_size, params.max_curve_leaf_size),
+  const int max_curve_leaf_size = (params.use_compact_curves) ?
+                                      max((int)BVHParams::COMPACT_CURVE_LEAF_SIZE,
+                                          params.max_curve_leaf_size) :
+                                      params.max_curve_leaf_size;
+  size_t max_leaf_size = max(max(params.max_triangle_leaf_size, max_curve_leaf_size),
                              params.max_point_leaf_size);
 
   if (size > max_leaf_size) {
@@ -682,12 +686,29 @@ bool BVHBuild::range_within_max_leaf_size(const BVHRange &range,
 
   return (num_triangles <= params.max_triangle_leaf_size) &&
          (num_motion_triangles <= params.max_motion_triangle_leaf_size) &&
-         (num_curves <= params.max_curve_leaf_size) &&
+         (num_curves <= max_curve_leaf_size) &&
          (num_motion_curves <= params.max_motion_curve_leaf_size) &&
          (num_points <= params.max_point_leaf_size) &&
          (num_motion_points <= params.max_motion_point_leaf_size);
 }
 
+bool BVHBuild::range_is_compact_curve_leaf(const BVHRange &range,
+                                           const vector<BVHReference> &references) const
+{
+  if (!params.use_compact_curves || range.size() > BVHParams::COMPACT_CURVE_LEAF_SIZE) {
+    return false;
+  }
+
+  for (int i = 0; i < range.size(); i++) {
+    const BVHReference &ref = references[range.start() + i];
+    if ((ref.prim_type() & PRIMITIVE_CURVE) == 0 || (ref.prim_type() & PRIMITIVE_MOTION)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 /* multithreaded binning builder */
 BVHNode *BVHBuild::build_node(const BVHObjectBinning &range, int level)
 {
@@ -702,6 +723,7 @@ BVHNode *BVHBuild::build_node(const BVHObjectBinning &range, int level)
   if (!(range.size() > 0 && params.top_level && level == 0)) {
     /* Make leaf node when threshold reached or SAH tells us. */
     if ((params.small_enough_for_leaf(size, level)) ||
+        range_is_compact_curve_leaf(range, references) ||
         (range_within_max_leaf_size(range, references) && leafSAH < splitSAH))
     {
       return create_leaf_node(range, references);
@@ -793,7 +815,9 @@ BVHNode *BVHBuild::build_node(const BVHRange &range,
 
   /* Small enough or too deep => create leaf. */
   if (!(range.size() > 0 && params.top_level && level == 0)) {
-    if (params.small_enough_for_leaf(range.size(), level)) {
+    if (params.small_enough_for_leaf(range.size(), level) ||
+        range_is_compact_curve_leaf(range, references))
+    {
       progress_count += range.size();
       return create_leaf_node(range, references);
     }
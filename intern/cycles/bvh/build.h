@@ -75,6 +75,8 @@ class BVHBuild {
 
   bool range_within_max_leaf_size(const BVHRange &range,
                                   const vector<BVHReference> &references) const;
+  bool range_is_compact_curve_leaf(const BVHRange &range,
+                                   const vector<BVHReference> &references) const;
 
   /* Threads. */
   enum { THREAD_TASK_SIZE = 4096 };
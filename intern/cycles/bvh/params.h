@@ -77,6 +77,11 @@ class BVHParams {
   int max_point_leaf_size;
   int max_motion_point_leaf_size;
 
+  /* Group curve segments into leaves of up to COMPACT_CURVE_LEAF_SIZE, rather than only when
+   * the SAH tells us. Reduces the number of nodes for hair at the cost of intersecting more
+   * segments per leaf. */
+  bool use_compact_curves;
+
   /* object or mesh level bvh */
   bool top_level;
 
@@ -109,7 +114,12 @@ class BVHParams {
   int curve_subdivisions;
 
   /* fixed parameters */
-  enum { MAX_DEPTH = 64, MAX_SPATIAL_DEPTH = 48, NUM_SPATIAL_BINS = 32 };
+  enum {
+    MAX_DEPTH = 64,
+    MAX_SPATIAL_DEPTH = 48,
+    NUM_SPATIAL_BINS = 32,
+    COMPACT_CURVE_LEAF_SIZE = 4
+  };
 
   BVHParams()
   {
@@ -130,6 +140,7 @@ class BVHParams {
     max_motion_curve_leaf_size = 4;
     max_point_leaf_size = 8;
     max_motion_point_leaf_size = 8;
+    use_compact_curves = false;
 
     top_level = false;
     bvh_layout = BVH_LAYOUT_BVH2;
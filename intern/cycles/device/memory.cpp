@@ -5,8 +5,15 @@
 #include "device/memory.h"
 #include "device/device.h"
 
+#include "util/debug.h"
+#include "util/paged_malloc.h"
+
 CCL_NAMESPACE_BEGIN
 
+/* Smallest array which is stored out of core, to avoid wasting address space and file handles
+ * on small arrays which hardly contribute to the memory usage. */
+static const size_t OUT_OF_CORE_MIN_SIZE = 4 * 1024 * 1024;
+
 /* Device Memory */
 
 device_memory::device_memory(Device *device, const char *_name, MemoryType type)
@@ -45,7 +52,22 @@ void *device_memory::host_alloc(size_t size)
     return 0;
   }
 
-  void *ptr = util_aligned_malloc(size, MIN_ALIGNMENT_CPU_DATA_TYPES);
+  void *ptr = NULL;
+
+  /* Scene data on the CPU is used directly from the host memory, store it in a memory-mapped
+   * file when it does not fit into the memory budget. */
+  if (type == MEM_GLOBAL && size >= OUT_OF_CORE_MIN_SIZE && device_is_cpu()) {
+    const DebugFlags::CPU &cpu_flags = DebugFlags().cpu;
+    if (cpu_flags.out_of_core_budget &&
+        device->stats.mem_used + size > cpu_flags.out_of_core_budget)
+    {
+      ptr = util_paged_malloc(size, cpu_flags.out_of_core_directory.c_str());
+    }
+  }
+
+  if (ptr == NULL) {
+    ptr = util_aligned_malloc(size, MIN_ALIGNMENT_CPU_DATA_TYPES);
+  }
 
   if (ptr) {
     util_guarded_mem_alloc(size);
@@ -60,8 +82,11 @@ void *device_memory::host_alloc(size_t size)
 void device_memory::host_free()
 {
   if (host_pointer) {
-    util_guarded_mem_free(memory_size());
-    util_aligned_free((void *)host_pointer);
+    const size_t size = memory_size();
+    util_guarded_mem_free(size);
+    if (!util_paged_free(host_pointer)) {
+      util_aligned_free((void *)host_pointer);
+    }
     host_pointer = 0;
   }
 }
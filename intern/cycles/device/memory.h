@@ -11,6 +11,7 @@
 
 #include "util/array.h"
 #include "util/half.h"
+#include "util/paged_malloc.h"
 #include "util/string.h"
 #include "util/texture.h"
 #include "util/types.h"
@@ -442,7 +443,17 @@ template<typename T> class device_vector : public device_memory {
   {
     device_free();
 
-    to.set_data((T *)host_pointer, data_size);
+    if (util_paged_is_allocated(host_pointer)) {
+      /* Memory-mapped storage can not be owned by an array, copy it instead. */
+      to.resize(data_size);
+      if (data_size) {
+        memcpy(to.data(), host_pointer, sizeof(T) * data_size);
+      }
+      host_free();
+    }
+    else {
+      to.set_data((T *)host_pointer, data_size);
+    }
     data_size = 0;
     data_width = 0;
     data_height = 0;
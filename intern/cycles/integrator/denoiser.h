@@ -94,6 +94,10 @@ class Denoiser {
 
   function<bool(void)> is_cancelled_cb;
 
+  /* Number of threads used by denoisers running on the CPU, zero to use all threads. Limited when
+   * denoising runs at the same time as path tracing. */
+  int num_cpu_threads = 0;
+
   bool is_cancelled() const
   {
     if (!is_cancelled_cb) {
@@ -171,6 +171,9 @@ class OIDNDenoiseContext {
 
     oidn::DeviceRef oidn_device = oidn::newDevice(oidn::DeviceType::CPU);
     oidn_device.set("setAffinity", false);
+    if (denoiser_->num_cpu_threads > 0) {
+      oidn_device.set("numThreads", denoiser_->num_cpu_threads);
+    }
     oidn_device.commit();
 
     /* Create a filter for denoising a beauty (color) image using prefiltered auxiliary images too.
@@ -61,12 +61,15 @@ PathTrace::PathTrace(Device *device,
 
 PathTrace::~PathTrace()
 {
+  async_denoise_wait();
   destroy_gpu_resources();
 }
 
 void PathTrace::load_kernels()
 {
   if (denoiser_) {
+    async_denoise_wait();
+
     /* Activate graphics interop while denoiser device is created, so that it can choose a device
      * that supports interop for faster display updates. */
     if (display_ && path_trace_works_.size() > 1) {
@@ -116,6 +119,8 @@ void PathTrace::reset(const BufferParams &full_params,
                       const BufferParams &big_tile_params,
                       const bool reset_rendering)
 {
+  async_denoise_wait();
+
   if (big_tile_params_.modified(big_tile_params)) {
     big_tile_params_ = big_tile_params;
     render_state_.need_reset_params = true;
@@ -138,6 +143,8 @@ void PathTrace::reset(const BufferParams &full_params,
 
 void PathTrace::device_free()
 {
+  async_denoise_wait();
+
   /* Free render buffers used by the path trace work to reduce memory peak. */
   BufferParams empty_params;
   empty_params.pass_stride = 0;
@@ -191,6 +198,12 @@ void PathTrace::render_pipeline(RenderWork render_work)
 
   rebalance(render_work);
 
+  /* Display the result of asynchronous denoising that finished after the last display update was
+   * skipped for it. */
+  if (async_denoise_.need_display_update && !async_denoise_.is_running) {
+    update_display(async_denoise_.display_work);
+  }
+
   /* Prepare all per-thread guiding structures before we start with the next rendering
    * iteration/progression. */
   const bool use_guiding = device_scene_->data.integrator.use_guiding;
@@ -485,6 +498,10 @@ void PathTrace::adaptive_sample(RenderWork &render_work)
 
 void PathTrace::set_denoiser_params(const DenoiseParams &params)
 {
+  /* The denoiser is used by the asynchronous denoising task, don't modify or free it while the
+   * task is running. */
+  async_denoise_wait();
+
   if (!params.use) {
     denoiser_.reset();
     return;
@@ -567,6 +584,22 @@ void PathTrace::denoise(const RenderWork &render_work)
     return;
   }
 
+  if (use_async_denoise()) {
+    if (!render_work.tile.write) {
+      /* Intermediate denoising in the viewport. Skip it if the previous result is still being
+       * denoised, which naturally reduces the denoising rate to what the denoiser can keep up
+       * with. */
+      async_denoise_update();
+      if (!async_denoise_.is_running) {
+        async_denoise_start();
+      }
+      return;
+    }
+
+    /* Denoise the final result synchronously, so it is never replaced by an outdated one. */
+    async_denoise_wait();
+  }
+
   VLOG_WORK << "Perform denoising work.";
 
   const double start_time = time_dt();
@@ -608,6 +641,91 @@ void PathTrace::denoise(const RenderWork &render_work)
   render_scheduler_.report_denoise_time(render_work, time_dt() - start_time);
 }
 
+bool PathTrace::use_async_denoise()
+{
+  if (render_scheduler_.is_background() || !display_) {
+    return false;
+  }
+
+  /* Only for denoising on the CPU, which does not compete with path tracing for a GPU queue. */
+  const Device *denoiser_device = denoiser_->get_denoiser_device();
+  return denoiser_device && denoiser_device->info.type == DEVICE_CPU;
+}
+
+void PathTrace::async_denoise_start()
+{
+  VLOG_WORK << "Start asynchronous denoising work.";
+
+  Device *denoiser_device = denoiser_->get_denoiser_device();
+  if (!big_tile_denoise_work_) {
+    big_tile_denoise_work_ = PathTraceWork::create(denoiser_device, film_, device_scene_, nullptr);
+  }
+
+  /* Copy the render result to separate buffers, so that path tracing can continue writing into
+   * its own buffers while denoising. */
+  big_tile_denoise_work_->set_effective_buffer_params(render_state_.effective_big_tile_params,
+                                                      render_state_.effective_big_tile_params,
+                                                      render_state_.effective_big_tile_params);
+
+  RenderBuffers *buffer_to_denoise = big_tile_denoise_work_->get_render_buffers();
+  buffer_to_denoise->reset(render_state_.effective_big_tile_params);
+
+  copy_to_render_buffers(buffer_to_denoise);
+
+  /* Leave most of the threads for path tracing. */
+  denoiser_->num_cpu_threads = max(TaskScheduler::max_concurrency() / 4, 1);
+
+  const BufferParams buffer_params = render_state_.effective_big_tile_params;
+  const int num_samples = get_num_samples_in_buffer();
+
+  if (!async_denoise_.task_pool) {
+    async_denoise_.task_pool = make_unique<DedicatedTaskPool>();
+  }
+
+  async_denoise_.is_running = true;
+  async_denoise_.task_pool->push([this, buffer_params, buffer_to_denoise, num_samples]() {
+    const double start_time = time_dt();
+
+    if (denoiser_->denoise_buffer(buffer_params, buffer_to_denoise, num_samples, true)) {
+      async_denoise_.has_new_result = true;
+    }
+
+    async_denoise_.time += time_dt() - start_time;
+    async_denoise_.is_running = false;
+  });
+}
+
+void PathTrace::async_denoise_wait()
+{
+  if (!async_denoise_.task_pool) {
+    return;
+  }
+
+  async_denoise_.task_pool->wait();
+  async_denoise_update();
+
+  if (denoiser_) {
+    denoiser_->num_cpu_threads = 0;
+  }
+}
+
+void PathTrace::async_denoise_update()
+{
+  if (async_denoise_.is_running) {
+    return;
+  }
+
+  if (async_denoise_.has_new_result) {
+    async_denoise_.has_new_result = false;
+    render_state_.has_denoised_result = true;
+  }
+
+  if (async_denoise_.time > 0.0) {
+    render_scheduler_.report_denoise_overlap_time(async_denoise_.time);
+    async_denoise_.time = 0.0;
+  }
+}
+
 void PathTrace::set_output_driver(unique_ptr<OutputDriver> driver)
 {
   output_driver_ = std::move(driver);
@@ -669,6 +787,17 @@ void PathTrace::update_display(const RenderWork &render_work)
     return;
   }
 
+  if (async_denoise_.is_running && render_state_.has_denoised_result) {
+    /* Keep displaying the previous denoised result until the new one is ready, rather than
+     * flickering between noisy and denoised results. Its buffers are in use by the denoiser. */
+    VLOG_WORK << "Skip display update while denoising.";
+    async_denoise_.need_display_update = true;
+    async_denoise_.display_work = render_work;
+    return;
+  }
+  async_denoise_update();
+  async_denoise_.need_display_update = false;
+
   const double start_time = time_dt();
 
   if (output_driver_) {
@@ -827,6 +956,11 @@ void PathTrace::cancel()
     render_cancel_.condition.wait(lock);
   }
 
+  /* Let asynchronous denoising see the cancel request before it is cleared. */
+  if (async_denoise_.task_pool) {
+    async_denoise_.task_pool->wait();
+  }
+
   render_cancel_.is_requested = false;
 }
 
@@ -984,34 +1118,39 @@ bool PathTrace::copy_render_tile_from_device()
   return success;
 }
 
-static string get_layer_view_name(const RenderBuffers &buffers)
+static string get_layer_view_name(const BufferParams &params)
 {
   string result;
 
-  if (buffers.params.layer.size()) {
-    result += string(buffers.params.layer);
+  if (params.layer.size()) {
+    result += string(params.layer);
   }
 
-  if (buffers.params.view.size()) {
+  if (params.view.size()) {
     if (!result.empty()) {
       result += ", ";
     }
-    result += string(buffers.params.view);
+    result += string(params.view);
   }
 
   return result;
 }
 
+/* Number of rows above and below a band of the full frame which are denoised along with it, so
+ * that the denoiser sees enough context to avoid seams between bands. */
+static const int FULL_BUFFER_DENOISE_OVERLAP = 128;
+
 void PathTrace::process_full_buffer_from_disk(string_view filename)
 {
   VLOG_WORK << "Processing full frame buffer file " << filename;
 
-  progress_set_status("Reading full buffer from disk");
+  async_denoise_wait();
 
-  RenderBuffers full_frame_buffers(cpu_device_.get());
+  progress_set_status("Reading full buffer from disk");
 
+  BufferParams full_params;
   DenoiseParams denoise_params;
-  if (!tile_manager_.read_full_buffer_from_disk(filename, &full_frame_buffers, &denoise_params)) {
+  if (!tile_manager_.open_full_buffer_from_disk(filename, &full_params, &denoise_params)) {
     const string error_message = "Error reading tiles from file";
     if (progress_) {
       progress_->set_error(error_message);
@@ -1023,13 +1162,27 @@ void PathTrace::process_full_buffer_from_disk(string_view filename)
     return;
   }
 
-  const string layer_view_name = get_layer_view_name(full_frame_buffers);
+  DCHECK_EQ(full_params.window_width, full_params.width);
+  DCHECK_EQ(full_params.window_height, full_params.height);
+
+  /* Process the full frame at once, unless the output driver can receive it in parts. Bands
+   * have about the same area as the big tiles used for rendering, so that memory usage of this
+   * step does not exceed the one of the rendering. */
+  int band_height = full_params.height;
+  int overlap = 0;
+  if (output_driver_ && output_driver_->supports_partial_write()) {
+    const int2 tile_size = tile_manager_.get_tile_size();
+    const int64_t tile_area = int64_t(tile_size.x) * tile_size.y;
+    overlap = denoise_params.use ? FULL_BUFFER_DENOISE_OVERLAP : 0;
+    band_height = max(int(tile_area / full_params.width), max(overlap * 4, 1));
+    band_height = min(band_height, full_params.height);
+  }
+
+  const string layer_view_name = get_layer_view_name(full_params);
 
   render_state_.has_denoised_result = false;
 
   if (denoise_params.use) {
-    progress_set_status(layer_view_name, "Denoising");
-
     /* If GPU should be used is not based on file metadata. */
     denoise_params.use_gpu = render_scheduler_.is_denoiser_gpu_used();
 
@@ -1040,22 +1193,64 @@ void PathTrace::process_full_buffer_from_disk(string_view filename)
      *  - The next rendering will go via Session's `run_update_for_next_iteration` which will
      *    ensure proper denoiser is used. */
     set_denoiser_params(denoise_params);
+  }
 
-    /* Number of samples doesn't matter too much, since the samples count pass will be used. */
-    denoiser_->denoise_buffer(full_frame_buffers.params, &full_frame_buffers, 0, false);
-
-    render_state_.has_denoised_result = true;
+  if (band_height < full_params.height) {
+    VLOG_WORK << "Processing full frame in bands of " << band_height << " rows.";
   }
 
-  full_frame_state_.render_buffers = &full_frame_buffers;
+  RenderBuffers band_buffers(cpu_device_.get());
+
+  /* Bands are processed from the top of the image, which has the highest row index. */
+  for (int band_end = full_params.height; band_end > 0; band_end -= band_height) {
+    const int band_start = max(band_end - band_height, 0);
+    const int read_start = max(band_start - overlap, 0);
+    const int read_end = min(band_end + overlap, full_params.height);
+
+    BufferParams band_params = full_params;
+    band_params.full_y = full_params.full_y + read_start;
+    band_params.height = read_end - read_start;
+    band_params.window_y = band_start - read_start;
+    band_params.window_height = band_end - band_start;
+    band_params.update_offset_stride();
+
+    band_buffers.reset(band_params);
+
+    if (!tile_manager_.read_full_buffer_rows_from_disk(read_start, &band_buffers)) {
+      const string error_message = "Error reading tiles from file";
+      if (progress_) {
+        progress_->set_error(error_message);
+        progress_->set_cancel(error_message);
+      }
+      else {
+        LOG(ERROR) << error_message;
+      }
+      break;
+    }
+
+    if (denoise_params.use) {
+      progress_set_status(layer_view_name, "Denoising");
+
+      /* Number of samples doesn't matter too much, since the samples count pass will be used. */
+      denoiser_->denoise_buffer(band_buffers.params, &band_buffers, 0, false);
 
-  progress_set_status(layer_view_name, "Finishing");
+      render_state_.has_denoised_result = true;
+    }
 
-  /* Write the full result pretending that there is a single tile.
-   * Requires some state change, but allows to use same communication API with the software. */
-  tile_buffer_write();
+    full_frame_state_.render_buffers = &band_buffers;
+    full_frame_state_.offset = make_int2(0, band_start);
+
+    progress_set_status(layer_view_name, "Finishing");
+
+    /* Write the result pretending that there is a single tile, or a band of the full frame.
+     * Requires some state change, but allows to use same communication API with the software. */
+    tile_buffer_write();
+  }
 
   full_frame_state_.render_buffers = nullptr;
+  full_frame_state_.offset = make_int2(0, 0);
+
+  tile_manager_.close_full_buffer_from_disk();
 }
 
 int PathTrace::get_num_render_tile_samples() const
@@ -1128,7 +1323,7 @@ int2 PathTrace::get_render_tile_size() const
 int2 PathTrace::get_render_tile_offset() const
 {
   if (full_frame_state_.render_buffers) {
-    return make_int2(0, 0);
+    return full_frame_state_.offset;
   }
 
   const Tile &tile = tile_manager_.get_current_tile();
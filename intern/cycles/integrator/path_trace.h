@@ -4,16 +4,20 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "integrator/denoiser.h"
 #include "integrator/guiding.h"
 #include "integrator/pass_accessor.h"
 #include "integrator/path_trace_work.h"
+#include "integrator/render_scheduler.h"
 #include "integrator/work_balancer.h"
 
 #include "session/buffers.h"
 
 #include "util/function.h"
 #include "util/guiding.h"
+#include "util/task.h"
 #include "util/thread.h"
 #include "util/unique_ptr.h"
 #include "util/vector.h"
@@ -26,8 +30,6 @@ class DeviceScene;
 class DisplayDriver;
 class Film;
 class RenderBuffers;
-class RenderScheduler;
-class RenderWork;
 class PathTraceDisplay;
 class OutputDriver;
 class Progress;
@@ -136,7 +138,10 @@ class PathTrace {
   bool copy_render_tile_from_device();
 
   /* Read given full-frame file from disk, perform needed processing and write it to the software
-   * via the write callback. */
+   * via the write callback.
+   *
+   * When the output driver supports partial writes, the file is processed in bands of rows and
+   * the full frame is never in memory at once. */
   void process_full_buffer_from_disk(string_view filename);
 
   /* Get number of samples in the current big tile render buffers. */
@@ -224,6 +229,14 @@ class PathTrace {
    * pointers to the global Field and SegmentStorage)*/
   void guiding_prepare_structures();
 
+  /* Denoising in the viewport, running on a dedicated thread while path tracing continues. */
+  bool use_async_denoise();
+  void async_denoise_start();
+  /* Wait for asynchronous denoising to finish, and make its result available for display. */
+  void async_denoise_wait();
+  /* Make the result of asynchronous denoising available for display if it is finished. */
+  void async_denoise_update();
+
   /* Get number of samples in the current state of the render buffers. */
   int get_num_samples_in_buffer();
 
@@ -285,9 +298,29 @@ class PathTrace {
   /* Denoiser which takes care of denoising the big tile. */
   unique_ptr<Denoiser> denoiser_;
 
-  /* Denoiser device descriptor which holds the denoised big tile for multi-device workloads. */
+  /* Denoiser device descriptor which holds the denoised big tile for multi-device workloads, and
+   * for asynchronous denoising. */
   unique_ptr<PathTraceWork> big_tile_denoise_work_;
 
+  /* State of asynchronous denoising. The big tile denoise work buffers are owned by the denoise
+   * thread while it is running. */
+  struct {
+    /* Created on first use. */
+    unique_ptr<DedicatedTaskPool> task_pool;
+
+    /* Denoising is running in the task pool. */
+    std::atomic<bool> is_running{false};
+    /* Denoising finished with a result that was not displayed yet. */
+    std::atomic<bool> has_new_result{false};
+
+    /* Time spent denoising, reported to the scheduler from the render thread. */
+    double time = 0.0;
+
+    /* A display update was skipped while denoising, and is to be done once denoising finished. */
+    bool need_display_update = false;
+    RenderWork display_work;
+  } async_denoise_;
+
 #ifdef WITH_PATH_GUIDING
   /* Guiding related attributes */
   GuidingParams guiding_params_;
@@ -354,6 +387,9 @@ class PathTrace {
   /* State of the full frame processing and writing to the software. */
   struct {
     RenderBuffers *render_buffers = nullptr;
+    /* Offset of the window of the render buffers in the full frame, when the full frame is
+     * processed in bands. */
+    int2 offset = make_int2(0, 0);
   } full_frame_state_;
 };
 
@@ -17,6 +17,7 @@
 #include "session/buffers.h"
 
 #include "util/atomic.h"
+#include "util/debug.h"
 #include "util/log.h"
 #include "util/tbb.h"
 
@@ -56,6 +57,15 @@ void PathTraceWorkCPU::init_execution()
 {
   /* Cache per-thread kernel globals. */
   device_->get_cpu_kernel_thread_globals(kernel_thread_globals_);
+
+  numa_arenas_.reset();
+  if (DebugFlags().cpu.numa_pinning) {
+    unique_ptr<NumaTaskArenas> numa_arenas = make_unique<NumaTaskArenas>(
+        device_->info.cpu_threads);
+    if (numa_arenas->size() > 1) {
+      numa_arenas_ = std::move(numa_arenas);
+    }
+  }
 }
 
 void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
@@ -73,32 +83,53 @@ void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
     }
   }
 
-  tbb::task_arena local_arena = local_tbb_arena_create(device_);
-  local_arena.execute([&]() {
-    parallel_for(int64_t(0), total_pixels_num, [&](int64_t work_index) {
-      if (is_cancel_requested()) {
-        return;
-      }
-
-      const int y = work_index / image_width;
-      const int x = work_index - y * image_width;
-
-      KernelWorkTile work_tile;
-      work_tile.x = effective_buffer_params_.full_x + x;
-      work_tile.y = effective_buffer_params_.full_y + y;
-      work_tile.w = 1;
-      work_tile.h = 1;
-      work_tile.start_sample = start_sample;
-      work_tile.sample_offset = sample_offset;
-      work_tile.num_samples = 1;
-      work_tile.offset = effective_buffer_params_.offset;
-      work_tile.stride = effective_buffer_params_.stride;
-
-      CPUKernelThreadGlobals *kernel_globals = kernel_thread_globals_get(kernel_thread_globals_);
+  auto render_pixel = [&](const int64_t work_index, CPUKernelThreadGlobals *kernel_globals) {
+    if (is_cancel_requested()) {
+      return;
+    }
 
-      render_samples_full_pipeline(kernel_globals, work_tile, samples_num);
+    const int y = work_index / image_width;
+    const int x = work_index - y * image_width;
+
+    KernelWorkTile work_tile;
+    work_tile.x = effective_buffer_params_.full_x + x;
+    work_tile.y = effective_buffer_params_.full_y + y;
+    work_tile.w = 1;
+    work_tile.h = 1;
+    work_tile.start_sample = start_sample;
+    work_tile.sample_offset = sample_offset;
+    work_tile.num_samples = 1;
+    work_tile.offset = effective_buffer_params_.offset;
+    work_tile.stride = effective_buffer_params_.stride;
+
+    render_samples_full_pipeline(kernel_globals, work_tile, samples_num);
+  };
+
+  if (numa_arenas_) {
+    /* Each node starts with the rows it zeroed, which are in its local memory, and then helps
+     * other nodes with their remaining rows. */
+    numa_arenas_->parallel_for(
+        image_height, 1, [&](const int arena_index, const int64_t y_begin, const int64_t y_end) {
+          const int thread_index = numa_arenas_->thread_offset(arena_index) +
+                                   tbb::this_task_arena::current_thread_index();
+          DCHECK_LT(thread_index, kernel_thread_globals_.size());
+
+          for (int64_t work_index = y_begin * image_width; work_index < y_end * image_width;
+               work_index++)
+          {
+            render_pixel(work_index, &kernel_thread_globals_[thread_index]);
+          }
+        });
+  }
+  else {
+    tbb::task_arena local_arena = local_tbb_arena_create(device_);
+    local_arena.execute([&]() {
+      parallel_for(int64_t(0), total_pixels_num, [&](int64_t work_index) {
+        render_pixel(work_index, kernel_thread_globals_get(kernel_thread_globals_));
+      });
     });
-  });
+  }
+
   if (device_->profiler.active()) {
     for (CPUKernelThreadGlobals &kernel_globals : kernel_thread_globals_) {
       kernel_globals.stop_profiling();
@@ -210,6 +241,31 @@ bool PathTraceWorkCPU::copy_render_buffers_to_device()
 
 bool PathTraceWorkCPU::zero_render_buffers()
 {
+  if (numa_arenas_ && buffers_->buffer.size()) {
+    /* The CPU device uses the host memory of the render buffers directly, which is freshly
+     * allocated and not yet touched after a reset. Copying to the device only assigns the device
+     * pointer to it. */
+    if (!buffers_->buffer.device_pointer) {
+      buffers_->buffer.copy_to_device();
+    }
+
+    /* Zero the rows rendered by each NUMA node from its own threads, so that the operating
+     * system places their memory pages on that node on first touch. */
+    float *render_buffer = buffers_->buffer.data();
+    const int64_t width = buffers_->params.width;
+    const int64_t height = buffers_->params.height;
+    const int64_t row_size = width * buffers_->params.pass_stride;
+
+    numa_arenas_->execute([&](const int arena_index) {
+      int64_t y_begin, y_end;
+      numa_arenas_->range(arena_index, height, &y_begin, &y_end);
+      parallel_for(y_begin, y_end, [&](int64_t y) {
+        memset(render_buffer + y * row_size, 0, sizeof(float) * row_size);
+      });
+    });
+    return true;
+  }
+
   buffers_->zero();
   return true;
 }
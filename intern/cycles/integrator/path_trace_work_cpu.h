@@ -11,6 +11,8 @@
 
 #include "integrator/path_trace_work.h"
 
+#include "util/task.h"
+#include "util/unique_ptr.h"
 #include "util/vector.h"
 
 CCL_NAMESPACE_BEGIN
@@ -83,6 +85,10 @@ class PathTraceWorkCPU : public PathTraceWork {
    * accessing it, but some "localization" is required to decouple from kernel globals stored
    * on the device level. */
   vector<CPUKernelThreadGlobals> kernel_thread_globals_;
+
+  /* Arenas pinned to NUMA nodes, when enabled and the system has multiple nodes. Every node
+   * zeroes a contiguous range of rows of the render buffer, and renders those rows first. */
+  unique_ptr<NumaTaskArenas> numa_arenas_;
 };
 
 CCL_NAMESPACE_END
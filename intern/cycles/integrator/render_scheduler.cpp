@@ -173,6 +173,7 @@ void RenderScheduler::reset(const BufferParams &buffer_params, int num_samples,
 
   path_trace_time_.reset();
   denoise_time_.reset();
+  denoise_overlap_time_.reset();
   adaptive_filter_time_.reset();
   display_update_time_.reset();
   rebalance_time_.reset();
@@ -551,6 +552,15 @@ void RenderScheduler::report_denoise_time(const RenderWork &render_work, double
   VLOG_WORK << "Average denoising time: " << denoise_time_.get_average() << " seconds.";
 }
 
+void RenderScheduler::report_denoise_overlap_time(double time)
+{
+  denoise_overlap_time_.add_wall(time);
+  denoise_overlap_time_.add_average(time);
+
+  VLOG_WORK << "Average overlapped denoising time: " << denoise_overlap_time_.get_average()
+            << " seconds.";
+}
+
 void RenderScheduler::report_display_update_time(const RenderWork &render_work, double time)
 {
   display_update_time_.add_wall(time);
@@ -671,6 +681,12 @@ string RenderScheduler::full_report() const
   if (denoiser_params_.use) {
     result += string_printf(
         "  %20s %20f %20f\n", "Denoiser", denoise_time_.get_wall(), denoise_time_.get_average());
+    if (denoise_overlap_time_.get_wall() > 0.0) {
+      result += string_printf("  %20s %20f %20f\n",
+                              "Denoiser (overlapped)",
+                              denoise_overlap_time_.get_wall(),
+                              denoise_overlap_time_.get_average());
+    }
   }
 
   result += string_printf("  %20s %20f %20f\n",
@@ -182,6 +182,8 @@ class RenderScheduler {
   void report_path_trace_occupancy(const RenderWork &render_work, float occupancy);
   void report_adaptive_filter_time(const RenderWork &render_work, double time, bool is_cancelled);
   void report_denoise_time(const RenderWork &render_work, double time);
+  /* Denoising which ran asynchronously while path tracing, and did not delay rendering. */
+  void report_denoise_overlap_time(double time);
   void report_display_update_time(const RenderWork &render_work, double time);
   void report_rebalance_time(const RenderWork &render_work, double time, bool balance_changed);
 
@@ -409,6 +411,7 @@ class RenderScheduler {
   TimeWithAverage path_trace_time_;
   TimeWithAverage adaptive_filter_time_;
   TimeWithAverage denoise_time_;
+  TimeWithAverage denoise_overlap_time_;
   TimeWithAverage display_update_time_;
   TimeWithAverage rebalance_time_;
 
@@ -98,6 +98,8 @@ ccl_device_intersect bool scene_intersect(KernelGlobals kg,
     return false;
   }
 
+  PROFILING_RAY(kg);
+
 #  ifdef __EMBREE__
   IF_USING_EMBREE
   {
@@ -171,6 +173,8 @@ ccl_device_intersect bool scene_intersect_local(KernelGlobals kg,
     return false;
   }
 
+  PROFILING_RAY(kg);
+
 #    ifdef __EMBREE__
   IF_USING_EMBREE
   {
@@ -236,6 +240,8 @@ ccl_device_intersect bool scene_intersect_shadow_all(KernelGlobals kg,
     return false;
   }
 
+  PROFILING_RAY(kg);
+
 #    ifdef __EMBREE__
   IF_USING_EMBREE
   {
@@ -301,6 +307,8 @@ ccl_device_intersect bool scene_intersect_volume(KernelGlobals kg,
     return false;
   }
 
+  PROFILING_RAY(kg);
+
 #    ifdef __EMBREE__
   IF_USING_EMBREE
   {
@@ -351,6 +359,8 @@ ccl_device_intersect uint scene_intersect_volume(KernelGlobals kg,
     return false;
   }
 
+  PROFILING_RAY(kg);
+
 #    ifdef __EMBREE__
   IF_USING_EMBREE
   {
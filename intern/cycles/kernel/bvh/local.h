@@ -78,6 +78,7 @@ ccl_device_inline
         int node_addr_child1, traverse_mask;
         float dist[2];
         float4 cnodes = kernel_data_fetch(bvh_nodes, node_addr + 0);
+        PROFILING_BVH_NODE(kg);
 
         traverse_mask = NODE_INTERSECT(kg,
                                        P,
@@ -138,6 +139,7 @@ ccl_device_inline
             /* intersect ray against primitive */
             for (; prim_addr < prim_addr2; prim_addr++) {
               kernel_assert(kernel_data_fetch(prim_type, prim_addr) == type);
+              PROFILING_BVH_PRIMITIVE(kg);
 
               /* Only intersect with matching object, for instanced objects we
                * already know we are only intersecting the right object. */
@@ -175,6 +177,7 @@ ccl_device_inline
             /* intersect ray against primitive */
             for (; prim_addr < prim_addr2; prim_addr++) {
               kernel_assert(kernel_data_fetch(prim_type, prim_addr) == type);
+              PROFILING_BVH_PRIMITIVE(kg);
 
               /* Only intersect with matching object, for instanced objects we
                * already know we are only intersecting the right object. */
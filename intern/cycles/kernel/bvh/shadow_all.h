@@ -73,6 +73,7 @@ ccl_device_inline
         int node_addr_child1, traverse_mask;
         float dist[2];
         float4 cnodes = kernel_data_fetch(bvh_nodes, node_addr + 0);
+        PROFILING_BVH_NODE(kg);
 
         traverse_mask = NODE_INTERSECT(kg,
                                        P,
@@ -132,6 +133,7 @@ ccl_device_inline
           for (; prim_addr < prim_addr2; prim_addr++) {
             kernel_assert((kernel_data_fetch(prim_type, prim_addr) & PRIMITIVE_ALL) ==
                           (type & PRIMITIVE_ALL));
+            PROFILING_BVH_PRIMITIVE(kg);
             bool hit;
 
             /* todo: specialized intersect functions which don't fill in
@@ -62,6 +62,7 @@ ccl_device_noinline bool BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals kg,
         int node_addr_child1, traverse_mask;
         float dist[2];
         float4 cnodes = kernel_data_fetch(bvh_nodes, node_addr + 0);
+        PROFILING_BVH_NODE(kg);
 
         {
           traverse_mask = NODE_INTERSECT(kg,
@@ -122,6 +123,7 @@ ccl_device_noinline bool BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals kg,
           /* primitive intersection */
           for (; prim_addr < prim_addr2; prim_addr++) {
             kernel_assert(kernel_data_fetch(prim_type, prim_addr) == type);
+            PROFILING_BVH_PRIMITIVE(kg);
 
             const int prim_object = (object == OBJECT_NONE) ?
                                         kernel_data_fetch(prim_object, prim_addr) :
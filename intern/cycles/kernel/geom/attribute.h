@@ -32,6 +32,15 @@ ccl_device_inline uint attribute_primitive_type(KernelGlobals kg, int prim, int
   }
 }
 
+/* Fetch a float2 attribute that is stored as two half floats in one element of the float
+ * attribute array. */
+ccl_device_inline float2 attribute_fetch_half2(KernelGlobals kg, const int index)
+{
+  ccl_global const half *data = (ccl_global const half *)(kernel_data_array(attributes_float) +
+                                                          index);
+  return make_float2(half_to_float_image(data[0]), half_to_float_image(data[1]));
+}
+
 ccl_device_inline AttributeDescriptor attribute_not_found()
 {
   const AttributeDescriptor desc = {
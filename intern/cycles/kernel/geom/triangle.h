@@ -207,7 +207,9 @@ ccl_device float2 triangle_attribute_float2(KernelGlobals kg,
                                             ccl_private float2 *dx,
                                             ccl_private float2 *dy)
 {
-  if (desc.element & (ATTR_ELEMENT_VERTEX | ATTR_ELEMENT_VERTEX_MOTION | ATTR_ELEMENT_CORNER)) {
+  if (desc.element & (ATTR_ELEMENT_VERTEX | ATTR_ELEMENT_VERTEX_MOTION | ATTR_ELEMENT_CORNER |
+                      ATTR_ELEMENT_CORNER_HALF))
+  {
     float2 f0, f1, f2;
 
     if (desc.element & (ATTR_ELEMENT_VERTEX | ATTR_ELEMENT_VERTEX_MOTION)) {
@@ -217,6 +219,12 @@ ccl_device float2 triangle_attribute_float2(KernelGlobals kg,
       f1 = kernel_data_fetch(attributes_float2, desc.offset + tri_vindex.y);
       f2 = kernel_data_fetch(attributes_float2, desc.offset + tri_vindex.z);
     }
+    else if (desc.element == ATTR_ELEMENT_CORNER_HALF) {
+      const int tri = desc.offset + sd->prim * 3;
+      f0 = attribute_fetch_half2(kg, tri + 0);
+      f1 = attribute_fetch_half2(kg, tri + 1);
+      f2 = attribute_fetch_half2(kg, tri + 2);
+    }
     else {
       const int tri = desc.offset + sd->prim * 3;
       f0 = kernel_data_fetch(attributes_float2, tri + 0);
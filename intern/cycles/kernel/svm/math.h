@@ -24,6 +24,44 @@ ccl_device_noinline void svm_node_math(KernelGlobals kg,
   stack_store_float(stack, result_stack_offset, result);
 }
 
+/* Sequence of float math operations, where every operation after the first one uses the result
+ * of the previous operation as one of its inputs. Intermediate results are kept in registers
+ * and only the final result is stored on the stack. */
+ccl_device_noinline int svm_node_math_chain(KernelGlobals kg,
+                                            ccl_private float *stack,
+                                            uint num_ops,
+                                            uint result_stack_offset,
+                                            int offset)
+{
+  float result = 0.0f;
+
+  for (uint i = 0; i < num_ops; i++) {
+    const uint4 op = read_node(kg, &offset);
+    const uint type = op.x & SVM_MATH_CHAIN_TYPE_MASK;
+    const uint chain_input = (op.x >> SVM_MATH_CHAIN_INPUT_SHIFT) & 0xf;
+    const uint constant_mask = op.x >> SVM_MATH_CHAIN_CONSTANT_SHIFT;
+    const uint operands[3] = {op.y, op.z, op.w};
+
+    float values[3];
+    for (uint j = 0; j < 3; j++) {
+      if (j == chain_input) {
+        values[j] = result;
+      }
+      else if (constant_mask & (1 << j)) {
+        values[j] = __uint_as_float(operands[j]);
+      }
+      else {
+        values[j] = stack_load_float(stack, operands[j]);
+      }
+    }
+
+    result = svm_math((NodeMathType)type, values[0], values[1], values[2]);
+  }
+
+  stack_store_float(stack, result_stack_offset, result);
+  return offset;
+}
+
 ccl_device_noinline int svm_node_vector_math(KernelGlobals kg,
                                              ccl_private ShaderData *sd,
                                              ccl_private float *stack,
@@ -107,9 +107,9 @@ SHADER_NODE_TYPE(NODE_MIX_COLOR)
 SHADER_NODE_TYPE(NODE_MIX_FLOAT)
 SHADER_NODE_TYPE(NODE_MIX_VECTOR)
 SHADER_NODE_TYPE(NODE_MIX_VECTOR_NON_UNIFORM)
+SHADER_NODE_TYPE(NODE_MATH_CHAIN)
 
 /* Padding for struct alignment. */
 SHADER_NODE_TYPE(NODE_PAD1)
-SHADER_NODE_TYPE(NODE_PAD2)
 
 #undef SHADER_NODE_TYPE
@@ -185,6 +185,14 @@ typedef enum NodeMathType {
   NODE_MATH_FLOORED_MODULO,
 } NodeMathType;
 
+/* Encoding of a single operation of NODE_MATH_CHAIN. The operation type is stored in the lower
+ * bits, followed by the index of the input that receives the result of the previous operation
+ * and a mask of inputs that are stored as constants rather than stack offsets. */
+#define SVM_MATH_CHAIN_TYPE_MASK 0xff
+#define SVM_MATH_CHAIN_INPUT_SHIFT 8
+#define SVM_MATH_CHAIN_INPUT_NONE 3
+#define SVM_MATH_CHAIN_CONSTANT_SHIFT 12
+
 typedef enum NodeVectorMathType {
   NODE_VECTOR_MATH_ADD,
   NODE_VECTOR_MATH_SUBTRACT,
@@ -876,7 +876,10 @@ typedef enum AttributeElement {
   ATTR_ELEMENT_CURVE = (1 << 7),
   ATTR_ELEMENT_CURVE_KEY = (1 << 8),
   ATTR_ELEMENT_CURVE_KEY_MOTION = (1 << 9),
-  ATTR_ELEMENT_VOXEL = (1 << 10)
+  ATTR_ELEMENT_VOXEL = (1 << 10),
+  /* Corner float2 attribute stored as two half floats in the float attribute array. Only used in
+   * device attribute descriptors, see #SceneParams::use_half_precision_attributes. */
+  ATTR_ELEMENT_CORNER_HALF = (1 << 11)
 } AttributeElement;
 
 typedef enum AttributeStandard {
@@ -18,11 +18,20 @@ CCL_NAMESPACE_BEGIN
     ProfilingWithShaderHelper profiling_helper((ProfilingState *)&kg->profiler, event)
 #  define PROFILING_SHADER(object, shader) \
     profiling_helper.set_shader(object, (shader) & SHADER_MASK);
+#  define PROFILING_RAY(kg) \
+    ProfilingRayHelper profiling_ray_helper((ProfilingState *)&kg->profiler)
+#  define PROFILING_BVH_NODE(kg) profiling_bvh_node((ProfilingState *)&kg->profiler)
+#  define PROFILING_BVH_PRIMITIVE(kg) profiling_bvh_primitive((ProfilingState *)&kg->profiler)
+#  define PROFILING_TEXTURE(kg, id) profiling_texture_lookup((ProfilingState *)&kg->profiler, id)
 #else
 #  define PROFILING_INIT(kg, event)
 #  define PROFILING_EVENT(event)
 #  define PROFILING_INIT_FOR_SHADER(kg, event)
 #  define PROFILING_SHADER(object, shader)
+#  define PROFILING_RAY(kg)
+#  define PROFILING_BVH_NODE(kg)
+#  define PROFILING_BVH_PRIMITIVE(kg)
+#  define PROFILING_TEXTURE(kg, id)
 #endif /* !__KERNEL_GPU__ */
 
 CCL_NAMESPACE_END
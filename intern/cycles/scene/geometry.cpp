@@ -499,6 +499,16 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
     device_update_flags |= DEVICE_POINT_DATA_NEEDS_REALLOC;
   }
 
+  if (scene->params.use_half_precision_attributes) {
+    /* Corner float2 attributes are stored in the float array in half precision. */
+    if (device_update_flags & ATTR_FLOAT2_MODIFIED) {
+      device_update_flags |= ATTR_FLOAT_MODIFIED;
+    }
+    if (device_update_flags & ATTR_FLOAT2_NEEDS_REALLOC) {
+      device_update_flags |= ATTR_FLOAT_NEEDS_REALLOC;
+    }
+  }
+
   /* tag the device arrays for reallocation or modification */
   DeviceScene *dscene = &scene->dscene;
 
@@ -878,13 +888,12 @@ void GeometryManager::device_update(Device *device,
       }
     });
 
+    vector<Mesh *> displace_meshes;
+
     foreach (Geometry *geom, scene->geometry) {
       if (geom->is_modified()) {
         if (geom->is_mesh()) {
-          Mesh *mesh = static_cast<Mesh *>(geom);
-          if (displace(device, scene, mesh, progress)) {
-            displacement_done = true;
-          }
+          displace_meshes.push_back(static_cast<Mesh *>(geom));
         }
         else if (geom->geometry_type == Geometry::HAIR) {
           Hair *hair = static_cast<Hair *>(geom);
@@ -904,6 +913,10 @@ void GeometryManager::device_update(Device *device,
         return;
       }
     }
+
+    if (displace(device, scene, displace_meshes, progress)) {
+      displacement_done = true;
+    }
   }
 
   if (progress.get_cancel()) {
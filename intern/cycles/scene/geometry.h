@@ -12,6 +12,7 @@
 #include "scene/attribute.h"
 
 #include "util/boundbox.h"
+#include "util/function.h"
 #include "util/set.h"
 #include "util/transform.h"
 #include "util/types.h"
@@ -29,6 +30,7 @@ class Scene;
 class SceneParams;
 class Shader;
 class Volume;
+template<typename T> class device_vector;
 struct PackedBVH;
 
 /* Set of flags used to help determining what data has been modified or needs reallocation, so we
@@ -246,8 +248,28 @@ class GeometryManager {
   /* Statistics */
   void collect_statistics(const Scene *scene, RenderStats *stats);
 
+  /* Evaluate the displacement shader for the inputs written by fill_input, and pass the results
+   * to read_output. */
+  typedef function<bool(int max_num_inputs,
+                        const function<int(device_vector<KernelShaderEvalInput> &)> &fill_input,
+                        const function<void(device_vector<float> &)> &read_output)>
+      DisplaceEvalFunction;
+
+  /* Apply displacement to all meshes with true displacement. The shaders of consecutive meshes
+   * are evaluated together, in batches of at most max_batch_inputs vertices unless a single mesh
+   * has more. Returns true if any mesh was displaced. */
+  static bool displace_meshes(const Scene *scene,
+                              const vector<Mesh *> &meshes,
+                              size_t max_batch_inputs,
+                              const DisplaceEvalFunction &eval,
+                              Progress &progress);
+
  protected:
-  bool displace(Device *device, Scene *scene, Mesh *mesh, Progress &progress);
+  /* Apply displacement to all meshes with true displacement, see #displace_meshes. */
+  bool displace(Device *device,
+                Scene *scene,
+                const vector<Mesh *> &meshes,
+                Progress &progress);
 
   void create_volume_mesh(const Scene *scene, Volume *volume, Progress &progress);
 
@@ -278,21 +300,23 @@ class GeometryManager {
   void device_update_volume_images(Device *device, Scene *scene, Progress &progress);
 
  private:
-  static void update_attribute_element_offset(Geometry *geom,
-                                              device_vector<float> &attr_float,
-                                              size_t &attr_float_offset,
-                                              device_vector<float2> &attr_float2,
-                                              size_t &attr_float2_offset,
-                                              device_vector<packed_float3> &attr_float3,
-                                              size_t &attr_float3_offset,
-                                              device_vector<float4> &attr_float4,
-                                              size_t &attr_float4_offset,
-                                              device_vector<uchar4> &attr_uchar4,
-                                              size_t &attr_uchar4_offset,
-                                              Attribute *mattr,
-                                              AttributePrimitive prim,
-                                              TypeDesc &type,
-                                              AttributeDescriptor &desc);
+  static void update_attribute_element_offset(
+      Geometry *geom,
+      device_vector<float> &attr_float,
+      size_t &attr_float_offset,
+      device_vector<float2> &attr_float2,
+      size_t &attr_float2_offset,
+      device_vector<packed_float3> &attr_float3,
+      size_t &attr_float3_offset,
+      device_vector<float4> &attr_float4,
+      size_t &attr_float4_offset,
+      device_vector<uchar4> &attr_uchar4,
+      size_t &attr_uchar4_offset,
+      Attribute *mattr,
+      AttributePrimitive prim,
+      TypeDesc &type,
+      AttributeDescriptor &desc,
+      const unordered_set<const Attribute *> &half_attributes);
 };
 
 CCL_NAMESPACE_END
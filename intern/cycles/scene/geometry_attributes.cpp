@@ -27,6 +27,7 @@
 #include "kernel/osl/globals.h"
 
 #include "util/foreach.h"
+#include "util/half.h"
 #include "util/log.h"
 #include "util/progress.h"
 #include "util/task.h"
@@ -273,21 +274,81 @@ void GeometryManager::update_svm_attributes(Device *,
   dscene->attributes_map.copy_to_device();
 }
 
-void GeometryManager::update_attribute_element_offset(Geometry *geom,
-                                                      device_vector<float> &attr_float,
-                                                      size_t &attr_float_offset,
-                                                      device_vector<float2> &attr_float2,
-                                                      size_t &attr_float2_offset,
-                                                      device_vector<packed_float3> &attr_float3,
-                                                      size_t &attr_float3_offset,
-                                                      device_vector<float4> &attr_float4,
-                                                      size_t &attr_float4_offset,
-                                                      device_vector<uchar4> &attr_uchar4,
-                                                      size_t &attr_uchar4_offset,
-                                                      Attribute *mattr,
-                                                      AttributePrimitive prim,
-                                                      TypeDesc &type,
-                                                      AttributeDescriptor &desc)
+/* Test whether the attribute can be stored in half precision on the device. Only corner float2
+ * attributes of non-subdivided triangle meshes are supported, which covers UV maps. Attributes
+ * with values outside of the [0, 1] range, like UV maps spanning multiple UDIM tiles, are kept
+ * in full precision, as half floats are too coarse for texture coordinates there. */
+static bool attribute_use_half_precision(Geometry *geom, const Attribute *mattr)
+{
+  if (!geom->is_mesh()) {
+    return false;
+  }
+  const Mesh *mesh = static_cast<const Mesh *>(geom);
+  if (mesh->get_subdivision_type() != Mesh::SUBDIVISION_NONE ||
+      mattr->element != ATTR_ELEMENT_CORNER || mattr->type != TypeFloat2)
+  {
+    return false;
+  }
+
+  const float2 *data = mattr->data_float2();
+  const size_t size = mattr->element_size(geom, ATTR_PRIM_GEOMETRY);
+  for (size_t i = 0; i < size; i++) {
+    if (!(data[i].x >= 0.0f && data[i].x <= 1.0f && data[i].y >= 0.0f && data[i].y <= 1.0f)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Find the requested geometry attributes that are stored in half precision, scanning the values
+ * of each attribute once, with geometries processed in parallel. */
+static void find_half_precision_attributes(Scene *scene,
+                                           vector<AttributeRequestSet> &geom_attributes,
+                                           unordered_set<const Attribute *> &half_attributes)
+{
+  vector<vector<const Attribute *>> geom_half_attributes(scene->geometry.size());
+
+  parallel_for(size_t(0), scene->geometry.size(), [&](const size_t i) {
+    Geometry *geom = scene->geometry[i];
+    foreach (AttributeRequest &req, geom_attributes[i].requests) {
+      const Attribute *attr = geom->attributes.find(req);
+      if (attr && attribute_use_half_precision(geom, attr)) {
+        geom_half_attributes[i].push_back(attr);
+      }
+    }
+  });
+
+  for (const vector<const Attribute *> &attributes : geom_half_attributes) {
+    half_attributes.insert(attributes.begin(), attributes.end());
+  }
+}
+
+static AttrKernelDataType attribute_kernel_type(
+    const Attribute *mattr, const unordered_set<const Attribute *> &half_attributes)
+{
+  if (half_attributes.count(mattr)) {
+    return AttrKernelDataType::FLOAT;
+  }
+  return Attribute::kernel_type(*mattr);
+}
+
+void GeometryManager::update_attribute_element_offset(
+    Geometry *geom,
+    device_vector<float> &attr_float,
+    size_t &attr_float_offset,
+    device_vector<float2> &attr_float2,
+    size_t &attr_float2_offset,
+    device_vector<packed_float3> &attr_float3,
+    size_t &attr_float3_offset,
+    device_vector<float4> &attr_float4,
+    size_t &attr_float4_offset,
+    device_vector<uchar4> &attr_uchar4,
+    size_t &attr_uchar4_offset,
+    Attribute *mattr,
+    AttributePrimitive prim,
+    TypeDesc &type,
+    AttributeDescriptor &desc,
+    const unordered_set<const Attribute *> &half_attributes)
 {
   if (mattr) {
     /* store element and type */
@@ -319,6 +380,23 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
       }
       attr_uchar4_offset += size;
     }
+    else if (half_attributes.count(mattr)) {
+      /* Pack both components as half floats into a single float. */
+      float2 *data = mattr->data_float2();
+      offset = attr_float_offset;
+      element = ATTR_ELEMENT_CORNER_HALF;
+
+      assert(attr_float.size() >= offset + size);
+      if (mattr->modified) {
+        half *attr_half = reinterpret_cast<half *>(attr_float.data() + offset);
+        for (size_t k = 0; k < size; k++) {
+          attr_half[k * 2 + 0] = float_to_half_attribute(data[k].x);
+          attr_half[k * 2 + 1] = float_to_half_attribute(data[k].y);
+        }
+        attr_float.tag_modified();
+      }
+      attr_float_offset += size;
+    }
     else if (mattr->type == TypeDesc::TypeFloat) {
       float *data = mattr->data_float();
       offset = attr_float_offset;
@@ -409,7 +487,9 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
           offset -= mesh->face_offset;
         }
       }
-      else if (element == ATTR_ELEMENT_CORNER || element == ATTR_ELEMENT_CORNER_BYTE) {
+      else if (element == ATTR_ELEMENT_CORNER || element == ATTR_ELEMENT_CORNER_BYTE ||
+               element == ATTR_ELEMENT_CORNER_HALF)
+      {
         if (prim == ATTR_PRIM_GEOMETRY) {
           offset -= 3 * mesh->prim_offset;
         }
@@ -453,7 +533,9 @@ static void update_attribute_element_size(Geometry *geom,
                                           size_t *attr_float2_size,
                                           size_t *attr_float3_size,
                                           size_t *attr_float4_size,
-                                          size_t *attr_uchar4_size)
+                                          size_t *attr_uchar4_size,
+                                          size_t *attr_half_size,
+                                          const unordered_set<const Attribute *> &half_attributes)
 {
   if (mattr) {
     size_t size = mattr->element_size(geom, prim);
@@ -464,6 +546,10 @@ static void update_attribute_element_size(Geometry *geom,
     else if (mattr->element == ATTR_ELEMENT_CORNER_BYTE) {
       *attr_uchar4_size += size;
     }
+    else if (half_attributes.count(mattr)) {
+      *attr_float_size += size;
+      *attr_half_size += size;
+    }
     else if (mattr->type == TypeDesc::TypeFloat) {
       *attr_float_size += size;
     }
@@ -555,6 +641,12 @@ void GeometryManager::device_update_attributes(Device *device,
   size_t attr_float3_size = 0;
   size_t attr_float4_size = 0;
   size_t attr_uchar4_size = 0;
+  /* Number of elements stored in half precision, included in attr_float_size. */
+  size_t attr_half_size = 0;
+  unordered_set<const Attribute *> half_attributes;
+  if (scene->params.use_half_precision_attributes) {
+    find_half_precision_attributes(scene, geom_attributes, half_attributes);
+  }
 
   for (size_t i = 0; i < scene->geometry.size(); i++) {
     Geometry *geom = scene->geometry[i];
@@ -569,7 +661,9 @@ void GeometryManager::device_update_attributes(Device *device,
                                     &attr_float2_size,
                                     &attr_float3_size,
                                     &attr_float4_size,
-                                    &attr_uchar4_size);
+                                    &attr_uchar4_size,
+                                    &attr_half_size,
+                                    half_attributes);
 
       if (geom->is_mesh()) {
         Mesh *mesh = static_cast<Mesh *>(geom);
@@ -582,7 +676,9 @@ void GeometryManager::device_update_attributes(Device *device,
                                       &attr_float2_size,
                                       &attr_float3_size,
                                       &attr_float4_size,
-                                      &attr_uchar4_size);
+                                      &attr_uchar4_size,
+                                      &attr_half_size,
+                                      half_attributes);
       }
     }
   }
@@ -598,10 +694,19 @@ void GeometryManager::device_update_attributes(Device *device,
                                     &attr_float2_size,
                                     &attr_float3_size,
                                     &attr_float4_size,
-                                    &attr_uchar4_size);
+                                    &attr_uchar4_size,
+                                    &attr_half_size,
+                                    half_attributes);
     }
   }
 
+  if (attr_half_size) {
+    VLOG_INFO << "Storing " << attr_half_size
+              << " attribute elements in half precision, saving "
+              << string_human_readable_size(attr_half_size * (sizeof(float2) - sizeof(float)))
+              << " of device memory.";
+  }
+
   dscene->attributes_float.alloc(attr_float_size);
   dscene->attributes_float2.alloc(attr_float2_size);
   dscene->attributes_float3.alloc(attr_float3_size);
@@ -635,7 +740,7 @@ void GeometryManager::device_update_attributes(Device *device,
 
       if (attr) {
         /* force a copy if we need to reallocate all the data */
-        attr->modified |= attributes_need_realloc[Attribute::kernel_type(*attr)];
+        attr->modified |= attributes_need_realloc[attribute_kernel_type(attr, half_attributes)];
       }
 
       update_attribute_element_offset(geom,
@@ -652,7 +757,8 @@ void GeometryManager::device_update_attributes(Device *device,
                                       attr,
                                       ATTR_PRIM_GEOMETRY,
                                       req.type,
-                                      req.desc);
+                                      req.desc,
+                                      half_attributes);
 
       if (geom->is_mesh()) {
         Mesh *mesh = static_cast<Mesh *>(geom);
@@ -660,7 +766,8 @@ void GeometryManager::device_update_attributes(Device *device,
 
         if (subd_attr) {
           /* force a copy if we need to reallocate all the data */
-          subd_attr->modified |= attributes_need_realloc[Attribute::kernel_type(*subd_attr)];
+          subd_attr->modified |=
+              attributes_need_realloc[attribute_kernel_type(subd_attr, half_attributes)];
         }
 
         update_attribute_element_offset(mesh,
@@ -677,7 +784,8 @@ void GeometryManager::device_update_attributes(Device *device,
                                         subd_attr,
                                         ATTR_PRIM_SUBD,
                                         req.subd_type,
-                                        req.subd_desc);
+                                        req.subd_desc,
+                                        half_attributes);
       }
 
       if (progress.get_cancel()) {
@@ -695,7 +803,7 @@ void GeometryManager::device_update_attributes(Device *device,
       Attribute *attr = values.find(req);
 
       if (attr) {
-        attr->modified |= attributes_need_realloc[Attribute::kernel_type(*attr)];
+        attr->modified |= attributes_need_realloc[attribute_kernel_type(attr, half_attributes)];
       }
 
       update_attribute_element_offset(object->geometry,
@@ -712,7 +820,8 @@ void GeometryManager::device_update_attributes(Device *device,
                                       attr,
                                       ATTR_PRIM_GEOMETRY,
                                       req.type,
-                                      req.desc);
+                                      req.desc,
+                                      half_attributes);
 
       /* object attributes don't care about subdivision */
       req.subd_type = req.type;
@@ -92,6 +92,7 @@ void Geometry::compute_bvh(Device *device,
       bparams.num_motion_point_steps = params->num_bvh_time_steps;
       bparams.bvh_type = params->bvh_type;
       bparams.curve_subdivisions = params->curve_subdivisions();
+      bparams.use_compact_curves = params->use_bvh_compact_curves;
 
       delete bvh;
       bvh = BVH::create(bparams, geometry, objects, device);
@@ -123,6 +124,7 @@ void GeometryManager::device_update_bvh(Device *device,
   bparams.num_motion_point_steps = scene->params.num_bvh_time_steps;
   bparams.bvh_type = scene->params.bvh_type;
   bparams.curve_subdivisions = scene->params.curve_subdivisions();
+  bparams.use_compact_curves = scene->params.use_bvh_compact_curves;
 
   VLOG_INFO << "Using " << bvh_layout_name(bparams.bvh_layout) << " layout.";
 
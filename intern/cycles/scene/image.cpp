@@ -15,6 +15,7 @@
 #include "util/image_impl.h"
 #include "util/log.h"
 #include "util/path.h"
+#include "util/profiling.h"
 #include "util/progress.h"
 #include "util/task.h"
 #include "util/texture.h"
@@ -461,8 +462,38 @@ size_t ImageManager::add_image_slot(ImageLoader *loader,
   /* Find existing image. */
   for (slot = 0; slot < images.size(); slot++) {
     img = images[slot];
+#ifdef WITH_OPENVDB
+    if (img && img->params == params && loader->is_vdb_loader() && img->loader->is_vdb_loader())
+    {
+      /* Another grid of the same tree can reuse the image when their contents match. The hash of
+       * the image is computed while loading its metadata under the image lock, so wait for that
+       * before hashing the new loader to compare them. */
+      VDBImageLoader *vdb_loader = static_cast<VDBImageLoader *>(loader);
+      VDBImageLoader *vdb_img_loader = static_cast<VDBImageLoader *>(img->loader);
+      if (vdb_loader->get_grid() != vdb_img_loader->get_grid() &&
+          vdb_loader->shares_tree(*vdb_img_loader))
+      {
+        load_image_metadata(img);
+        if (vdb_img_loader->has_grid_hash()) {
+          vdb_loader->compute_grid_hash();
+        }
+      }
+    }
+#endif
+
     if (img && ImageLoader::equals(img->loader, loader) && img->params == params) {
       img->users++;
+      if (loader->is_vdb_loader()) {
+        /* Keep the new loader, the existing one may have freed its grid after loading while
+         * the grid is still needed to build the volume mesh. If metadata is still being loaded
+         * in the background, the existing loader did not free anything yet. */
+        thread_scoped_lock image_lock(img->mutex, std::try_to_lock);
+        if (image_lock.owns_lock() && !img->need_metadata) {
+          static_cast<VDBImageLoader *>(loader)->copy_metadata_state(
+              *static_cast<VDBImageLoader *>(img->loader));
+          std::swap(img->loader, loader);
+        }
+      }
       delete loader;
       return slot;
     }
@@ -493,6 +524,11 @@ size_t ImageManager::add_image_slot(ImageLoader *loader,
 
   need_update_ = true;
 
+  if (loader->is_vdb_loader()) {
+    /* Convert the grid while the rest of the scene is synchronized. */
+    metadata_pool.push(function_bind(&ImageManager::load_image_metadata, this, img));
+  }
+
   return slot;
 }
 
@@ -834,6 +870,9 @@ void ImageManager::device_free_image(Device *, size_t slot)
     return;
   }
 
+  /* Metadata may still be loading in the background. */
+  metadata_pool.wait_work();
+
   if (osl_texture_system) {
 #ifdef WITH_OSL
     ustring filepath = img->loader->osl_filepath();
@@ -948,6 +987,22 @@ void ImageManager::collect_statistics(RenderStats *stats)
   }
 }
 
+void ImageManager::collect_profiling(RenderStats *stats, Profiler &prof)
+{
+  for (size_t slot = 0; slot < images.size(); slot++) {
+    const Image *image = images[slot];
+    uint64_t hits;
+    if (image && prof.get_texture(slot, hits)) {
+      stats->texture_lookups.add_entry(NamedSizeEntry(image->loader->name(), hits));
+    }
+  }
+}
+
+size_t ImageManager::num_slots() const
+{
+  return images.size();
+}
+
 void ImageManager::tag_update()
 {
   need_update_ = true;
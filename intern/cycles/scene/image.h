@@ -10,6 +10,7 @@
 #include "scene/colorspace.h"
 
 #include "util/string.h"
+#include "util/task.h"
 #include "util/thread.h"
 #include "util/transform.h"
 #include "util/unique_ptr.h"
@@ -23,6 +24,7 @@ class ImageHandle;
 class ImageKey;
 class ImageMetaData;
 class ImageManager;
+class Profiler;
 class Progress;
 class RenderStats;
 class Scene;
@@ -190,6 +192,10 @@ class ImageManager {
   bool set_animation_frame_update(int frame);
 
   void collect_statistics(RenderStats *stats);
+  void collect_profiling(RenderStats *stats, Profiler &prof);
+
+  /* Number of image slots, which are the texture IDs used by the kernel. */
+  size_t num_slots() const;
 
   void tag_update();
 
@@ -224,6 +230,10 @@ class ImageManager {
   vector<Image *> images;
   void *osl_texture_system;
 
+  /* Metadata of volume grids loaded in the background as they are added, since for NanoVDB this
+   * includes the conversion of the grid. */
+  TaskPool metadata_pool;
+
   size_t add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(size_t slot);
   void remove_image_user(size_t slot);
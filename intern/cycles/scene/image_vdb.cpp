@@ -5,7 +5,10 @@
 #include "scene/image_vdb.h"
 
 #include "util/log.h"
+#include "util/map.h"
+#include "util/murmurhash.h"
 #include "util/openvdb.h"
+#include "util/thread.h"
 
 #ifdef WITH_OPENVDB
 #  include <openvdb/tools/Dense.h>
@@ -110,8 +113,150 @@ struct ToNanoOp {
     }
   }
 };
+
+/* Converted NanoVDB grids, shared by all loaders of the same tree with the same precision. This
+ * avoids converting a grid multiple times when it is used by multiple objects. The cache does not
+ * own the converted grids, they are freed once all loaders uploaded them to the device. */
+struct NanoVDBCacheEntry {
+  std::weak_ptr<const openvdb::TreeBase> tree;
+  uint32_t grid_hash = 0;
+
+  /* Held while converting, so loaders of the same grid wait for a single conversion. */
+  thread_mutex mutex;
+  std::weak_ptr<const nanovdb::GridHandle<>> nanogrid;
+};
+
+typedef std::pair<const openvdb::TreeBase *, int> NanoVDBCacheKey;
+
+static thread_mutex nanovdb_cache_mutex;
+static map<NanoVDBCacheKey, std::shared_ptr<NanoVDBCacheEntry>> nanovdb_cache;
+
+static bool nanovdb_cache_convert(const openvdb::GridBase::ConstPtr &grid,
+                                  const int precision,
+                                  const uint32_t grid_hash,
+                                  std::shared_ptr<const nanovdb::GridHandle<>> &nanogrid)
+{
+  openvdb::TreeBase::ConstPtr tree = grid->constBaseTreePtr();
+  std::shared_ptr<NanoVDBCacheEntry> entry;
+  {
+    thread_scoped_lock cache_lock(nanovdb_cache_mutex);
+
+    /* Remove entries of freed trees, before their address can be reused by a new tree, and
+     * entries of grids that are no longer used by any loader. */
+    for (auto it = nanovdb_cache.begin(); it != nanovdb_cache.end();) {
+      if (it->second->tree.expired() ||
+          (it->second.use_count() == 1 && it->second->nanogrid.expired()))
+      {
+        it = nanovdb_cache.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+
+    std::shared_ptr<NanoVDBCacheEntry> &cached = nanovdb_cache[{tree.get(), precision}];
+    if (!cached || cached->grid_hash != grid_hash) {
+      cached = std::make_shared<NanoVDBCacheEntry>();
+      cached->tree = tree;
+      cached->grid_hash = grid_hash;
+    }
+    entry = cached;
+  }
+
+  thread_scoped_lock entry_lock(entry->mutex);
+  nanogrid = entry->nanogrid.lock();
+  if (!nanogrid) {
+    ToNanoOp op;
+    op.precision = precision;
+    if (!openvdb::grid_type_operation(grid, op)) {
+      return false;
+    }
+    if (op.nanogrid) {
+      nanogrid = std::make_shared<const nanovdb::GridHandle<>>(std::move(op.nanogrid));
+      entry->nanogrid = nanogrid;
+    }
+  }
+  return true;
+}
 #  endif
 
+/* Hash of the values stored in the leaf buffers and active tiles of a tree. */
+struct ValueHashOp {
+  uint32_t hash = 0;
+
+  template<typename GridType, typename FloatGridType, typename FloatDataType, int channels>
+  bool operator()(const openvdb::GridBase::ConstPtr &grid)
+  {
+    using TreeType = typename GridType::TreeType;
+    using ValueType = typename GridType::ValueType;
+    if constexpr (std::is_same_v<GridType, openvdb::MaskGrid>) {
+      /* Only topology, which is already part of the hash. */
+      return true;
+    }
+    else {
+      const TreeType &tree = openvdb::gridConstPtrCast<GridType>(grid)->tree();
+      if constexpr (std::is_same_v<ValueType, bool>) {
+        for (typename TreeType::ValueOnCIter iter = tree.cbeginValueOn(); iter; ++iter) {
+          const openvdb::Coord coord = iter.getCoord();
+          const bool value = iter.getValue();
+          hash = util_murmur_hash3(&coord, sizeof(coord), hash);
+          hash = util_murmur_hash3(&value, sizeof(value), hash);
+        }
+      }
+      else {
+        for (typename TreeType::LeafCIter leaf = tree.cbeginLeaf(); leaf; ++leaf) {
+          hash = util_murmur_hash3(
+              leaf->buffer().data(), int(sizeof(ValueType) * leaf->SIZE), hash);
+        }
+        typename TreeType::ValueOnCIter tile = tree.cbeginValueOn();
+        tile.setMaxDepth(TreeType::ValueOnCIter::LEAF_DEPTH - 1);
+        for (; tile; ++tile) {
+          const openvdb::Coord coord = tile.getCoord();
+          const ValueType value = tile.getValue();
+          hash = util_murmur_hash3(&coord, sizeof(coord), hash);
+          hash = util_murmur_hash3(&value, sizeof(value), hash);
+        }
+      }
+      return true;
+    }
+  }
+};
+
+/* Hash of the grid transform, of the topology of its tree and of its values. This is cheap
+ * compared to a conversion, and guards against trees that were modified in place. */
+static uint32_t grid_compute_hash(const openvdb::GridBase::ConstPtr &grid)
+{
+  struct {
+    uint64_t active_voxel_count;
+    uint64_t leaf_count;
+    int32_t bbox[6];
+    double transform[16];
+  } signature;
+  memset(&signature, 0, sizeof(signature));
+
+  const openvdb::TreeBase &tree = grid->baseTree();
+  signature.active_voxel_count = tree.activeVoxelCount();
+  signature.leaf_count = tree.leafCount();
+
+  openvdb::CoordBBox bbox;
+  if (tree.evalActiveVoxelBoundingBox(bbox)) {
+    for (int i = 0; i < 3; i++) {
+      signature.bbox[i] = bbox.min()[i];
+      signature.bbox[i + 3] = bbox.max()[i];
+    }
+  }
+
+  const openvdb::math::Mat4d matrix = grid->transform().baseMap()->getAffineMap()->getMat4();
+  for (int i = 0; i < 16; i++) {
+    signature.transform[i] = matrix.asPointer()[i];
+  }
+
+  ValueHashOp op;
+  op.hash = util_murmur_hash3(&signature, sizeof(signature), 0);
+  openvdb::grid_type_operation(grid, op);
+  return op.hash;
+}
+
 VDBImageLoader::VDBImageLoader(openvdb::GridBase::ConstPtr grid_, const string &grid_name)
     : grid_name(grid_name), grid(grid_)
 {
@@ -137,21 +282,25 @@ bool VDBImageLoader::load_metadata(const ImageDeviceFeatures &features, ImageMet
 
   metadata.channels = op.num_channels;
 
+  /* Remember the identity of the grid contents for equals() after cleanup. */
+  tree = grid->constBaseTreePtr();
+
   /* Set data type. */
 #  ifdef WITH_NANOVDB
   if (features.has_nanovdb) {
+    /* The hash validates the cached conversion of the tree, and is kept to reuse this image for
+     * other grids of the same tree. */
+    compute_grid_hash();
+
     /* NanoVDB expects no inactive leaf nodes. */
 #    if 0
     openvdb::FloatGrid &pruned_grid = *openvdb::gridPtrCast<openvdb::FloatGrid>(grid);
     openvdb::tools::pruneInactive(pruned_grid.tree());
     nanogrid = nanovdb::openToNanoVDB(pruned_grid);
 #    endif
-    ToNanoOp op;
-    op.precision = precision;
-    if (!openvdb::grid_type_operation(grid, op)) {
+    if (!nanovdb_cache_convert(grid, precision, grid_hash, nanogrid)) {
       return false;
     }
-    nanogrid = std::move(op.nanogrid);
   }
 #  endif
 
@@ -168,7 +317,7 @@ bool VDBImageLoader::load_metadata(const ImageDeviceFeatures &features, ImageMet
 
 #  ifdef WITH_NANOVDB
   if (nanogrid) {
-    metadata.byte_size = nanogrid.size();
+    metadata.byte_size = nanogrid->size();
     if (metadata.channels == 1) {
       if (precision == 0) {
         metadata.type = IMAGE_DATA_TYPE_NANOVDB_FPN;
@@ -231,12 +380,27 @@ bool VDBImageLoader::load_metadata(const ImageDeviceFeatures &features, ImageMet
 #endif
 }
 
-bool VDBImageLoader::load_pixels(const ImageMetaData &, void *pixels, const size_t, const bool)
+bool VDBImageLoader::load_pixels(const ImageMetaData &metadata,
+                                 void *pixels,
+                                 const size_t,
+                                 const bool)
 {
 #ifdef WITH_OPENVDB
 #  ifdef WITH_NANOVDB
-  if (nanogrid) {
-    memcpy(pixels, nanogrid.data(), nanogrid.size());
+  const bool is_nanovdb = metadata.type == IMAGE_DATA_TYPE_NANOVDB_FLOAT ||
+                          metadata.type == IMAGE_DATA_TYPE_NANOVDB_FLOAT3 ||
+                          metadata.type == IMAGE_DATA_TYPE_NANOVDB_FPN ||
+                          metadata.type == IMAGE_DATA_TYPE_NANOVDB_FP16;
+  if (is_nanovdb && !nanogrid) {
+    /* The converted grid was freed after a previous upload, or the metadata was loaded by
+     * another loader of the same grid. */
+    if (!grid || !nanovdb_cache_convert(grid, precision, grid_hash, nanogrid) || !nanogrid)
+    {
+      return false;
+    }
+  }
+  if (is_nanovdb) {
+    memcpy(pixels, nanogrid->data(), nanogrid->size());
   }
   else
 #  endif
@@ -248,6 +412,7 @@ bool VDBImageLoader::load_pixels(const ImageMetaData &, void *pixels, const size
   }
   return true;
 #else
+  (void)metadata;
   (void)pixels;
   return false;
 #endif
@@ -262,13 +427,42 @@ bool VDBImageLoader::equals(const ImageLoader &other) const
 {
 #ifdef WITH_OPENVDB
   const VDBImageLoader &other_loader = (const VDBImageLoader &)other;
-  return grid == other_loader.grid;
+#  ifdef WITH_NANOVDB
+  if (precision != other_loader.precision) {
+    return false;
+  }
+#  endif
+  if (grid == other_loader.grid) {
+    return true;
+  }
+
+  /* Different grids of the same tree and transform, as used by multiple objects or across
+   * frames when the grid did not change. Without hashes, the contents may differ. */
+  if (!shares_tree(other_loader)) {
+    return false;
+  }
+  return has_grid_hash() && grid_hash == other_loader.grid_hash;
 #else
   (void)other;
   return true;
 #endif
 }
 
+void VDBImageLoader::copy_metadata_state(const VDBImageLoader &other)
+{
+#ifdef WITH_OPENVDB
+  bbox = other.bbox;
+  tree = other.tree;
+  if (grid_hash == 0) {
+    grid_hash = other.grid_hash;
+  }
+#endif
+#ifdef WITH_NANOVDB
+  nanogrid = other.nanogrid;
+#endif
+  (void)other;
+}
+
 void VDBImageLoader::cleanup()
 {
 #ifdef WITH_OPENVDB
@@ -290,6 +484,29 @@ openvdb::GridBase::ConstPtr VDBImageLoader::get_grid()
 {
   return grid;
 }
+
+openvdb::TreeBase::ConstPtr VDBImageLoader::get_tree() const
+{
+  return (grid) ? grid->constBaseTreePtr() : tree.lock();
+}
+
+bool VDBImageLoader::shares_tree(const VDBImageLoader &other) const
+{
+  openvdb::TreeBase::ConstPtr tree = get_tree();
+  return tree && tree == other.get_tree();
+}
+
+bool VDBImageLoader::has_grid_hash() const
+{
+  return grid_hash != 0;
+}
+
+void VDBImageLoader::compute_grid_hash()
+{
+  if (grid_hash == 0 && grid) {
+    grid_hash = grid_compute_hash(grid);
+  }
+}
 #endif
 
 CCL_NAMESPACE_END
@@ -9,6 +9,7 @@
 #  include <openvdb/openvdb.h>
 #endif
 #ifdef WITH_NANOVDB
+#  include <memory>
 #  include <nanovdb/util/GridHandle.h>
 #endif
 
@@ -40,18 +41,39 @@ class VDBImageLoader : public ImageLoader {
 
   virtual bool is_vdb_loader() const override;
 
+  /* Use the state computed by #load_metadata of an equal loader, for when this loader replaces
+   * it in an image whose metadata is already loaded. */
+  void copy_metadata_state(const VDBImageLoader &other);
+
 #ifdef WITH_OPENVDB
   openvdb::GridBase::ConstPtr get_grid();
+
+  /* Loaders of different grids that share a tree compare equal when the hashes of their contents
+   * match. The hash is computed on demand since it visits every voxel, and is never computed for
+   * a loader that is already shared between threads without holding its image lock. */
+  bool shares_tree(const VDBImageLoader &other) const;
+  bool has_grid_hash() const;
+  void compute_grid_hash();
 #endif
 
  protected:
+#ifdef WITH_OPENVDB
+  openvdb::TreeBase::ConstPtr get_tree() const;
+#endif
+
   string grid_name;
 #ifdef WITH_OPENVDB
   openvdb::GridBase::ConstPtr grid;
   openvdb::CoordBBox bbox;
+
+  /* Identity of the grid contents, kept after cleanup so that an image that is still loaded can
+   * be reused for a grid that did not change. */
+  std::weak_ptr<const openvdb::TreeBase> tree;
+  uint32_t grid_hash = 0;
 #endif
 #ifdef WITH_NANOVDB
-  nanovdb::GridHandle<> nanogrid;
+  /* Converted grid, shared with all loaders of the same tree. */
+  std::shared_ptr<const nanovdb::GridHandle<>> nanogrid;
   int precision = 0;
 #endif
 };
@@ -218,6 +218,7 @@ LightManager::LightManager()
   need_update_background = true;
   last_background_enabled = false;
   last_background_resolution = 0;
+  light_tree_cache = make_unique<LightTreeCache>();
 }
 
 LightManager::~LightManager()
@@ -808,11 +809,14 @@ void LightManager::device_update_tree(Device *,
   /* TODO: For now, we'll start with a smaller number of max lights in a node.
    * More benchmarking is needed to determine what number works best. */
   LightTree light_tree(scene, dscene, progress, 8);
-  LightTreeNode *root = light_tree.build(scene, dscene);
+  LightTreeNode *root = light_tree.build(scene, dscene, light_tree_cache.get());
   if (progress.get_cancel()) {
     return;
   }
 
+  VLOG_INFO << "Light tree reused " << light_tree_cache->num_reused << " and built "
+            << light_tree_cache->num_built << " emissive mesh subtrees.";
+
   /* Create arguments for recursive tree flatten. */
   LightTreeFlatten flatten;
   flatten.scene = scene;
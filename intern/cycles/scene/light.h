@@ -16,12 +16,14 @@
 #include "util/ies.h"
 #include "util/thread.h"
 #include "util/types.h"
+#include "util/unique_ptr.h"
 #include "util/vector.h"
 
 CCL_NAMESPACE_BEGIN
 
 class Device;
 class DeviceScene;
+class LightTreeCache;
 class Progress;
 class Scene;
 class Shader;
@@ -166,6 +168,9 @@ class LightManager {
   bool last_background_enabled;
   int last_background_resolution;
 
+  /* Subtrees of emissive meshes, reused by the next light tree build if they did not change. */
+  unique_ptr<LightTreeCache> light_tree_cache;
+
   uint32_t update_flags;
 };
 
@@ -6,6 +6,7 @@
 #include "scene/mesh.h"
 #include "scene/object.h"
 
+#include "util/murmurhash.h"
 #include "util/progress.h"
 
 CCL_NAMESPACE_BEGIN
@@ -252,12 +253,95 @@ bool LightTree::triangle_usable_as_light(Mesh *mesh, int prim_id)
   return false;
 }
 
-void LightTree::add_mesh(Scene *scene, Mesh *mesh, int object_id)
+uint64_t LightTree::mesh_cache_key(const Mesh *mesh, const Object *object)
 {
-  size_t mesh_num_triangles = mesh->num_triangles();
-  for (size_t i = 0; i < mesh_num_triangles; i++) {
-    if (triangle_usable_as_light(mesh, i)) {
-      emitters_.emplace_back(scene, i, object_id);
+  /* Hash everything that the triangle emitters of the mesh and the subtree built from them depend
+   * on. Two seeds are used to get a 64 bit key. */
+  uint32_t hash[2] = {0, 1};
+  auto add = [&](const void *data, size_t size) {
+    const char *bytes = static_cast<const char *>(data);
+    while (size > 0) {
+      const int len = int(min(size, size_t(1) << 30));
+      hash[0] = util_murmur_hash3(bytes, len, hash[0]);
+      hash[1] = util_murmur_hash3(bytes, len, hash[1]);
+      bytes += len;
+      size -= len;
+    }
+  };
+
+  const array<float3> &verts = mesh->get_verts();
+  const array<int> &triangles = mesh->get_triangles();
+  const array<int> &shader = mesh->get_shader();
+  add(verts.data(), verts.size() * sizeof(float3));
+  add(triangles.data(), triangles.size() * sizeof(int));
+  add(shader.data(), shader.size() * sizeof(int));
+
+  for (const Node *node : mesh->get_used_shaders()) {
+    const Shader *used_shader = static_cast<const Shader *>(node);
+    const float emission[3] = {used_shader->emission_estimate.x,
+                               used_shader->emission_estimate.y,
+                               used_shader->emission_estimate.z};
+    add(&used_shader, sizeof(used_shader));
+    add(emission, sizeof(emission));
+    add(&used_shader->emission_sampling, sizeof(used_shader->emission_sampling));
+  }
+
+  const uint64_t light_set_membership = object->get_light_set_membership();
+  const bool negative_scale = mesh->transform_applied &&
+                              transform_negative_scale(object->get_tfm());
+  add(&light_set_membership, sizeof(light_set_membership));
+  add(&negative_scale, sizeof(negative_scale));
+  add(&mesh->transform_applied, sizeof(mesh->transform_applied));
+  add(&max_lights_in_leaf_, sizeof(max_lights_in_leaf_));
+
+  return (uint64_t(hash[0]) << 32) | hash[1];
+}
+
+int LightTree::cache_store(const LightTreeNode *node,
+                           const int first_emitter,
+                           LightTreeCache::Entry &entry)
+{
+  const int index = entry.nodes.size();
+  entry.nodes.push_back({node->measure,
+                         node->light_link,
+                         node->bit_trail,
+                         node->type & ~LIGHT_TREE_INSTANCE,
+                         {0, 0}});
+
+  if (node->is_leaf()) {
+    entry.nodes[index].data[0] = node->get_leaf().first_emitter_index - first_emitter;
+    entry.nodes[index].data[1] = node->get_leaf().num_emitters;
+  }
+  else {
+    const int left_index = cache_store(
+        node->get_inner().children[left].get(), first_emitter, entry);
+    const int right_index = cache_store(
+        node->get_inner().children[right].get(), first_emitter, entry);
+    entry.nodes[index].data[0] = left_index;
+    entry.nodes[index].data[1] = right_index;
+  }
+
+  return index;
+}
+
+void LightTree::cache_restore(LightTreeNode *node,
+                              const LightTreeCache::Entry &entry,
+                              const int index,
+                              const int first_emitter)
+{
+  const LightTreeCache::Node &cached = entry.nodes[index];
+  node->measure = cached.measure;
+  node->light_link = cached.light_link;
+  node->bit_trail = cached.bit_trail;
+
+  if (cached.type & LIGHT_TREE_LEAF) {
+    node->make_leaf(first_emitter + cached.data[0], cached.data[1]);
+  }
+  else {
+    for (int child = left; child <= right; child++) {
+      node->get_inner().children[child] = create_node(LightTreeMeasure::empty, 0);
+      cache_restore(
+          node->get_inner().children[child].get(), entry, cached.data[child], first_emitter);
     }
   }
 }
@@ -320,7 +404,7 @@ LightTree::LightTree(Scene *scene,
   }
 }
 
-LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
+LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene, LightTreeCache *cache)
 {
   if (local_lights_.empty() && distant_lights_.empty() && mesh_lights_.empty()) {
     return nullptr;
@@ -331,45 +415,157 @@ LightTreeNode *LightTree::build(Scene *scene, DeviceScene *dscene)
   const int num_distant_lights = distant_lights_.size();
 
   /* Create a node for each mesh light, and keep track of unique mesh lights. */
-  std::unordered_map<Mesh *, std::tuple<LightTreeNode *, int, int>> unique_mesh;
+  struct UniqueMesh {
+    Mesh *mesh;
+    int object_id;
+    LightTreeNode *root;
+    /* Range of the emissive triangles in `emitters_`. */
+    int start = 0;
+    int end = 0;
+    /* Emissive triangles, only filled in when the subtree is not taken from the cache. */
+    vector<int> prim_ids;
+    LightTreeCache::Entry *cache_entry = nullptr;
+    bool use_cache = false;
+  };
+  vector<UniqueMesh> unique_meshes;
+  std::unordered_map<Mesh *, int> unique_mesh_index;
+
   uint *object_offsets = dscene->object_lookup_offset.alloc(scene->objects.size());
-  emitters_.reserve(num_triangles + num_local_lights + num_distant_lights);
   for (LightTreeEmitter &emitter : mesh_lights_) {
     Object *object = scene->objects[emitter.object_id];
     Mesh *mesh = static_cast<Mesh *>(object->get_geometry());
     emitter.root = create_node(LightTreeMeasure::empty, 0);
 
-    auto map_it = unique_mesh.find(mesh);
-    if (map_it == unique_mesh.end()) {
-      const int start = emitters_.size();
-      add_mesh(scene, mesh, emitter.object_id);
-      const int end = emitters_.size();
-
-      unique_mesh[mesh] = std::make_tuple(emitter.root.get(), start, end);
+    auto map_it = unique_mesh_index.find(mesh);
+    if (map_it == unique_mesh_index.end()) {
+      unique_mesh_index[mesh] = unique_meshes.size();
+      unique_meshes.push_back({mesh, emitter.object_id, emitter.root.get()});
       emitter.root->object_id = emitter.object_id;
     }
     else {
-      emitter.root->make_instance(std::get<0>(map_it->second), emitter.object_id);
+      emitter.root->make_instance(unique_meshes[map_it->second].root, emitter.object_id);
     }
     object_offsets[emitter.object_id] = offset_map_[mesh];
   }
 
-  /* Build a subtree for each unique mesh light. */
-  parallel_for_each(unique_mesh, [this](auto &map_it) {
-    LightTreeNode *node = std::get<0>(map_it.second);
-    int start = std::get<1>(map_it.second);
-    int end = std::get<2>(map_it.second);
-    recursive_build(self, node, start, end, emitters_.data(), 0, 0);
-    node->type |= LIGHT_TREE_INSTANCE;
+  if (cache) {
+    for (auto &it : cache->entries) {
+      it.second.used = false;
+    }
+    for (UniqueMesh &unique : unique_meshes) {
+      unique.cache_entry = &cache->entries[unique.mesh];
+      unique.cache_entry->used = true;
+    }
+  }
+
+  /* Find the emissive triangles of each unique mesh, unless the subtree of the mesh is unchanged
+   * since the previous build. */
+  parallel_for_each(unique_meshes, [&](UniqueMesh &unique) {
+    if (unique.cache_entry) {
+      const uint64_t key = mesh_cache_key(unique.mesh, scene->objects[unique.object_id]);
+      if (unique.cache_entry->key == key && !unique.cache_entry->nodes.empty()) {
+        unique.use_cache = true;
+        return;
+      }
+      unique.cache_entry->key = key;
+      unique.cache_entry->prim_ids.clear();
+      unique.cache_entry->nodes.clear();
+    }
+
+    const size_t mesh_num_triangles = unique.mesh->num_triangles();
+    for (size_t i = 0; i < mesh_num_triangles; i++) {
+      if (triangle_usable_as_light(unique.mesh, i)) {
+        unique.prim_ids.push_back(i);
+      }
+    }
+  });
+
+  /* Allocate the emitters of all unique meshes, and construct them in parallel. */
+  int num_mesh_emitters = 0;
+  for (UniqueMesh &unique : unique_meshes) {
+    unique.start = num_mesh_emitters;
+    num_mesh_emitters += unique.use_cache ? unique.cache_entry->prim_ids.size() :
+                                            unique.prim_ids.size();
+    unique.end = num_mesh_emitters;
+  }
+
+  emitters_.reserve(num_mesh_emitters + num_local_lights + num_distant_lights);
+  emitters_.resize(num_mesh_emitters);
+  parallel_for_each(unique_meshes, [&](UniqueMesh &unique) {
+    const vector<int> &prim_ids = unique.use_cache ? unique.cache_entry->prim_ids :
+                                                     unique.prim_ids;
+    parallel_for(blocked_range<size_t>(0, prim_ids.size(), 1024),
+                 [&](const blocked_range<size_t> &range) {
+                   for (size_t i = range.begin(); i < range.end(); i++) {
+                     emitters_[unique.start + i] = LightTreeEmitter(
+                         scene, prim_ids[i], unique.object_id);
+                   }
+                 });
+  });
+
+  /* Build a subtree for each unique mesh light, or restore it from the cache. */
+  parallel_for_each(unique_meshes, [this](UniqueMesh &unique) {
+    if (unique.use_cache) {
+      cache_restore(unique.root, *unique.cache_entry, 0, unique.start);
+    }
+    else {
+      recursive_build(self, unique.root, unique.start, unique.end, emitters_.data(), 0, 0);
+    }
   });
   task_pool.wait_work();
 
+  if (cache) {
+    if (progress_.get_cancel()) {
+      /* Subtrees might be incomplete. */
+      cache->clear();
+    }
+    else {
+      cache->num_reused = 0;
+      cache->num_built = 0;
+      for (UniqueMesh &unique : unique_meshes) {
+        if (unique.use_cache) {
+          cache->num_reused++;
+        }
+        else {
+          cache->num_built++;
+        }
+      }
+
+      /* Store newly built subtrees, with the emissive triangles in leaf order. */
+      parallel_for_each(unique_meshes, [this](UniqueMesh &unique) {
+        if (unique.use_cache) {
+          return;
+        }
+        LightTreeCache::Entry &entry = *unique.cache_entry;
+        entry.prim_ids.resize(unique.end - unique.start);
+        for (int i = unique.start; i < unique.end; i++) {
+          entry.prim_ids[i - unique.start] = emitters_[i].prim_id;
+        }
+        cache_store(unique.root, unique.start, entry);
+      });
+
+      /* Remove meshes which are no longer emissive or were removed from the scene. */
+      for (auto it = cache->entries.begin(); it != cache->entries.end();) {
+        if (it->second.used) {
+          ++it;
+        }
+        else {
+          it = cache->entries.erase(it);
+        }
+      }
+    }
+  }
+
+  for (UniqueMesh &unique : unique_meshes) {
+    unique.root->type |= LIGHT_TREE_INSTANCE;
+  }
+
   /* Update measure. */
   parallel_for_each(mesh_lights_, [&](LightTreeEmitter &emitter) {
     Object *object = scene->objects[emitter.object_id];
     Mesh *mesh = static_cast<Mesh *>(object->get_geometry());
 
-    LightTreeNode *reference = std::get<0>(unique_mesh.find(mesh)->second);
+    LightTreeNode *reference = unique_meshes[unique_mesh_index[mesh]].root;
     emitter.measure = emitter.root->measure = reference->measure;
 
     /* Transform measure. The measure is only directly transformable if the transformation has
@@ -520,9 +716,8 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
   middle = (start + end) / 2;
 
   BoundBox centroid_bbox = BoundBox::empty;
-  for (int i = start; i < end; i++) {
-    centroid_bbox.grow((emitters + i)->centroid);
-  }
+  LightTreeBucket buckets[3][LightTreeBucket::num_buckets];
+  fill_buckets(emitters, start, end, centroid_bbox, buckets);
 
   const float3 extent = centroid_bbox.size();
   const float max_extent = max4(extent.x, extent.y, extent.z, 0.0f);
@@ -538,32 +733,20 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
     }
 
     const float inv_extent = 1 / (centroid_bbox.size()[dim]);
-
-    /* Fill in buckets with emitters. */
-    std::array<LightTreeBucket, LightTreeBucket::num_buckets> buckets;
-    for (int i = start; i < end; i++) {
-      const LightTreeEmitter *emitter = emitters + i;
-
-      /* Place emitter into the appropriate bucket, where the centroid box is split into equal
-       * partitions. */
-      int bucket_idx = LightTreeBucket::num_buckets *
-                       (emitter->centroid[dim] - centroid_bbox.min[dim]) * inv_extent;
-      bucket_idx = clamp(bucket_idx, 0, LightTreeBucket::num_buckets - 1);
-
-      buckets[bucket_idx].add(*emitter);
-    }
+    const LightTreeBucket *dim_buckets = buckets[dim];
+    const LightTreeBucket &last_bucket = dim_buckets[LightTreeBucket::num_buckets - 1];
 
     /* Precompute the left bucket measure cumulatively. */
     std::array<LightTreeBucket, LightTreeBucket::num_buckets - 1> left_buckets;
-    left_buckets.front() = buckets.front();
+    left_buckets.front() = dim_buckets[0];
     for (int i = 1; i < LightTreeBucket::num_buckets - 1; i++) {
-      left_buckets[i] = left_buckets[i - 1] + buckets[i];
+      left_buckets[i] = left_buckets[i - 1] + dim_buckets[i];
     }
 
     if (dim == 0) {
       /* Calculate node measure by summing up the bucket measure. */
-      measure = left_buckets.back().measure + buckets.back().measure;
-      light_link = left_buckets.back().light_link + buckets.back().light_link;
+      measure = left_buckets.back().measure + last_bucket.measure;
+      light_link = left_buckets.back().light_link + last_bucket.light_link;
 
       /* Degenerate case with co-located emitters. */
       if (is_zero(centroid_bbox.size())) {
@@ -583,9 +766,9 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
 
     /* Precompute the right bucket measure cumulatively. */
     std::array<LightTreeBucket, LightTreeBucket::num_buckets - 1> right_buckets;
-    right_buckets.back() = buckets.back();
+    right_buckets.back() = last_bucket;
     for (int i = LightTreeBucket::num_buckets - 3; i >= 0; i--) {
-      right_buckets[i] = right_buckets[i + 1] + buckets[i + 1];
+      right_buckets[i] = right_buckets[i + 1] + dim_buckets[i + 1];
     }
 
     /* Calculate the cost of splitting at each point between partitions. */
@@ -605,6 +788,89 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
   return min_cost < total_cost || num_emitters > max_lights_in_leaf_;
 }
 
+static void fill_buckets_range(const LightTreeEmitter *emitters,
+                               const int start,
+                               const int end,
+                               const BoundBox &centroid_bbox,
+                               LightTreeBucket buckets[3][LightTreeBucket::num_buckets])
+{
+  /* Dimensions where the centroid box is flat put all emitters in the first bucket, the sum of
+   * the buckets is still needed for the node measure. */
+  const float3 extent = centroid_bbox.size();
+  float inv_extent[3];
+  for (int dim = 0; dim < 3; dim++) {
+    inv_extent[dim] = (extent[dim] == 0.0f) ? 0.0f : 1.0f / extent[dim];
+  }
+
+  for (int i = start; i < end; i++) {
+    const LightTreeEmitter &emitter = emitters[i];
+
+    /* Place emitter into the appropriate bucket, where the centroid box is split into equal
+     * partitions. */
+    for (int dim = 0; dim < 3; dim++) {
+      int bucket_idx = LightTreeBucket::num_buckets *
+                       (emitter.centroid[dim] - centroid_bbox.min[dim]) * inv_extent[dim];
+      bucket_idx = clamp(bucket_idx, 0, LightTreeBucket::num_buckets - 1);
+
+      buckets[dim][bucket_idx].add(emitter);
+    }
+  }
+}
+
+void LightTree::fill_buckets(const LightTreeEmitter *emitters,
+                             const int start,
+                             const int end,
+                             BoundBox &centroid_bbox,
+                             LightTreeBucket buckets[3][LightTreeBucket::num_buckets])
+{
+  const int num_chunks = divide_up(end - start, MIN_EMITTERS_PER_THREAD);
+
+  if (num_chunks <= 1) {
+    for (int i = start; i < end; i++) {
+      centroid_bbox.grow(emitters[i].centroid);
+    }
+    fill_buckets_range(emitters, start, end, centroid_bbox, buckets);
+    return;
+  }
+
+  /* Process chunks of emitters in parallel. Results are merged in the order of the chunks, so
+   * that the resulting tree does not depend on the scheduling of threads. */
+  struct Chunk {
+    BoundBox centroid_bbox = BoundBox::empty;
+    LightTreeBucket buckets[3][LightTreeBucket::num_buckets];
+  };
+  vector<Chunk> chunks(num_chunks);
+
+  auto chunk_range = [&](const int chunk) {
+    const int chunk_start = start + chunk * MIN_EMITTERS_PER_THREAD;
+    return std::make_pair(chunk_start, min(chunk_start + MIN_EMITTERS_PER_THREAD, end));
+  };
+
+  parallel_for(0, num_chunks, [&](const int chunk) {
+    const auto [chunk_start, chunk_end] = chunk_range(chunk);
+    for (int i = chunk_start; i < chunk_end; i++) {
+      chunks[chunk].centroid_bbox.grow(emitters[i].centroid);
+    }
+  });
+
+  for (const Chunk &chunk : chunks) {
+    centroid_bbox.grow(chunk.centroid_bbox);
+  }
+
+  parallel_for(0, num_chunks, [&](const int chunk) {
+    const auto [chunk_start, chunk_end] = chunk_range(chunk);
+    fill_buckets_range(emitters, chunk_start, chunk_end, centroid_bbox, chunks[chunk].buckets);
+  });
+
+  for (const Chunk &chunk : chunks) {
+    for (int dim = 0; dim < 3; dim++) {
+      for (int i = 0; i < LightTreeBucket::num_buckets; i++) {
+        buckets[dim][i] = buckets[dim][i] + chunk.buckets[dim][i];
+      }
+    }
+  }
+}
+
 __forceinline LightTreeMeasure operator+(const LightTreeMeasure &a, const LightTreeMeasure &b)
 {
   LightTreeMeasure c(a);
@@ -191,6 +191,8 @@ struct LightTreeEmitter {
 
   LightTreeMeasure measure;
 
+  /* Placeholder, used to allocate emitters which are then constructed in parallel. */
+  LightTreeEmitter() = default;
   LightTreeEmitter(Object *object, int object_id); /* Mesh emitter. */
   LightTreeEmitter(Scene *scene, int prim_id, int object_id, bool with_transformation = false);
 
@@ -370,6 +372,45 @@ struct LightTreeNode {
   }
 };
 
+/* Light Tree Cache
+ *
+ * Subtrees of emissive meshes are kept between light tree builds, so that unchanged meshes do not
+ * need their subtree to be rebuilt when only other lights or meshes in the scene changed. */
+class LightTreeCache {
+ public:
+  struct Node {
+    LightTreeMeasure measure;
+    LightTreeLightLink light_link;
+    uint bit_trail;
+    int type;
+    /* Leaf: index of the first emitter relative to the mesh, and the number of emitters.
+     * Inner: indices of the left and right child in the node array. */
+    int data[2];
+  };
+
+  struct Entry {
+    /* Hash of everything the subtree of the mesh depends on. */
+    uint64_t key = 0;
+    /* Emissive triangles of the mesh in leaf order. */
+    vector<int> prim_ids;
+    /* Subtree nodes, the root is the first node. */
+    vector<Node> nodes;
+    /* Used by the last build, entries which are not used are removed. */
+    bool used = false;
+  };
+
+  std::unordered_map<const Mesh *, Entry> entries;
+
+  /* Number of subtrees reused and built by the last build, for logging. */
+  int num_reused = 0;
+  int num_built = 0;
+
+  void clear()
+  {
+    entries.clear();
+  }
+};
+
 /* Light BVH
  *
  * BVH-like data structure that keeps track of lights
@@ -406,8 +447,9 @@ class LightTree {
 
   LightTree(Scene *scene, DeviceScene *dscene, Progress &progress, uint max_lights_in_leaf);
 
-  /* Returns a pointer to the root node. */
-  LightTreeNode *build(Scene *scene, DeviceScene *dscene);
+  /* Returns a pointer to the root node. When a cache is given, subtrees of unchanged emissive
+   * meshes are taken from it and the cache is updated with the newly built subtrees. */
+  LightTreeNode *build(Scene *scene, DeviceScene *dscene, LightTreeCache *cache = nullptr);
 
   /* NOTE: Always use this function to create a new node so the number of nodes is in sync. */
   unique_ptr<LightTreeNode> create_node(const LightTreeMeasure &measure, const uint &bit_trial)
@@ -448,11 +490,26 @@ class LightTree {
                     LightTreeLightLink &light_link,
                     int &split_dim);
 
+  /* Compute the bounding box of the emitter centroids and fill the buckets used to find the best
+   * split along each dimension, in parallel for large numbers of emitters. */
+  void fill_buckets(const LightTreeEmitter *emitters,
+                    const int start,
+                    const int end,
+                    BoundBox &centroid_bbox,
+                    LightTreeBucket buckets[3][LightTreeBucket::num_buckets]);
+
   /* Check whether the light tree can use this triangle as light-emissive. */
   bool triangle_usable_as_light(Mesh *mesh, int prim_id);
 
-  /* Add all the emissive triangles of a mesh to the light tree. */
-  void add_mesh(Scene *scene, Mesh *mesh, int object_id);
+  /* Key of the subtree of a mesh in the light tree cache. */
+  uint64_t mesh_cache_key(const Mesh *mesh, const Object *object);
+
+  /* Copy a subtree into the cache and back. */
+  int cache_store(const LightTreeNode *node, const int first_emitter, LightTreeCache::Entry &entry);
+  void cache_restore(LightTreeNode *node,
+                     const LightTreeCache::Entry &entry,
+                     const int index,
+                     const int first_emitter);
 };
 
 CCL_NAMESPACE_END
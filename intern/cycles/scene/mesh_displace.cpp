@@ -15,6 +15,7 @@
 #include "util/map.h"
 #include "util/progress.h"
 #include "util/set.h"
+#include "util/tbb.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -38,10 +39,9 @@ static float3 compute_face_normal(const Mesh::Triangle &t, float3 *verts)
 static int fill_shader_input(const Scene *scene,
                              const Mesh *mesh,
                              const size_t object_index,
-                             device_vector<KernelShaderEvalInput> &d_input)
+                             KernelShaderEvalInput *d_input_data)
 {
   int d_input_size = 0;
-  KernelShaderEvalInput *d_input_data = d_input.data();
 
   const array<int> &mesh_shaders = mesh->get_shader();
   const array<Node *> &mesh_used_shaders = mesh->get_used_shaders();
@@ -103,9 +103,7 @@ static int fill_shader_input(const Scene *scene,
 }
 
 /* Read back mesh displacement shader output. */
-static void read_shader_output(const Scene *scene,
-                               Mesh *mesh,
-                               const device_vector<float> &d_output)
+static void read_shader_output(const Scene *scene, Mesh *mesh, const float *d_output_data)
 {
   const array<int> &mesh_shaders = mesh->get_shader();
   const array<Node *> &mesh_used_shaders = mesh->get_used_shaders();
@@ -115,7 +113,6 @@ static void read_shader_output(const Scene *scene,
   const int num_motion_steps = mesh->get_motion_steps();
   vector<bool> done(num_verts, false);
 
-  const float *d_output_data = d_output.data();
   int d_output_index = 0;
 
   Attribute *attr_mP = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
@@ -153,44 +150,12 @@ static void read_shader_output(const Scene *scene,
   }
 }
 
-bool GeometryManager::displace(Device *device, Scene *scene, Mesh *mesh, Progress &progress)
+/* Average positions of stitched vertices, and recompute normals after displacement. */
+static void update_displaced_mesh(const Scene *scene, Mesh *mesh)
 {
-  /* verify if we have a displacement shader */
-  if (!mesh->has_true_displacement()) {
-    return false;
-  }
-
   const size_t num_verts = mesh->verts.size();
   const size_t num_triangles = mesh->num_triangles();
 
-  if (num_triangles == 0) {
-    return false;
-  }
-
-  string msg = string_printf("Computing Displacement %s", mesh->name.c_str());
-  progress.set_status("Updating Mesh", msg);
-
-  /* find object index. todo: is arbitrary */
-  size_t object_index = OBJECT_NONE;
-
-  for (size_t i = 0; i < scene->objects.size(); i++) {
-    if (scene->objects[i]->get_geometry() == mesh) {
-      object_index = i;
-      break;
-    }
-  }
-
-  /* Evaluate shader on device. */
-  ShaderEval shader_eval(device, progress);
-  if (!shader_eval.eval(SHADER_EVAL_DISPLACE,
-                        num_verts,
-                        3,
-                        function_bind(&fill_shader_input, scene, mesh, object_index, _1),
-                        function_bind(&read_shader_output, scene, mesh, _1)))
-  {
-    return false;
-  }
-
   /* stitch */
   unordered_set<int> stitch_keys;
   for (pair<int, int> i : mesh->vert_to_stitching_key_map) {
@@ -396,8 +361,140 @@ bool GeometryManager::displace(Device *device, Scene *scene, Mesh *mesh, Progres
       }
     }
   }
+}
+
+/* Evaluate the displacement shaders of a batch of meshes together, so that the device is used for
+ * one large batch instead of many small ones. */
+static bool displace_batch(const Scene *scene,
+                           const vector<Mesh *> &meshes,
+                           const unordered_map<const Geometry *, size_t> &object_index_map,
+                           const GeometryManager::DisplaceEvalFunction &eval)
+{
+  const size_t num_meshes = meshes.size();
+
+  /* Each mesh has at most one input per vertex. */
+  vector<size_t> max_input_offset(num_meshes + 1, 0);
+  for (size_t i = 0; i < num_meshes; i++) {
+    max_input_offset[i + 1] = max_input_offset[i] + meshes[i]->verts.size();
+  }
+
+  vector<size_t> input_offset(num_meshes + 1, 0);
+
+  auto fill_input = [&](device_vector<KernelShaderEvalInput> &d_input) {
+    KernelShaderEvalInput *d_input_data = d_input.data();
+    vector<int> num_inputs(num_meshes);
+
+    parallel_for(size_t(0), num_meshes, [&](const size_t i) {
+      const Mesh *mesh = meshes[i];
+      const auto it = object_index_map.find(mesh);
+      const size_t object_index = (it != object_index_map.end()) ? it->second : OBJECT_NONE;
+
+      num_inputs[i] = fill_shader_input(
+          scene, mesh, object_index, d_input_data + max_input_offset[i]);
+    });
+
+    /* Pack inputs of all meshes. */
+    for (size_t i = 0; i < num_meshes; i++) {
+      input_offset[i + 1] = input_offset[i] + num_inputs[i];
+      memmove(d_input_data + input_offset[i],
+              d_input_data + max_input_offset[i],
+              sizeof(KernelShaderEvalInput) * num_inputs[i]);
+    }
+
+    return int(input_offset[num_meshes]);
+  };
+
+  auto read_output = [&](device_vector<float> &d_output) {
+    const float *d_output_data = d_output.data();
+
+    parallel_for(size_t(0), num_meshes, [&](const size_t i) {
+      read_shader_output(scene, meshes[i], d_output_data + input_offset[i] * 3);
+    });
+  };
+
+  return eval(int(max_input_offset[num_meshes]), fill_input, read_output);
+}
+
+bool GeometryManager::displace_meshes(const Scene *scene,
+                                      const vector<Mesh *> &meshes,
+                                      const size_t max_batch_inputs,
+                                      const DisplaceEvalFunction &eval,
+                                      Progress &progress)
+{
+  /* verify if we have a displacement shader */
+  vector<Mesh *> displace_meshes;
+  foreach (Mesh *mesh, meshes) {
+    if (mesh->has_true_displacement() && mesh->num_triangles() != 0) {
+      displace_meshes.push_back(mesh);
+    }
+  }
+
+  const size_t num_meshes = displace_meshes.size();
+  if (num_meshes == 0) {
+    return false;
+  }
+
+  if (num_meshes == 1) {
+    string msg = string_printf("Computing Displacement %s", displace_meshes[0]->name.c_str());
+    progress.set_status("Updating Mesh", msg);
+  }
+  else {
+    string msg = string_printf("Computing Displacement %u meshes", (uint)num_meshes);
+    progress.set_status("Updating Mesh", msg);
+  }
+
+  /* find object index. todo: is arbitrary */
+  unordered_map<const Geometry *, size_t> object_index_map;
+  for (size_t i = 0; i < scene->objects.size(); i++) {
+    object_index_map.insert({scene->objects[i]->get_geometry(), i});
+  }
+
+  /* Split the meshes into batches of consecutive meshes, which keeps the size of the device
+   * buffers bounded. A mesh with more inputs than the maximum gets a batch of its own. */
+  vector<Mesh *> batch;
+  size_t batch_inputs = 0;
+  for (size_t i = 0; i < num_meshes; i++) {
+    batch.push_back(displace_meshes[i]);
+    batch_inputs += displace_meshes[i]->verts.size();
+
+    const bool is_last = (i + 1 == num_meshes);
+    if (is_last || batch_inputs + displace_meshes[i + 1]->verts.size() > max_batch_inputs) {
+      if (!displace_batch(scene, batch, object_index_map, eval)) {
+        return false;
+      }
+      batch.clear();
+      batch_inputs = 0;
+    }
+  }
+
+  parallel_for_each(displace_meshes.begin(), displace_meshes.end(), [&](Mesh *mesh) {
+    update_displaced_mesh(scene, mesh);
+  });
 
   return true;
 }
 
+bool GeometryManager::displace(Device *device,
+                               Scene *scene,
+                               const vector<Mesh *> &meshes,
+                               Progress &progress)
+{
+  /* Limit the number of inputs per batch, the shader evaluation indexes its inputs and outputs
+   * with int, and buffers for all inputs and outputs of a batch are allocated at once. */
+  const size_t max_batch_inputs = 16 * 1024 * 1024;
+
+  ShaderEval shader_eval(device, progress);
+  return displace_meshes(
+      scene,
+      meshes,
+      max_batch_inputs,
+      [&](const int max_num_inputs,
+          const function<int(device_vector<KernelShaderEvalInput> &)> &fill_input,
+          const function<void(device_vector<float> &)> &read_output) {
+        return shader_eval.eval(
+            SHADER_EVAL_DISPLACE, max_num_inputs, 3, fill_input, read_output);
+      },
+      progress);
+}
+
 CCL_NAMESPACE_END
@@ -460,6 +460,7 @@ void Scene::collect_statistics(RenderStats *stats)
 {
   geometry_manager->collect_statistics(this, stats);
   image_manager->collect_statistics(stats);
+  stats->paged_memory = util_paged_memory_usage();
 }
 
 void Scene::enable_update_stats()
@@ -66,12 +66,17 @@ class SceneParams {
   BVHType bvh_type;
   bool use_bvh_spatial_split;
   bool use_bvh_compact_structure;
+  /* Group static curve segments into BVH2 leaves of multiple segments. */
+  bool use_bvh_compact_curves;
   bool use_bvh_unaligned_nodes;
   int num_bvh_time_steps;
   int hair_subdivisions;
   CurveShapeType hair_shape;
   int texture_limit;
 
+  /* Store corner float2 attributes of meshes, like UV maps, in half precision on the device. */
+  bool use_half_precision_attributes;
+
   bool background;
 
   SceneParams()
@@ -81,11 +86,13 @@ class SceneParams {
     bvh_type = BVH_TYPE_DYNAMIC;
     use_bvh_spatial_split = false;
     use_bvh_compact_structure = true;
+    use_bvh_compact_curves = false;
     use_bvh_unaligned_nodes = true;
     num_bvh_time_steps = 0;
     hair_subdivisions = 3;
     hair_shape = CURVE_RIBBON;
     texture_limit = 0;
+    use_half_precision_attributes = false;
     background = true;
   }
 
@@ -95,10 +102,12 @@ class SceneParams {
              bvh_type == params.bvh_type &&
              use_bvh_spatial_split == params.use_bvh_spatial_split &&
              use_bvh_compact_structure == params.use_bvh_compact_structure &&
+             use_bvh_compact_curves == params.use_bvh_compact_curves &&
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             texture_limit == params.texture_limit);
+             texture_limit == params.texture_limit &&
+             use_half_precision_attributes == params.use_half_precision_attributes);
   }
 
   int curve_subdivisions()
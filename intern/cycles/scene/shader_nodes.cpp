@@ -6438,16 +6438,7 @@ void MathNode::compile(SVMCompiler &compiler)
   ShaderInput *value3_in = input("Value3");
   ShaderOutput *value_out = output("Value");
 
-  int value1_stack_offset = compiler.stack_assign(value1_in);
-  int value2_stack_offset = compiler.stack_assign(value2_in);
-  int value3_stack_offset = compiler.stack_assign(value3_in);
-  int value_stack_offset = compiler.stack_assign(value_out);
-
-  compiler.add_node(
-      NODE_MATH,
-      math_type,
-      compiler.encode_uchar4(value1_stack_offset, value2_stack_offset, value3_stack_offset),
-      value_stack_offset);
+  compiler.add_math_node(math_type, value1_in, value2_in, value3_in, value_out);
 }
 
 void MathNode::compile(OSLCompiler &compiler)
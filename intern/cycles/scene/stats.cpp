@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: Apache-2.0 */
 
 #include "scene/stats.h"
+#include "scene/image.h"
 #include "scene/object.h"
 #include "util/algorithm.h"
 #include "util/foreach.h"
@@ -39,6 +40,46 @@ bool namedSampleCountPairComparator(const NamedSampleCountPair &a, const NamedSa
   return a.samples > b.samples;
 }
 
+/* Quoted and escaped JSON string. */
+string json_string(const string &str)
+{
+  string result = "\"";
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      default:
+        if ((unsigned char)c < 0x20) {
+          result += string_printf("\\u%04x", (unsigned int)c);
+        }
+        else {
+          result += c;
+        }
+        break;
+    }
+  }
+  return result + "\"";
+}
+
+/* Field with the average number of tests per ray, left out when tests were not counted. */
+string json_per_ray_field(const string &indent, const char *name, uint64_t tests, uint64_t rays)
+{
+  if (tests == 0 || rays == 0) {
+    return "";
+  }
+  return indent + string_printf("\"%s\": %.2f,\n", name, ((double)tests) / rays);
+}
+
 }  // namespace
 
 NamedSizeEntry::NamedSizeEntry() : name(""), size(0) {}
@@ -95,10 +136,18 @@ string NamedTimeStats::full_report(int indent_level)
 
 /* Named time sample statistics. */
 
-NamedNestedSampleStats::NamedNestedSampleStats() : name(""), self_samples(0), sum_samples(0) {}
+NamedNestedSampleStats::NamedNestedSampleStats()
+    : name(""), self_samples(0), sum_samples(0), rays(0), bvh_nodes(0), bvh_prims(0)
+{
+}
 
 NamedNestedSampleStats::NamedNestedSampleStats(const string &name, uint64_t samples)
-    : name(name), self_samples(samples), sum_samples(samples)
+    : name(name),
+      self_samples(samples),
+      sum_samples(samples),
+      rays(0),
+      bvh_nodes(0),
+      bvh_prims(0)
 {
 }
 
@@ -146,6 +195,34 @@ string NamedNestedSampleStats::full_report(int indent_level, uint64_t total_samp
   return result;
 }
 
+string NamedNestedSampleStats::json_report(int indent_level)
+{
+  update_sum();
+
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const string inner_indent = indent + string(kIndentNumSpaces, ' ');
+
+  string result = indent + "{\n";
+  result += inner_indent + "\"name\": " + json_string(name) + ",\n";
+  result += inner_indent + string_printf("\"time\": %.3f,\n", sum_samples * 0.001);
+  result += inner_indent + string_printf("\"self_time\": %.3f,\n", self_samples * 0.001);
+  result += inner_indent + string_printf("\"rays\": %llu,\n", (unsigned long long)rays);
+  result += json_per_ray_field(inner_indent, "bvh_node_tests_per_ray", bvh_nodes, rays);
+  result += json_per_ray_field(inner_indent, "bvh_primitive_tests_per_ray", bvh_prims, rays);
+  result += inner_indent + "\"stages\": [";
+
+  sort(entries.begin(), entries.end(), namedTimeSampleEntryComparator);
+  for (size_t i = 0; i < entries.size(); i++) {
+    result += (i == 0) ? "\n" : ",\n";
+    result += entries[i].json_report(indent_level + 2);
+  }
+  if (!entries.empty()) {
+    result += "\n" + inner_indent;
+  }
+  result += "]\n" + indent + "}";
+  return result;
+}
+
 /* Named sample count pairs. */
 
 NamedSampleCountPair::NamedSampleCountPair(const ustring &name, uint64_t samples, uint64_t hits)
@@ -198,6 +275,32 @@ string NamedSampleCountStats::full_report(int indent_level)
   return result;
 }
 
+string NamedSampleCountStats::json_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+
+  vector<NamedSampleCountPair> sorted_entries;
+  sorted_entries.reserve(entries.size());
+  foreach (entry_map::const_reference entry, entries) {
+    sorted_entries.push_back(entry.second);
+  }
+  sort(sorted_entries.begin(), sorted_entries.end(), namedSampleCountPairComparator);
+
+  string result = "[";
+  for (size_t i = 0; i < sorted_entries.size(); i++) {
+    const NamedSampleCountPair &entry = sorted_entries[i];
+    result += (i == 0) ? "\n" : ",\n";
+    result += indent + string_printf("  {\"name\": %s, \"time\": %.3f, \"hits\": %llu}",
+                                     json_string(entry.name.string()).c_str(),
+                                     entry.samples * 0.001,
+                                     (unsigned long long)entry.hits);
+  }
+  if (!sorted_entries.empty()) {
+    result += "\n" + indent;
+  }
+  return result + "]";
+}
+
 /* Mesh statistics. */
 
 MeshStats::MeshStats() {}
@@ -233,43 +336,53 @@ void RenderStats::collect_profiling(Scene *scene, Profiler &prof)
 {
   has_profiling = true;
 
+  /* Add an entry for an event, with the rays traced in it. */
+  auto add_event = [&prof](NamedNestedSampleStats &parent,
+                           const string &name,
+                           const ProfilingEvent event) {
+    NamedNestedSampleStats &entry = parent.add_entry(name, prof.get_event(event));
+    prof.get_rays(event, entry.rays, entry.bvh_nodes, entry.bvh_prims);
+  };
+
   kernel = NamedNestedSampleStats("Total render time", prof.get_event(PROFILING_UNKNOWN));
-  kernel.add_entry("Ray setup", prof.get_event(PROFILING_RAY_SETUP));
-  kernel.add_entry("Intersect Closest", prof.get_event(PROFILING_INTERSECT_CLOSEST));
-  kernel.add_entry("Intersect Shadow", prof.get_event(PROFILING_INTERSECT_SHADOW));
-  kernel.add_entry("Intersect Subsurface", prof.get_event(PROFILING_INTERSECT_SUBSURFACE));
-  kernel.add_entry("Intersect Volume Stack", prof.get_event(PROFILING_INTERSECT_VOLUME_STACK));
-  kernel.add_entry("Intersect Blocked Light", prof.get_event(PROFILING_INTERSECT_DEDICATED_LIGHT));
+  add_event(kernel, "Ray setup", PROFILING_RAY_SETUP);
+  add_event(kernel, "Intersect Closest", PROFILING_INTERSECT_CLOSEST);
+  add_event(kernel, "Intersect Shadow", PROFILING_INTERSECT_SHADOW);
+  add_event(kernel, "Intersect Subsurface", PROFILING_INTERSECT_SUBSURFACE);
+  add_event(kernel, "Intersect Volume Stack", PROFILING_INTERSECT_VOLUME_STACK);
+  add_event(kernel, "Intersect Blocked Light", PROFILING_INTERSECT_DEDICATED_LIGHT);
 
   NamedNestedSampleStats &surface = kernel.add_entry("Shade Surface", 0);
-  surface.add_entry("Setup", prof.get_event(PROFILING_SHADE_SURFACE_SETUP));
-  surface.add_entry("Shader Evaluation", prof.get_event(PROFILING_SHADE_SURFACE_EVAL));
-  surface.add_entry("Render Passes", prof.get_event(PROFILING_SHADE_SURFACE_PASSES));
-  surface.add_entry("Direct Light", prof.get_event(PROFILING_SHADE_SURFACE_DIRECT_LIGHT));
-  surface.add_entry("Indirect Light", prof.get_event(PROFILING_SHADE_SURFACE_INDIRECT_LIGHT));
-  surface.add_entry("Ambient Occlusion", prof.get_event(PROFILING_SHADE_SURFACE_AO));
+  add_event(surface, "Setup", PROFILING_SHADE_SURFACE_SETUP);
+  add_event(surface, "Shader Evaluation", PROFILING_SHADE_SURFACE_EVAL);
+  add_event(surface, "Render Passes", PROFILING_SHADE_SURFACE_PASSES);
+  add_event(surface, "Direct Light", PROFILING_SHADE_SURFACE_DIRECT_LIGHT);
+  add_event(surface, "Indirect Light", PROFILING_SHADE_SURFACE_INDIRECT_LIGHT);
+  add_event(surface, "Ambient Occlusion", PROFILING_SHADE_SURFACE_AO);
 
   NamedNestedSampleStats &volume = kernel.add_entry("Shade Volume", 0);
-  volume.add_entry("Setup", prof.get_event(PROFILING_SHADE_VOLUME_SETUP));
-  volume.add_entry("Integrate", prof.get_event(PROFILING_SHADE_VOLUME_INTEGRATE));
-  volume.add_entry("Direct Light", prof.get_event(PROFILING_SHADE_VOLUME_DIRECT_LIGHT));
-  volume.add_entry("Indirect Light", prof.get_event(PROFILING_SHADE_VOLUME_INDIRECT_LIGHT));
+  add_event(volume, "Setup", PROFILING_SHADE_VOLUME_SETUP);
+  add_event(volume, "Integrate", PROFILING_SHADE_VOLUME_INTEGRATE);
+  add_event(volume, "Direct Light", PROFILING_SHADE_VOLUME_DIRECT_LIGHT);
+  add_event(volume, "Indirect Light", PROFILING_SHADE_VOLUME_INDIRECT_LIGHT);
 
   NamedNestedSampleStats &shadow = kernel.add_entry("Shade Shadow", 0);
-  shadow.add_entry("Setup", prof.get_event(PROFILING_SHADE_SHADOW_SETUP));
-  shadow.add_entry("Surface", prof.get_event(PROFILING_SHADE_SHADOW_SURFACE));
-  shadow.add_entry("Volume", prof.get_event(PROFILING_SHADE_SHADOW_VOLUME));
-  shadow.add_entry("Blocked Light", prof.get_event(PROFILING_SHADE_DEDICATED_LIGHT));
+  add_event(shadow, "Setup", PROFILING_SHADE_SHADOW_SETUP);
+  add_event(shadow, "Surface", PROFILING_SHADE_SHADOW_SURFACE);
+  add_event(shadow, "Volume", PROFILING_SHADE_SHADOW_VOLUME);
+  add_event(shadow, "Blocked Light", PROFILING_SHADE_DEDICATED_LIGHT);
 
   NamedNestedSampleStats &light = kernel.add_entry("Shade Light", 0);
-  light.add_entry("Setup", prof.get_event(PROFILING_SHADE_LIGHT_SETUP));
-  light.add_entry("Shader Evaluation", prof.get_event(PROFILING_SHADE_LIGHT_EVAL));
+  add_event(light, "Setup", PROFILING_SHADE_LIGHT_SETUP);
+  add_event(light, "Shader Evaluation", PROFILING_SHADE_LIGHT_EVAL);
 
   shaders.entries.clear();
+  shader_evals.entries.clear();
   foreach (Shader *shader, scene->shaders) {
     uint64_t samples, hits;
     if (prof.get_shader(shader->id, samples, hits)) {
       shaders.add(shader->name, samples, hits);
+      shader_evals.add(shader->name, prof.get_shader_eval(shader->id), hits);
     }
   }
 
@@ -280,6 +393,9 @@ void RenderStats::collect_profiling(Scene *scene, Profiler &prof)
       objects.add(object->name, samples, hits);
     }
   }
+
+  texture_lookups = NamedSizeStats();
+  scene->image_manager->collect_profiling(this, prof);
 }
 
 string RenderStats::full_report()
@@ -287,6 +403,25 @@ string RenderStats::full_report()
   string result = "";
   result += "Mesh statistics:\n" + mesh.full_report(1);
   result += "Image statistics:\n" + image.full_report(1);
+  if (!sync.entries.empty()) {
+    result += "Synchronization statistics:\n" + sync.full_report(1);
+  }
+  if (paged_memory.num_allocations) {
+    const string indent(kIndentNumSpaces, ' ');
+    result += "Out-of-core statistics:\n";
+    result += string_printf("%sArrays: %zu\n", indent.c_str(), paged_memory.num_allocations);
+    result += string_printf(
+        "%sSize: %s\n", indent.c_str(), string_human_readable_size(paged_memory.size).c_str());
+    result += string_printf("%sResident: %s\n",
+                            indent.c_str(),
+                            string_human_readable_size(paged_memory.resident_size).c_str());
+    result += string_printf("%sPage faults served from memory: %llu\n",
+                            indent.c_str(),
+                            (unsigned long long)paged_memory.minor_page_faults);
+    result += string_printf("%sPage faults read from disk: %llu\n",
+                            indent.c_str(),
+                            (unsigned long long)paged_memory.major_page_faults);
+  }
   if (has_profiling) {
     result += "Kernel statistics:\n" + kernel.full_report(1);
     result += "Shader statistics:\n" + shaders.full_report(1);
@@ -298,6 +433,55 @@ string RenderStats::full_report()
   return result;
 }
 
+string RenderStats::json_report()
+{
+  if (!has_profiling) {
+    return "{\n  \"has_profiling\": false\n}\n";
+  }
+
+  string result = "{\n";
+  result += "  \"has_profiling\": true,\n";
+  result += "  \"kernel\":\n" + kernel.json_report(1) + ",\n";
+
+  /* Shaders with both their total time and the time spent evaluating their nodes. */
+  vector<NamedSampleCountPair> sorted_shaders;
+  foreach (NamedSampleCountStats::entry_map::const_reference entry, shaders.entries) {
+    sorted_shaders.push_back(entry.second);
+  }
+  sort(sorted_shaders.begin(), sorted_shaders.end(), namedSampleCountPairComparator);
+
+  result += "  \"shaders\": [";
+  for (size_t i = 0; i < sorted_shaders.size(); i++) {
+    const NamedSampleCountPair &shader = sorted_shaders[i];
+    NamedSampleCountStats::entry_map::const_iterator eval = shader_evals.entries.find(shader.name);
+    const uint64_t eval_samples = (eval != shader_evals.entries.end()) ? eval->second.samples : 0;
+
+    result += (i == 0) ? "\n" : ",\n";
+    result += string_printf(
+        "    {\"name\": %s, \"time\": %.3f, \"eval_time\": %.3f, \"hits\": %llu}",
+        json_string(shader.name.string()).c_str(),
+        shader.samples * 0.001,
+        eval_samples * 0.001,
+        (unsigned long long)shader.hits);
+  }
+  result += sorted_shaders.empty() ? "],\n" : "\n  ],\n";
+
+  result += "  \"objects\": " + objects.json_report(1) + ",\n";
+
+  sort(texture_lookups.entries.begin(), texture_lookups.entries.end(), namedSizeEntryComparator);
+  result += "  \"textures\": [";
+  for (size_t i = 0; i < texture_lookups.entries.size(); i++) {
+    const NamedSizeEntry &texture = texture_lookups.entries[i];
+    result += (i == 0) ? "\n" : ",\n";
+    result += string_printf("    {\"name\": %s, \"lookups\": %llu}",
+                            json_string(texture.name).c_str(),
+                            (unsigned long long)texture.size);
+  }
+  result += texture_lookups.entries.empty() ? "]\n" : "\n  ]\n";
+
+  return result + "}\n";
+}
+
 NamedTimeStats::NamedTimeStats() : total_time(0.0) {}
 
 string UpdateTimeStats::full_report(int indent_level)
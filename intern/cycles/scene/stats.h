@@ -7,6 +7,7 @@
 
 #include "scene/scene.h"
 
+#include "util/paged_malloc.h"
 #include "util/stats.h"
 #include "util/string.h"
 #include "util/vector.h"
@@ -101,6 +102,7 @@ class NamedNestedSampleStats {
   void update_sum();
 
   string full_report(int indent_level = 0, uint64_t total_samples = 0);
+  string json_report(int indent_level = 0);
 
   string name;
 
@@ -108,6 +110,10 @@ class NamedNestedSampleStats {
    * while sum_samples also includes the samples of all sub-entries. */
   uint64_t self_samples, sum_samples;
 
+  /* Number of rays traced in this specific event, and the BVH nodes and primitives tested for
+   * them. BVH tests are zero when they are not counted, as with Embree. */
+  uint64_t rays, bvh_nodes, bvh_prims;
+
   vector<NamedNestedSampleStats> entries;
 };
 
@@ -129,6 +135,7 @@ class NamedSampleCountStats {
   NamedSampleCountStats();
 
   string full_report(int indent_level = 0);
+  string json_report(int indent_level = 0);
   void add(const ustring &name, uint64_t samples, uint64_t hits);
 
   typedef unordered_map<ustring, NamedSampleCountPair, ustringHash> entry_map;
@@ -169,6 +176,9 @@ class RenderStats {
   /* Return full report as string. */
   string full_report();
 
+  /* Return profiling statistics as a JSON document. */
+  string json_report();
+
   /* Collect kernel sampling information from Stats. */
   void collect_profiling(Scene *scene, Profiler &prof);
 
@@ -179,6 +189,17 @@ class RenderStats {
   NamedNestedSampleStats kernel;
   NamedSampleCountStats shaders;
   NamedSampleCountStats objects;
+  /* Samples spent in the evaluation of each shader, with the number of times it was hit. */
+  NamedSampleCountStats shader_evals;
+  /* Number of lookups of each image texture, as the entry size. */
+  NamedSizeStats texture_lookups;
+
+  /* Time spent synchronizing the scene from the host application, filled in by the host
+   * integration as it is not known to the scene itself. */
+  NamedTimeStats sync;
+
+  /* Scene data stored out of core in memory-mapped files. */
+  PagedMemoryUsage paged_memory;
 };
 
 class UpdateTimeStats {
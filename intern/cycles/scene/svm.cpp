@@ -165,6 +165,10 @@ SVMCompiler::SVMCompiler(Scene *scene) : scene(scene)
   mix_weight_offset = SVM_STACK_INVALID;
   bump_state_offset = SVM_STACK_INVALID;
   compile_failed = false;
+  math_chain_output = NULL;
+  math_chain_offset = 0;
+  math_chain_end = 0;
+  num_math_nodes_saved = 0;
 
   /* This struct has one entry for every node, in order of ShaderNodeType definition. */
   svm_node_types_used = (std::atomic_int *)&scene->dscene.data.svm_usage;
@@ -409,6 +413,100 @@ void SVMCompiler::add_node(const float4 &f)
       __float_as_int(f.x), __float_as_int(f.y), __float_as_int(f.z), __float_as_int(f.w)));
 }
 
+void SVMCompiler::add_math_node(NodeMathType type,
+                                ShaderInput *value1_in,
+                                ShaderInput *value2_in,
+                                ShaderInput *value3_in,
+                                ShaderOutput *value_out)
+{
+  ShaderInput *inputs[3] = {value1_in, value2_in, value3_in};
+  const int start_num_svm_nodes = current_svm_nodes.size();
+
+  /* Without fusion, every unlinked input is loaded onto the stack with its own SVM node. */
+  int num_unoptimized_nodes = 1;
+  for (int i = 0; i < 3; i++) {
+    if (!inputs[i]->link) {
+      num_unoptimized_nodes++;
+    }
+  }
+
+  /* Continue the chain of the previous math node if this node is the only user of its result,
+   * in which case the intermediate result never needs to be stored on the stack. */
+  int chain_input = SVM_MATH_CHAIN_INPUT_NONE;
+  if (math_chain_output && math_chain_output->links.size() == 1 &&
+      math_chain_end == start_num_svm_nodes)
+  {
+    for (int i = 0; i < 3; i++) {
+      if (inputs[i]->link == math_chain_output) {
+        chain_input = i;
+        break;
+      }
+    }
+  }
+
+  if (chain_input == SVM_MATH_CHAIN_INPUT_NONE) {
+    if (num_unoptimized_nodes == 1) {
+      /* All inputs are linked, a regular math node is just as compact. */
+      const int value1_stack_offset = stack_assign(value1_in);
+      const int value2_stack_offset = stack_assign(value2_in);
+      const int value3_stack_offset = stack_assign(value3_in);
+      math_chain_offset = current_svm_nodes.size();
+      add_node(NODE_MATH,
+               type,
+               encode_uchar4(value1_stack_offset, value2_stack_offset, value3_stack_offset),
+               stack_assign(value_out));
+      math_chain_output = value_out;
+      math_chain_end = current_svm_nodes.size();
+      return;
+    }
+
+    /* Start a new chain, with constant inputs stored in the node itself. */
+    math_chain_offset = current_svm_nodes.size();
+    add_node(NODE_MATH_CHAIN, 0, 0, 0);
+  }
+  else if (current_svm_nodes[math_chain_offset].x == NODE_MATH) {
+    /* Turn the previous math node into the first operation of a chain. */
+    const int4 math_node = current_svm_nodes[math_chain_offset];
+    current_svm_nodes[math_chain_offset] = make_int4(NODE_MATH_CHAIN, 1, math_node.w, 0);
+    svm_node_types_used[NODE_MATH_CHAIN] = true;
+    add_node(math_node.y | (SVM_MATH_CHAIN_INPUT_NONE << SVM_MATH_CHAIN_INPUT_SHIFT),
+             math_node.z & 0xff,
+             (math_node.z >> 8) & 0xff,
+             (math_node.z >> 16) & 0xff);
+  }
+
+  /* Operands are either the result of the previous operation, constants or stack offsets. */
+  int operands[3] = {0, 0, 0};
+  uint constant_mask = 0;
+  for (int i = 0; i < 3; i++) {
+    if (i == chain_input) {
+      continue;
+    }
+    if (inputs[i]->link) {
+      operands[i] = stack_assign(inputs[i]);
+    }
+    else {
+      operands[i] = __float_as_int(inputs[i]->parent->get_float(inputs[i]->socket_type));
+      constant_mask |= (1 << i);
+    }
+  }
+
+  add_node(type | (chain_input << SVM_MATH_CHAIN_INPUT_SHIFT) |
+               (constant_mask << SVM_MATH_CHAIN_CONSTANT_SHIFT),
+           operands[0],
+           operands[1],
+           operands[2]);
+
+  int4 &chain_node = current_svm_nodes[math_chain_offset];
+  chain_node.y++;
+  chain_node.z = stack_assign(value_out);
+  math_chain_output = value_out;
+  math_chain_end = current_svm_nodes.size();
+
+  num_math_nodes_saved += num_unoptimized_nodes -
+                          (current_svm_nodes.size() - start_num_svm_nodes);
+}
+
 uint SVMCompiler::attribute(ustring name)
 {
   return scene->shader_manager->get_attribute_id(name);
@@ -694,6 +792,7 @@ void SVMCompiler::generate_multi_closure(ShaderNode *root_node,
         /* Fill in jump instruction location to be after closure. */
         current_svm_nodes[node_jump_skip_index].y = current_svm_nodes.size() -
                                                     node_jump_skip_index - 1;
+        math_chain_output = NULL;
       }
 
       /* generate instructions for input closure 2 */
@@ -710,6 +809,7 @@ void SVMCompiler::generate_multi_closure(ShaderNode *root_node,
         /* Fill in jump instruction location to be after closure. */
         current_svm_nodes[node_jump_skip_index].y = current_svm_nodes.size() -
                                                     node_jump_skip_index - 1;
+        math_chain_output = NULL;
       }
 
       /* unassign */
@@ -781,6 +881,7 @@ void SVMCompiler::compile_type(Shader *shader, ShaderGraph *graph, ShaderType ty
   /* clear all compiler state */
   memset((void *)&active_stack, 0, sizeof(active_stack));
   current_svm_nodes.clear();
+  math_chain_output = NULL;
 
   foreach (ShaderNode *node, graph->nodes) {
     foreach (ShaderInput *input, node->inputs)
@@ -942,6 +1043,7 @@ void SVMCompiler::compile(Shader *shader, array<int4> &svm_nodes, int index, Sum
     summary->time_total = time_dt() - time_start;
     summary->peak_stack_usage = max_stack_use;
     summary->num_svm_nodes = svm_nodes.size() - start_num_svm_nodes;
+    summary->num_svm_nodes_unoptimized = summary->num_svm_nodes + num_math_nodes_saved;
   }
 
   /* Estimate emission for MIS. */
@@ -952,6 +1054,7 @@ void SVMCompiler::compile(Shader *shader, array<int4> &svm_nodes, int index, Sum
 
 SVMCompiler::Summary::Summary()
     : num_svm_nodes(0),
+      num_svm_nodes_unoptimized(0),
       peak_stack_usage(0),
       time_finalize(0.0),
       time_generate_surface(0.0),
@@ -966,6 +1069,7 @@ string SVMCompiler::Summary::full_report() const
 {
   string report = "";
   report += string_printf("Number of SVM nodes: %d\n", num_svm_nodes);
+  report += string_printf("  Without fusion:    %d\n", num_svm_nodes_unoptimized);
   report += string_printf("Peak stack usage:    %d\n", peak_stack_usage);
 
   report += string_printf("Time (in seconds):\n");
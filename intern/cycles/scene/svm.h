@@ -57,6 +57,9 @@ class SVMCompiler {
     /* Number of SVM nodes shader was compiled into. */
     int num_svm_nodes;
 
+    /* Number of SVM nodes shader would have been compiled into without fusing math nodes. */
+    int num_svm_nodes_unoptimized;
+
     /* Peak stack usage during shader evaluation. */
     int peak_stack_usage;
 
@@ -99,6 +102,11 @@ class SVMCompiler {
   void add_node(int a = 0, int b = 0, int c = 0, int d = 0);
   void add_node(ShaderNodeType type, const float3 &f);
   void add_node(const float4 &f);
+  void add_math_node(NodeMathType type,
+                     ShaderInput *value1_in,
+                     ShaderInput *value2_in,
+                     ShaderInput *value3_in,
+                     ShaderOutput *value_out);
   uint attribute(ustring name);
   uint attribute(AttributeStandard std);
   uint attribute_standard(ustring name);
@@ -229,6 +237,14 @@ class SVMCompiler {
   uint mix_weight_offset;
   uint bump_state_offset;
   bool compile_failed;
+
+  /* Output of the last math node, when its SVM nodes are the last ones generated. Math nodes
+   * using it as their only input are appended to the same NODE_MATH_CHAIN. */
+  ShaderOutput *math_chain_output;
+  int math_chain_offset;
+  int math_chain_end;
+  /* Number of SVM nodes saved by fusing math nodes. */
+  int num_math_nodes_saved;
 };
 
 CCL_NAMESPACE_END
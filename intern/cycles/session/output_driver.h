@@ -51,6 +51,14 @@ class OutputDriver {
   /* Write tile once it has finished rendering. */
   virtual void write_render_tile(const Tile &tile) = 0;
 
+  /* Return true if the full frame of a tiled render can be written in parts. The full frame is
+   * then passed to write_render_tile() as a sequence of bands of rows, ordered from the top of
+   * the image to the bottom, so that it never needs to be in memory at once. */
+  virtual bool supports_partial_write()
+  {
+    return false;
+  }
+
   /* Update tile while rendering is in progress. Return true if any update
    * was performed. */
   virtual bool update_render_tile(const Tile & /* tile */)
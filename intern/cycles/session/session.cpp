@@ -12,6 +12,7 @@
 #include "scene/background.h"
 #include "scene/bake.h"
 #include "scene/camera.h"
+#include "scene/image.h"
 #include "scene/integrator.h"
 #include "scene/light.h"
 #include "scene/mesh.h"
@@ -416,7 +417,8 @@ RenderWork Session::run_update_for_next_iteration()
     }
 
     if (update_scene(width, height)) {
-      profiler.reset(scene->shaders.size(), scene->objects.size());
+      profiler.reset(
+          scene->shaders.size(), scene->objects.size(), scene->image_manager->num_slots());
     }
 
     /* Unlock scene mutex before loading denoiser kernels, since that may attempt to activate
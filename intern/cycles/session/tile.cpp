@@ -630,6 +630,26 @@ bool TileManager::read_full_buffer_from_disk(const string_view filename,
                                              RenderBuffers *buffers,
                                              DenoiseParams *denoise_params)
 {
+  BufferParams buffer_params;
+  if (!open_full_buffer_from_disk(filename, &buffer_params, denoise_params)) {
+    return false;
+  }
+
+  buffers->reset(buffer_params);
+
+  const bool success = read_full_buffer_rows_from_disk(0, buffers);
+
+  close_full_buffer_from_disk();
+
+  return success;
+}
+
+bool TileManager::open_full_buffer_from_disk(const string_view filename,
+                                             BufferParams *buffer_params,
+                                             DenoiseParams *denoise_params)
+{
+  close_full_buffer_from_disk();
+
   unique_ptr<ImageInput> in(ImageInput::open(filename));
   if (!in) {
     LOG(ERROR) << "Error opening tile file " << filename;
@@ -638,28 +658,60 @@ bool TileManager::read_full_buffer_from_disk(const string_view filename,
 
   const ImageSpec &image_spec = in->spec();
 
-  BufferParams buffer_params;
-  if (!buffer_params_from_image_spec_atttributes(&buffer_params, image_spec)) {
+  if (!buffer_params_from_image_spec_atttributes(buffer_params, image_spec)) {
     return false;
   }
-  buffers->reset(buffer_params);
 
   if (!node_from_image_spec_atttributes(denoise_params, image_spec, ATTR_DENOISE_SOCKET_PREFIX)) {
     return false;
   }
 
-  const int num_channels = in->spec().nchannels;
-  if (!in->read_image(0, 0, 0, num_channels, TypeDesc::FLOAT, buffers->buffer.data())) {
-    LOG(ERROR) << "Error reading pixels from the tile file " << in->geterror();
+  read_state_.tile_in = std::move(in);
+
+  return true;
+}
+
+bool TileManager::read_full_buffer_rows_from_disk(const int y, RenderBuffers *buffers)
+{
+  if (!read_state_.tile_in) {
     return false;
   }
 
-  if (!in->close()) {
-    LOG(ERROR) << "Error closing tile file " << in->geterror();
+  ImageInput *in = read_state_.tile_in.get();
+  const ImageSpec &image_spec = in->spec();
+
+  DCHECK_EQ(buffers->params.width, image_spec.width);
+  DCHECK_LE(y + buffers->params.height, image_spec.height);
+
+  const int num_channels = image_spec.nchannels;
+  if (!in->read_scanlines(0,
+                          0,
+                          y,
+                          y + buffers->params.height,
+                          0,
+                          0,
+                          num_channels,
+                          TypeDesc::FLOAT,
+                          buffers->buffer.data()))
+  {
+    LOG(ERROR) << "Error reading pixels from the tile file " << in->geterror();
     return false;
   }
 
   return true;
 }
 
+void TileManager::close_full_buffer_from_disk()
+{
+  if (!read_state_.tile_in) {
+    return;
+  }
+
+  if (!read_state_.tile_in->close()) {
+    LOG(ERROR) << "Error closing tile file " << read_state_.tile_in->geterror();
+  }
+
+  read_state_.tile_in = nullptr;
+}
+
 CCL_NAMESPACE_END
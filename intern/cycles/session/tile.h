@@ -74,6 +74,11 @@ class TileManager {
     return overscan_;
   }
 
+  inline int2 get_tile_size() const
+  {
+    return tile_size_;
+  }
+
   bool next();
   bool done();
 
@@ -104,6 +109,24 @@ class TileManager {
                                   RenderBuffers *buffers,
                                   DenoiseParams *denoise_params);
 
+  /* Open tiles file on disk for reading the full frame render buffer in parts, so that the full
+   * frame never needs to be in memory at once. Parameters of the full frame buffer and denoiser
+   * are read from the file.
+   *
+   * Returns true on success. */
+  bool open_full_buffer_from_disk(string_view filename,
+                                  BufferParams *buffer_params,
+                                  DenoiseParams *denoise_params);
+
+  /* Read rows [y, y + buffers.params.height) of the full frame render buffer from the file opened
+   * with open_full_buffer_from_disk(). The buffers are expected to be allocated for the full
+   * width of the frame.
+   *
+   * Returns true on success. */
+  bool read_full_buffer_rows_from_disk(const int y, RenderBuffers *buffers);
+
+  void close_full_buffer_from_disk();
+
   /* Compute valid tile size compatible with image saving. */
   int compute_render_tile_size(const int suggested_tile_size) const;
 
@@ -173,6 +196,11 @@ class TileManager {
 
     int num_tiles_written = 0;
   } write_state_;
+
+  /* State of reading the full frame buffer from a file on disk. */
+  struct {
+    unique_ptr<ImageInput> tile_in;
+  } read_state_;
 };
 
 CCL_NAMESPACE_END
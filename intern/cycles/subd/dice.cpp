@@ -8,6 +8,8 @@
 #include "subd/dice.h"
 #include "subd/patch.h"
 
+#include "util/tbb.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* EdgeDice Base */
@@ -33,8 +35,14 @@ void EdgeDice::reserve(int num_verts, int num_triangles)
   vert_offset = mesh->get_verts().size();
   tri_offset = mesh->num_triangles();
 
-  mesh->resize_mesh(mesh->get_verts().size() + num_verts, mesh->num_triangles());
-  mesh->reserve_mesh(mesh->get_verts().size() + num_verts, mesh->num_triangles() + num_triangles);
+  /* Resize rather than reserve, so that subpatches can write their vertices and triangles from
+   * multiple threads. */
+  mesh->resize_mesh(vert_offset + num_verts, tri_offset + num_triangles);
+
+  mesh->tag_triangles_modified();
+  mesh->tag_shader_modified();
+  mesh->tag_smooth_modified();
+  mesh->tag_triangle_patch_modified();
 
   Attribute *attr_vN = mesh->attributes.add(ATTR_STD_VERTEX_NORMAL);
 
@@ -44,30 +52,45 @@ void EdgeDice::reserve(int num_verts, int num_triangles)
   params.mesh->num_subd_verts += num_verts;
 }
 
-void EdgeDice::set_vert(Patch *patch, int index, float2 uv)
+void EdgeDice::eval_vert(Patch *patch, int index, float2 uv, Vert &vert)
 {
-  float3 P, N;
+  patch->eval(&vert.P, NULL, NULL, &vert.N, uv.x, uv.y);
+  vert.index = index;
+  vert.uv = uv;
+}
 
-  patch->eval(&P, NULL, NULL, &N, uv.x, uv.y);
+void EdgeDice::set_vert(const Vert &vert)
+{
+  assert(vert.index + vert_offset < params.mesh->verts.size());
 
-  assert(index < params.mesh->verts.size());
+  mesh_P[vert.index] = vert.P;
+  mesh_N[vert.index] = vert.N;
+  params.mesh->vert_patch_uv[vert.index + vert_offset] = vert.uv;
+}
 
-  mesh_P[index] = P;
-  mesh_N[index] = N;
-  params.mesh->vert_patch_uv[index + vert_offset] = make_float2(uv.x, uv.y);
+void EdgeDice::set_vert(Patch *patch, int index, float2 uv)
+{
+  Vert vert;
+  eval_vert(patch, index, uv, vert);
+  set_vert(vert);
 }
 
-void EdgeDice::add_triangle(Patch *patch, int v0, int v1, int v2)
+void EdgeDice::set_triangle(Patch *patch, int index, int v0, int v1, int v2)
 {
   Mesh *mesh = params.mesh;
+  const size_t tri = tri_offset + index;
 
-  mesh->add_triangle(v0 + vert_offset, v1 + vert_offset, v2 + vert_offset, patch->shader, true);
-  params.mesh->triangle_patch[params.mesh->num_triangles() - 1] = patch->patch_index;
+  assert(tri < mesh->num_triangles());
 
-  tri_offset++;
+  mesh->triangles[tri * 3 + 0] = v0 + vert_offset;
+  mesh->triangles[tri * 3 + 1] = v1 + vert_offset;
+  mesh->triangles[tri * 3 + 2] = v2 + vert_offset;
+  mesh->shader[tri] = patch->shader;
+  mesh->smooth[tri] = true;
+  mesh->triangle_patch[tri] = patch->patch_index;
 }
 
-void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
+void EdgeDice::stitch_triangles(Subpatch &sub, int edge, int &triangle_index)
 {
   int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
   int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
@@ -113,7 +136,7 @@ void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
       }
     }
 
-    add_triangle(sub.patch, v1, v0, v2);
+    set_triangle(sub.patch, triangle_index++, v1, v0, v2);
   }
 }
 
@@ -147,7 +170,7 @@ void QuadDice::set_vert(Subpatch &sub, int index, float u, float v)
   EdgeDice::set_vert(sub.patch, index, map_uv(sub, u, v));
 }
 
-void QuadDice::set_side(Subpatch &sub, int edge)
+void QuadDice::eval_side(Subpatch &sub, int edge, Vert *verts)
 {
   int t = sub.edges[edge].T;
 
@@ -176,7 +199,7 @@ void QuadDice::set_side(Subpatch &sub, int edge)
         break;
     }
 
-    set_vert(sub, sub.get_vert_along_edge(edge, i), u, v);
+    eval_vert(sub.patch, sub.get_vert_along_edge(edge, i), map_uv(sub, u, v), verts[i]);
   }
 }
 
@@ -235,18 +258,19 @@ void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
         int i3 = offset + i + j * (Mu - 1);
         int i4 = offset + (i - 1) + j * (Mu - 1);
 
-        add_triangle(sub.patch, i1, i2, i3);
-        add_triangle(sub.patch, i1, i3, i4);
+        int t = sub.triangle_offset + ((i - 1) + (j - 1) * (Mu - 2)) * 2;
+        set_triangle(sub.patch, t + 0, i1, i2, i3);
+        set_triangle(sub.patch, t + 1, i1, i3, i4);
       }
     }
   }
 }
 
-void QuadDice::dice(Subpatch &sub)
+void QuadDice::grid_size(Subpatch &sub, int &Mu, int &Mv)
 {
   /* compute inner grid size with scale factor */
-  int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
-  int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
+  Mu = max(sub.edge_u0.T, sub.edge_u1.T);
+  Mv = max(sub.edge_v0.T, sub.edge_v1.T);
 
 #if 0 /* Doesn't work very well, especially at grazing angles. */
   float S = scale_factor(sub, ef, Mu, Mv);
@@ -256,20 +280,63 @@ void QuadDice::dice(Subpatch &sub)
 
   Mu = max((int)ceilf(S * Mu), 2);  // XXX handle 0 & 1?
   Mv = max((int)ceilf(S * Mv), 2);  // XXX handle 0 & 1?
+}
 
-  /* inner grid */
-  add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset);
+void QuadDice::dice(vector<Subpatch> &subpatches)
+{
+  const size_t num_subpatches = subpatches.size();
+
+  /* Vertices on the sides of subpatches are shared with neighboring subpatches. They are
+   * evaluated in parallel into a buffer, and written to the mesh in the order of the subpatches
+   * afterwards so that the result does not depend on thread scheduling. Inner grid vertices and
+   * all triangles are unique to a subpatch and written directly. */
+  vector<size_t> side_offset(num_subpatches + 1, 0);
+  for (size_t i = 0; i < num_subpatches; i++) {
+    const Subpatch &sub = subpatches[i];
+    side_offset[i + 1] = side_offset[i] + sub.edges[0].T + sub.edges[1].T + sub.edges[2].T +
+                         sub.edges[3].T;
+  }
 
-  /* sides */
-  set_side(sub, 0);
-  set_side(sub, 1);
-  set_side(sub, 2);
-  set_side(sub, 3);
+  vector<Vert> side_verts(side_offset[num_subpatches]);
 
-  stitch_triangles(sub, 0);
-  stitch_triangles(sub, 1);
-  stitch_triangles(sub, 2);
-  stitch_triangles(sub, 3);
+  parallel_for(blocked_range<size_t>(0, num_subpatches, 8), [&](const blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i < r.end(); i++) {
+      Subpatch &sub = subpatches[i];
+
+      /* inner grid */
+      int Mu, Mv;
+      grid_size(sub, Mu, Mv);
+      add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset);
+
+      /* sides */
+      Vert *verts = side_verts.data() + side_offset[i];
+      for (int edge = 0; edge < 4; edge++) {
+        eval_side(sub, edge, verts);
+        verts += sub.edges[edge].T;
+      }
+    }
+  });
+
+  for (const Vert &vert : side_verts) {
+    set_vert(vert);
+  }
+
+  /* Stitching only reads vertex positions, which are all known now. */
+  parallel_for(blocked_range<size_t>(0, num_subpatches, 8), [&](const blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i < r.end(); i++) {
+      Subpatch &sub = subpatches[i];
+
+      int Mu, Mv;
+      grid_size(sub, Mu, Mv);
+
+      int triangle_index = sub.triangle_offset + (Mu - 2) * (Mv - 2) * 2;
+      for (int edge = 0; edge < 4; edge++) {
+        stitch_triangles(sub, edge, triangle_index);
+      }
+
+      assert(triangle_index == sub.triangle_offset + sub.calc_num_triangles());
+    }
+  });
 }
 
 CCL_NAMESPACE_END
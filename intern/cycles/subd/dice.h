@@ -55,14 +55,24 @@ class EdgeDice {
   size_t vert_offset;
   size_t tri_offset;
 
+  /* Evaluated vertex, to be written to the mesh later. */
+  struct Vert {
+    int index;
+    float3 P;
+    float3 N;
+    float2 uv;
+  };
+
   explicit EdgeDice(const SubdParams &params);
 
   void reserve(int num_verts, int num_triangles);
 
+  void eval_vert(Patch *patch, int index, float2 uv, Vert &vert);
+  void set_vert(const Vert &vert);
   void set_vert(Patch *patch, int index, float2 uv);
-  void add_triangle(Patch *patch, int v0, int v1, int v2);
+  void set_triangle(Patch *patch, int index, int v0, int v1, int v2);
 
-  void stitch_triangles(Subpatch &sub, int edge);
+  void stitch_triangles(Subpatch &sub, int edge, int &triangle_index);
 };
 
 /* Quad EdgeDice */
@@ -76,14 +86,17 @@ class QuadDice : public EdgeDice {
   float2 map_uv(Subpatch &sub, float u, float v);
   void set_vert(Subpatch &sub, int index, float u, float v);
 
+  void grid_size(Subpatch &sub, int &Mu, int &Mv);
   void add_grid(Subpatch &sub, int Mu, int Mv, int offset);
 
-  void set_side(Subpatch &sub, int edge);
+  void eval_side(Subpatch &sub, int edge, Vert *verts);
 
   float quad_area(const float3 &a, const float3 &b, const float3 &c, const float3 &d);
   float scale_factor(Subpatch &sub, int Mu, int Mv);
 
-  void dice(Subpatch &sub);
+  /* Dice all subpatches, distributing the work over threads. Inner vertex and triangle offsets
+   * of the subpatches must have been set, and the mesh reserved. */
+  void dice(vector<Subpatch> &subpatches);
 };
 
 CCL_NAMESPACE_END
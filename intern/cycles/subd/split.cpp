@@ -13,7 +13,9 @@
 #include "util/foreach.h"
 #include "util/hash.h"
 #include "util/math.h"
+#include "util/tbb.h"
 #include "util/types.h"
+#include "util/unique_ptr.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -23,7 +25,10 @@ CCL_NAMESPACE_BEGIN
 #define STITCH_NGON_CENTER_VERT_INDEX_OFFSET 0x60000000
 #define STITCH_NGON_SPLIT_EDGE_CENTER_VERT_TAG (0x60000000 - 1)
 
-DiagSplit::DiagSplit(const SubdParams &params_) : params(params_) {}
+DiagSplit::DiagSplit(const SubdParams &params_) : params(params_)
+{
+  edges.resize(1);
+}
 
 float3 DiagSplit::to_world(Patch *patch, float2 uv)
 {
@@ -320,30 +325,59 @@ int DiagSplit::alloc_verts(int n)
 
 Edge *DiagSplit::alloc_edge()
 {
-  edges.emplace_back();
-  return &edges.back();
+  deque<Edge> &chunk_edges = edges.back();
+  chunk_edges.emplace_back();
+  return &chunk_edges.back();
 }
 
 void DiagSplit::split_patches(Patch *patches, size_t patches_byte_stride)
 {
-  int patch_index = 0;
+  const int num_faces = params.mesh->get_num_subd_faces();
 
-  for (int f = 0; f < params.mesh->get_num_subd_faces(); f++) {
+  /* Index of the first patch of each face. */
+  vector<int> face_patch_index(num_faces + 1);
+  face_patch_index[0] = 0;
+  for (int f = 0; f < num_faces; f++) {
     Mesh::SubdFace face = params.mesh->get_subd_face(f);
+    face_patch_index[f + 1] = face_patch_index[f] + (face.is_quad() ? 1 : face.num_corners);
+  }
 
-    Patch *patch = (Patch *)(((char *)patches) + patch_index * patches_byte_stride);
+  /* Faces are split independently of each other, so chunks of faces are split in parallel.
+   * Every patch allocates 4 verts, so each chunk can allocate the same vertex indices as when
+   * splitting all faces in order. Results are merged in the order of the faces. */
+  const int faces_per_chunk = 256;
+  const int num_chunks = divide_up(num_faces, faces_per_chunk);
+  vector<unique_ptr<DiagSplit>> chunks(num_chunks);
 
-    if (face.is_quad()) {
-      patch_index++;
+  parallel_for(0, num_chunks, [&](const int chunk) {
+    const int start = chunk * faces_per_chunk;
+    const int end = min(start + faces_per_chunk, num_faces);
 
-      split_quad(face, patch);
-    }
-    else {
-      patch_index += face.num_corners;
+    DiagSplit *split = new DiagSplit(params);
+    split->num_alloced_verts = 4 * face_patch_index[start];
+    chunks[chunk].reset(split);
+
+    for (int f = start; f < end; f++) {
+      Mesh::SubdFace face = params.mesh->get_subd_face(f);
 
-      split_ngon(face, patch, patches_byte_stride);
+      Patch *patch = (Patch *)(((char *)patches) + face_patch_index[f] * patches_byte_stride);
+
+      if (face.is_quad()) {
+        split->split_quad(face, patch);
+      }
+      else {
+        split->split_ngon(face, patch, patches_byte_stride);
+      }
     }
+  });
+
+  /* Reserve so moving the edges into the vector does not move them again. */
+  edges.reserve(edges.size() + num_chunks);
+  for (unique_ptr<DiagSplit> &split : chunks) {
+    subpatches.insert(subpatches.end(), split->subpatches.begin(), split->subpatches.end());
+    edges.push_back(std::move(split->edges.back()));
   }
+  num_alloced_verts = 4 * face_patch_index[num_faces];
 
   params.mesh->vert_to_stitching_key_map.clear();
   params.mesh->vert_stitching_map.clear();
@@ -594,7 +628,15 @@ void DiagSplit::post_split()
 
   /* All patches are now split, and all T values known. */
 
-  foreach (Edge &edge, edges) {
+  vector<Edge *> all_edges;
+  for (deque<Edge> &chunk_edges : edges) {
+    for (Edge &edge : chunk_edges) {
+      all_edges.push_back(&edge);
+    }
+  }
+
+  for (Edge *edge_ptr : all_edges) {
+    Edge &edge = *edge_ptr;
     if (edge.second_vert_index < 0) {
       edge.second_vert_index = alloc_verts(edge.T - 1);
     }
@@ -617,7 +659,8 @@ void DiagSplit::post_split()
   typedef unordered_map<pair<int, int>, int, pair_hasher> edge_stitch_verts_map_t;
   edge_stitch_verts_map_t edge_stitch_verts_map;
 
-  foreach (Edge &edge, edges) {
+  for (Edge *edge_ptr : all_edges) {
+    Edge &edge = *edge_ptr;
     if (edge.is_stitch_edge) {
       if (edge.stitch_edge_T == 0) {
         edge.stitch_edge_T = edge.T;
@@ -631,7 +674,8 @@ void DiagSplit::post_split()
   }
 
   /* Set start and end indices for edges generated from a split. */
-  foreach (Edge &edge, edges) {
+  for (Edge *edge_ptr : all_edges) {
+    Edge &edge = *edge_ptr;
     if (edge.start_vert_index < 0) {
       /* Fix up offsets. */
       if (edge.top_indices_decrease) {
@@ -653,7 +697,8 @@ void DiagSplit::post_split()
   int vert_offset = params.mesh->verts.size();
 
   /* Add verts to stitching map. */
-  foreach (const Edge &edge, edges) {
+  for (const Edge *edge_ptr : all_edges) {
+    const Edge &edge = *edge_ptr;
     if (edge.is_stitch_edge) {
       int second_stitch_vert_index = edge_stitch_verts_map[edge.stitch_edge_key];
 
@@ -709,14 +754,6 @@ void DiagSplit::post_split()
   int num_verts = num_alloced_verts;
   int num_triangles = 0;
 
-  for (size_t i = 0; i < subpatches.size(); i++) {
-    subpatches[i].inner_grid_vert_offset = num_verts;
-    num_verts += subpatches[i].calc_num_inner_verts();
-    num_triangles += subpatches[i].calc_num_triangles();
-  }
-
-  dice.reserve(num_verts, num_triangles);
-
   for (size_t i = 0; i < subpatches.size(); i++) {
     Subpatch &sub = subpatches[i];
 
@@ -725,12 +762,19 @@ void DiagSplit::post_split()
     sub.edge_v0.T = max(sub.edge_v0.T, 1);
     sub.edge_v1.T = max(sub.edge_v1.T, 1);
 
-    dice.dice(sub);
+    sub.inner_grid_vert_offset = num_verts;
+    sub.triangle_offset = num_triangles;
+    num_verts += sub.calc_num_inner_verts();
+    num_triangles += sub.calc_num_triangles();
   }
 
+  dice.reserve(num_verts, num_triangles);
+  dice.dice(subpatches);
+
   /* Cleanup */
   subpatches.clear();
   edges.clear();
+  edges.resize(1);
 }
 
 CCL_NAMESPACE_END
@@ -28,8 +28,9 @@ class DiagSplit {
   SubdParams params;
 
   vector<Subpatch> subpatches;
-  /* `deque` is used so that element pointers remain valid when size is changed. */
-  deque<Edge> edges;
+  /* `deque` is used so that element pointers remain valid when size is changed. Faces are split
+   * in parallel chunks, each with their own edges, which are then moved here. */
+  vector<deque<Edge>> edges;
 
   float3 to_world(Patch *patch, float2 uv);
   int T(Patch *patch, float2 Pstart, float2 Pend, bool recursive_resolve = false);
@@ -50,6 +51,7 @@ class DiagSplit {
 
   explicit DiagSplit(const SubdParams &params);
 
+  /* Split all patches of the mesh and dice them. */
   void split_patches(Patch *patches, size_t patches_byte_stride);
 
   void split_quad(const Mesh::SubdFace &face, Patch *patch);
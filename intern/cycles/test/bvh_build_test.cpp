@@ -0,0 +1,125 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "bvh/build.h"
+#include "bvh/node.h"
+#include "bvh/params.h"
+
+#include "scene/hair.h"
+#include "scene/object.h"
+
+#include "util/progress.h"
+#include "util/set.h"
+
+CCL_NAMESPACE_BEGIN
+
+class BVHBuildTest : public testing::Test {
+ protected:
+  Hair hair;
+  Object object;
+
+  virtual void SetUp()
+  {
+    /* A dense groom of wavy strands, with pseudo-random root positions. */
+    const int num_curves = 500;
+    const int num_keys = 8;
+    hair.reserve_curves(num_curves, num_curves * num_keys);
+    for (int i = 0; i < num_curves; i++) {
+      const float3 root = make_float3(
+          ((i * 37) % 101) * 0.01f, ((i * 53) % 97) * 0.01f, ((i * 17) % 7) * 0.01f);
+      hair.add_curve(hair.get_curve_keys().size(), 0);
+      for (int k = 0; k < num_keys; k++) {
+        const float3 wave = make_float3(0.02f * sinf(k + i), 0.02f * cosf(k * 2 + i), 0.0f);
+        hair.add_curve_key(root + wave + make_float3(0.0f, 0.0f, k * 0.05f), 0.005f);
+      }
+    }
+
+    object.set_geometry(&hair);
+    object.set_tfm(transform_identity());
+  }
+
+  /* Build a BVH2 for the hair, and return the curve segments that could be hit by the ray as
+   * found by traversing it. A segment could be hit if the ray intersects its bounds. */
+  set<std::pair<int, int>> traverse(const bool use_compact_curves,
+                                    const float3 P,
+                                    const float3 dir,
+                                    int *r_num_nodes)
+  {
+    BVHParams params;
+    params.use_compact_curves = use_compact_curves;
+
+    vector<Object *> objects;
+    objects.push_back(&object);
+    array<int> prim_type, prim_index, prim_object;
+    array<float2> prim_time;
+    Progress progress;
+    BVHBuild build(objects, prim_type, prim_index, prim_object, prim_time, params, progress);
+    BVHNode *root = build.run();
+    *r_num_nodes = root->getSubtreeSize(BVH_STAT_NODE_COUNT);
+
+    set<std::pair<int, int>> hits;
+    vector<const BVHNode *> stack;
+    stack.push_back(root);
+    while (!stack.empty()) {
+      const BVHNode *node = stack.back();
+      stack.pop_back();
+      if (!ray_hits_bounds(P, dir, node->bounds)) {
+        continue;
+      }
+      if (!node->is_leaf()) {
+        for (int i = 0; i < node->num_children(); i++) {
+          stack.push_back(node->get_child(i));
+        }
+        continue;
+      }
+      const LeafNode *leaf = static_cast<const LeafNode *>(node);
+      for (int i = leaf->lo; i < leaf->hi; i++) {
+        const int curve = prim_index[i];
+        const int segment = PRIMITIVE_UNPACK_SEGMENT(prim_type[i]);
+        BoundBox bounds = BoundBox::empty;
+        hair.get_curve(curve).bounds_grow(
+            segment, &hair.get_curve_keys()[0], &hair.get_curve_radius()[0], bounds);
+        if (ray_hits_bounds(P, dir, bounds)) {
+          hits.insert({curve, segment});
+        }
+      }
+    }
+
+    root->deleteSubtree();
+    return hits;
+  }
+
+  static bool ray_hits_bounds(const float3 P, const float3 dir, const BoundBox &bounds)
+  {
+    const float3 idir = rcp(dir);
+    const float3 t0 = (bounds.min - P) * idir;
+    const float3 t1 = (bounds.max - P) * idir;
+    const float tnear = reduce_max(min(t0, t1));
+    const float tfar = reduce_min(max(t0, t1));
+    return tnear <= tfar && tfar >= 0.0f;
+  }
+};
+
+TEST_F(BVHBuildTest, compact_curves_same_hits)
+{
+  int num_rays_with_hits = 0;
+  for (int i = 0; i < 64; i++) {
+    const float3 P = make_float3((i % 8) * 0.125f, (i / 8) * 0.125f, -1.0f);
+    const float3 dir = normalize(
+        make_float3(0.1f * (i % 3) + 0.05f, 0.1f * (i % 5) + 0.05f, 1.0f));
+
+    int num_nodes, num_nodes_compact;
+    const set<std::pair<int, int>> hits = traverse(false, P, dir, &num_nodes);
+    const set<std::pair<int, int>> hits_compact = traverse(true, P, dir, &num_nodes_compact);
+
+    EXPECT_EQ(hits, hits_compact);
+    EXPECT_LT(num_nodes_compact, num_nodes);
+    num_rays_with_hits += !hits.empty();
+  }
+  EXPECT_GT(num_rays_with_hits, 0);
+}
+
+CCL_NAMESPACE_END
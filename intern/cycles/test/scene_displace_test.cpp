@@ -0,0 +1,162 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "device/device.h"
+#include "device/memory.h"
+
+#include "scene/colorspace.h"
+#include "scene/geometry.h"
+#include "scene/mesh.h"
+#include "scene/object.h"
+#include "scene/scene.h"
+#include "scene/shader.h"
+
+#include "util/progress.h"
+#include "util/stats.h"
+
+CCL_NAMESPACE_BEGIN
+
+class DisplaceTest : public testing::Test {
+ protected:
+  Stats stats;
+  Profiler profiler;
+  DeviceInfo device_info;
+  Device *device_cpu;
+  SceneParams scene_params;
+  Scene *scene;
+  Progress progress;
+  Shader *shader;
+  vector<Mesh *> meshes;
+  vector<array<float3>> original_verts;
+
+  virtual void SetUp()
+  {
+    ColorSpaceManager::init_fallback_config();
+
+    device_cpu = Device::create(device_info, stats, profiler);
+    scene = new Scene(scene_params, device_cpu);
+
+    shader = scene->create_node<Shader>();
+    shader->has_displacement = true;
+    shader->set_displacement_method(DISPLACE_TRUE);
+
+    /* Grids of different sizes, so batches contain varying numbers of meshes. */
+    int prim_offset = 0;
+    for (int i = 0; i < 6; i++) {
+      Mesh *mesh = add_grid(4 + i * 3);
+      mesh->prim_offset = prim_offset;
+      prim_offset += mesh->num_triangles();
+      meshes.push_back(mesh);
+      original_verts.push_back(mesh->get_verts());
+    }
+  }
+
+  virtual void TearDown()
+  {
+    delete scene;
+    delete device_cpu;
+  }
+
+  Mesh *add_grid(const int resolution)
+  {
+    Mesh *mesh = scene->create_node<Mesh>();
+    array<Node *> used_shaders;
+    used_shaders.push_back_slow(shader);
+    mesh->set_used_shaders(used_shaders);
+
+    mesh->reserve_mesh((resolution + 1) * (resolution + 1), resolution * resolution * 2);
+    for (int y = 0; y <= resolution; y++) {
+      for (int x = 0; x <= resolution; x++) {
+        mesh->add_vertex(make_float3(x, y, 0.0f));
+      }
+    }
+    for (int y = 0; y < resolution; y++) {
+      for (int x = 0; x < resolution; x++) {
+        const int v = y * (resolution + 1) + x;
+        mesh->add_triangle(v, v + 1, v + resolution + 2, 0, false);
+        mesh->add_triangle(v, v + resolution + 2, v + resolution + 1, 0, false);
+      }
+    }
+    mesh->add_vertex_normals();
+
+    Object *object = scene->create_node<Object>();
+    object->set_geometry(mesh);
+    object->set_tfm(transform_identity());
+
+    return mesh;
+  }
+
+  /* Displace all meshes with the given batch size, using an offset that only depends on the
+   * shader evaluation input instead of the kernel. Returns the number of batches. */
+  int displace(const size_t max_batch_inputs)
+  {
+    for (size_t i = 0; i < meshes.size(); i++) {
+      meshes[i]->set_verts(original_verts[i]);
+    }
+
+    int num_batches = 0;
+    const bool displaced = GeometryManager::displace_meshes(
+        scene,
+        meshes,
+        max_batch_inputs,
+        [&](const int max_num_inputs,
+            const function<int(device_vector<KernelShaderEvalInput> &)> &fill_input,
+            const function<void(device_vector<float> &)> &read_output) {
+          num_batches++;
+
+          device_vector<KernelShaderEvalInput> input(device_cpu, "Test input", MEM_READ_ONLY);
+          input.alloc(max_num_inputs);
+          const int num_points = fill_input(input);
+          EXPECT_LE(num_points, max_num_inputs);
+
+          device_vector<float> output(device_cpu, "Test output", MEM_READ_WRITE);
+          output.alloc(num_points * 3);
+          for (int i = 0; i < num_points; i++) {
+            const KernelShaderEvalInput &in = input.data()[i];
+            output.data()[i * 3 + 0] = in.u;
+            output.data()[i * 3 + 1] = in.v;
+            output.data()[i * 3 + 2] = 0.01f * in.prim + 0.1f * in.object;
+          }
+          read_output(output);
+          return true;
+        },
+        progress);
+    EXPECT_TRUE(displaced);
+
+    return num_batches;
+  }
+
+  vector<array<float3>> displaced_verts()
+  {
+    vector<array<float3>> verts;
+    for (Mesh *mesh : meshes) {
+      verts.push_back(mesh->get_verts());
+    }
+    return verts;
+  }
+};
+
+TEST_F(DisplaceTest, batched_matches_per_mesh)
+{
+  /* Every mesh is larger than the batch size, so each one gets a batch of its own. */
+  EXPECT_EQ(displace(1), int(meshes.size()));
+  const vector<array<float3>> expected = displaced_verts();
+
+  /* All meshes in a single batch. */
+  EXPECT_EQ(displace(size_t(1) << 24), 1);
+  EXPECT_EQ(displaced_verts(), expected);
+
+  /* Batches containing a few meshes each. */
+  const int num_batches = displace(meshes[4]->get_verts().size() + 10);
+  EXPECT_GT(num_batches, 1);
+  EXPECT_LT(num_batches, int(meshes.size()));
+  EXPECT_EQ(displaced_verts(), expected);
+
+  /* Displacement actually moved the vertices. */
+  EXPECT_NE(expected[0][1].x, original_verts[0][1].x);
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,163 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "device/device.h"
+
+#include "scene/colorspace.h"
+#include "scene/geometry.h"
+#include "scene/mesh.h"
+#include "scene/object.h"
+#include "scene/scene.h"
+#include "scene/shader.h"
+
+#include "util/progress.h"
+#include "util/stats.h"
+#include "util/string.h"
+#include "util/time.h"
+
+CCL_NAMESPACE_BEGIN
+
+class GeometryAttributesTest : public testing::Test {
+ protected:
+  Stats stats;
+  Profiler profiler;
+  DeviceInfo device_info;
+  Device *device_cpu;
+  SceneParams scene_params;
+  Scene *scene = nullptr;
+  Progress progress;
+
+  virtual void SetUp()
+  {
+    ColorSpaceManager::init_fallback_config();
+
+    device_cpu = Device::create(device_info, stats, profiler);
+  }
+
+  virtual void TearDown()
+  {
+    delete scene;
+    delete device_cpu;
+  }
+
+  void create_scene(const bool use_half_precision_attributes)
+  {
+    scene_params.use_half_precision_attributes = use_half_precision_attributes;
+    scene = new Scene(scene_params, device_cpu);
+  }
+
+  /* Create an object with a grid of resolution x resolution quads, with a UV map that covers
+   * the unit square moved by the given offset. */
+  Mesh *add_uv_grid(const int resolution, const float2 uv_offset)
+  {
+    Shader *shader = scene->create_node<Shader>();
+    shader->attributes.add(ATTR_STD_UV);
+
+    Mesh *mesh = scene->create_node<Mesh>();
+    array<Node *> used_shaders;
+    used_shaders.push_back_slow(shader);
+    mesh->set_used_shaders(used_shaders);
+
+    mesh->reserve_mesh((resolution + 1) * (resolution + 1), resolution * resolution * 2);
+    for (int y = 0; y <= resolution; y++) {
+      for (int x = 0; x <= resolution; x++) {
+        mesh->add_vertex(make_float3(x, y, 0.0f));
+      }
+    }
+    for (int y = 0; y < resolution; y++) {
+      for (int x = 0; x < resolution; x++) {
+        const int v = y * (resolution + 1) + x;
+        mesh->add_triangle(v, v + 1, v + resolution + 2, 0, false);
+        mesh->add_triangle(v, v + resolution + 2, v + resolution + 1, 0, false);
+      }
+    }
+
+    Attribute *attr = mesh->attributes.add(ATTR_STD_UV, ustring("UVMap"));
+    float2 *uv = attr->data_float2();
+    const int *triangles = mesh->get_triangles().data();
+    for (size_t i = 0; i < mesh->num_triangles() * 3; i++) {
+      const int v = triangles[i];
+      uv[i] = uv_offset + make_float2(v % (resolution + 1), v / (resolution + 1)) / resolution;
+    }
+
+    Object *object = scene->create_node<Object>();
+    object->set_geometry(mesh);
+    object->set_tfm(transform_identity());
+
+    return mesh;
+  }
+
+  /* Device memory used by the float and float2 attribute arrays. */
+  size_t attributes_memory_size()
+  {
+    return scene->dscene.attributes_float.memory_size() +
+           scene->dscene.attributes_float2.memory_size();
+  }
+};
+
+TEST_F(GeometryAttributesTest, half_precision_uv)
+{
+  create_scene(true);
+  Mesh *mesh = add_uv_grid(16, zero_float2());
+  const size_t num_corners = mesh->num_triangles() * 3;
+
+  scene->geometry_manager->device_update_attributes(device_cpu, &scene->dscene, scene, progress);
+
+  /* The UV map is stored as pairs of half floats, in one float per corner. */
+  EXPECT_EQ(scene->dscene.attributes_float2.size(), size_t(0));
+  EXPECT_EQ(scene->dscene.attributes_float.size(), num_corners);
+  EXPECT_EQ(attributes_memory_size(), num_corners * sizeof(float));
+}
+
+TEST_F(GeometryAttributesTest, half_precision_uv_udim)
+{
+  create_scene(true);
+  Mesh *mesh = add_uv_grid(16, make_float2(1.0f, 0.0f));
+  const size_t num_corners = mesh->num_triangles() * 3;
+
+  scene->geometry_manager->device_update_attributes(device_cpu, &scene->dscene, scene, progress);
+
+  /* Coordinates outside of the unit square keep full precision. */
+  EXPECT_EQ(scene->dscene.attributes_float2.size(), num_corners);
+  EXPECT_EQ(scene->dscene.attributes_float.size(), size_t(0));
+}
+
+TEST_F(GeometryAttributesTest, full_precision_uv)
+{
+  create_scene(false);
+  Mesh *mesh = add_uv_grid(16, zero_float2());
+  const size_t num_corners = mesh->num_triangles() * 3;
+
+  scene->geometry_manager->device_update_attributes(device_cpu, &scene->dscene, scene, progress);
+
+  EXPECT_EQ(scene->dscene.attributes_float2.size(), num_corners);
+  EXPECT_EQ(attributes_memory_size(), num_corners * sizeof(float2));
+}
+
+/* Benchmark of the attribute device update and memory usage for many UV mapped triangles, with
+ * and without half precision, run with `--gtest_also_run_disabled_tests`. Render time is not
+ * measured, as it depends on the scene and the number of texture lookups. */
+TEST_F(GeometryAttributesTest, DISABLED_benchmark_half_precision_uv)
+{
+  for (const bool use_half_precision_attributes : {false, true}) {
+    delete scene;
+    create_scene(use_half_precision_attributes);
+    for (int i = 0; i < 4; i++) {
+      add_uv_grid(1024, zero_float2());
+    }
+
+    const double start_time = time_dt();
+    scene->geometry_manager->device_update_attributes(device_cpu, &scene->dscene, scene, progress);
+    const double time = time_dt() - start_time;
+
+    std::cout << ((use_half_precision_attributes) ? "Half" : "Full")
+              << " precision UV maps of " << 4 * 1024 * 1024 * 2 << " triangles: " << time
+              << "s to update, " << string_human_readable_size(attributes_memory_size())
+              << " of device memory\n";
+  }
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,145 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "device/device.h"
+
+#include "scene/colorspace.h"
+#include "scene/image.h"
+#include "scene/image_vdb.h"
+
+CCL_NAMESPACE_BEGIN
+
+#ifdef WITH_OPENVDB
+
+/* Sphere of active voxels with values decreasing away from the center. */
+static openvdb::FloatGrid::Ptr create_sphere_grid()
+{
+  openvdb::FloatGrid::Ptr grid = openvdb::FloatGrid::create(0.0f);
+  openvdb::FloatGrid::Accessor accessor = grid->getAccessor();
+  for (int z = -10; z <= 10; z++) {
+    for (int y = -10; y <= 10; y++) {
+      for (int x = -10; x <= 10; x++) {
+        const float distance = sqrtf(float(x * x + y * y + z * z));
+        if (distance <= 10.0f) {
+          accessor.setValue(openvdb::Coord(x, y, z), 1.0f - distance / 10.0f);
+        }
+      }
+    }
+  }
+  return grid;
+}
+
+TEST(VDBImageLoader, equals)
+{
+  openvdb::FloatGrid::Ptr grid = create_sphere_grid();
+
+  /* Another grid of the same tree, as created for each object using the grid. */
+  openvdb::FloatGrid::Ptr shared_grid = grid->copy();
+  ASSERT_EQ(grid->constBaseTreePtr(), shared_grid->constBaseTreePtr());
+
+  /* Same tree with a different transform. */
+  openvdb::FloatGrid::Ptr scaled_grid = grid->copy();
+  scaled_grid->setTransform(openvdb::math::Transform::createLinearTransform(0.5));
+
+  /* Same contents in a different tree. */
+  openvdb::FloatGrid::Ptr deep_grid = grid->deepCopy();
+
+  VDBImageLoader loader(grid, "density");
+  VDBImageLoader same_loader(grid, "density");
+  VDBImageLoader shared_loader(shared_grid, "density");
+  VDBImageLoader scaled_loader(scaled_grid, "density");
+  VDBImageLoader deep_loader(deep_grid, "density");
+
+  EXPECT_TRUE(loader.equals(same_loader));
+  EXPECT_TRUE(loader.shares_tree(shared_loader));
+  EXPECT_FALSE(loader.shares_tree(deep_loader));
+
+  /* Grids of a shared tree are not assumed to match before their contents are hashed. */
+  EXPECT_FALSE(loader.has_grid_hash());
+  EXPECT_FALSE(loader.equals(shared_loader));
+
+  loader.compute_grid_hash();
+  shared_loader.compute_grid_hash();
+  scaled_loader.compute_grid_hash();
+  deep_loader.compute_grid_hash();
+  EXPECT_TRUE(loader.has_grid_hash());
+  EXPECT_TRUE(loader.equals(shared_loader));
+  EXPECT_TRUE(shared_loader.equals(loader));
+  EXPECT_FALSE(loader.equals(scaled_loader));
+  EXPECT_FALSE(loader.equals(deep_loader));
+
+  /* Values modified in place are detected through the hash. */
+  VDBImageLoader modified_loader(shared_grid, "density");
+  shared_grid->tree().setValue(openvdb::Coord(0, 0, 0), 2.0f);
+  modified_loader.compute_grid_hash();
+  EXPECT_FALSE(loader.equals(modified_loader));
+}
+
+#  ifdef WITH_NANOVDB
+
+class VDBImageCacheTest : public testing::Test {
+ protected:
+  DeviceInfo device_info;
+  ImageManager *image_manager;
+  ImageParams params;
+
+  virtual void SetUp()
+  {
+    ColorSpaceManager::init_fallback_config();
+    device_info.has_nanovdb = true;
+    image_manager = new ImageManager(device_info);
+  }
+
+  virtual void TearDown()
+  {
+    image_manager->device_free(nullptr);
+    delete image_manager;
+  }
+
+  ImageHandle add_grid(openvdb::FloatGrid::Ptr grid)
+  {
+    return image_manager->add_image(new VDBImageLoader(grid, "density"), params);
+  }
+};
+
+TEST_F(VDBImageCacheTest, hit)
+{
+  openvdb::FloatGrid::Ptr grid = create_sphere_grid();
+
+  ImageHandle handle = add_grid(grid);
+  ImageHandle same_handle = add_grid(grid);
+  ImageHandle shared_handle = add_grid(grid->copy());
+
+  EXPECT_EQ(image_manager->num_slots(), size_t(1));
+  EXPECT_EQ(handle.svm_slot(), same_handle.svm_slot());
+  EXPECT_EQ(handle.svm_slot(), shared_handle.svm_slot());
+  EXPECT_EQ(handle.metadata().type, IMAGE_DATA_TYPE_NANOVDB_FPN);
+}
+
+TEST_F(VDBImageCacheTest, miss)
+{
+  openvdb::FloatGrid::Ptr grid = create_sphere_grid();
+
+  /* Load the metadata, which hashes the grid, before it is modified. */
+  ImageHandle handle = add_grid(grid);
+  EXPECT_EQ(handle.metadata().type, IMAGE_DATA_TYPE_NANOVDB_FPN);
+
+  openvdb::FloatGrid::Ptr modified_grid = grid->copy();
+  modified_grid->tree().setValue(openvdb::Coord(0, 0, 0), 2.0f);
+  ImageHandle modified_handle = add_grid(modified_grid);
+
+  openvdb::FloatGrid::Ptr deep_grid = grid->deepCopy();
+  ImageHandle deep_handle = add_grid(deep_grid);
+
+  EXPECT_EQ(image_manager->num_slots(), size_t(3));
+  EXPECT_NE(handle.svm_slot(), modified_handle.svm_slot());
+  EXPECT_NE(handle.svm_slot(), deep_handle.svm_slot());
+}
+
+#  endif
+#endif
+
+CCL_NAMESPACE_END
@@ -0,0 +1,167 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "device/device.h"
+
+#include "scene/colorspace.h"
+#include "scene/light_tree.h"
+#include "scene/mesh.h"
+#include "scene/object.h"
+#include "scene/scene.h"
+#include "scene/shader.h"
+
+#include "util/progress.h"
+#include "util/stats.h"
+#include "util/time.h"
+
+CCL_NAMESPACE_BEGIN
+
+class LightTreeTest : public testing::Test {
+ protected:
+  Stats stats;
+  Profiler profiler;
+  DeviceInfo device_info;
+  Device *device_cpu;
+  SceneParams scene_params;
+  Scene *scene;
+  Progress progress;
+
+  virtual void SetUp()
+  {
+    ColorSpaceManager::init_fallback_config();
+
+    device_cpu = Device::create(device_info, stats, profiler);
+    scene = new Scene(scene_params, device_cpu);
+  }
+
+  virtual void TearDown()
+  {
+    delete scene;
+    delete device_cpu;
+  }
+
+  /* Create an object with a grid of resolution x resolution quads, all of them emissive. */
+  Mesh *add_emissive_grid(const int resolution, const float3 offset)
+  {
+    Shader *shader = scene->create_node<Shader>();
+    shader->emission_estimate = one_float3();
+    shader->emission_sampling = EMISSION_SAMPLING_FRONT_BACK;
+
+    Mesh *mesh = scene->create_node<Mesh>();
+    array<Node *> used_shaders;
+    used_shaders.push_back_slow(shader);
+    mesh->set_used_shaders(used_shaders);
+
+    mesh->reserve_mesh((resolution + 1) * (resolution + 1), resolution * resolution * 2);
+    for (int y = 0; y <= resolution; y++) {
+      for (int x = 0; x <= resolution; x++) {
+        mesh->add_vertex(offset + make_float3(x, y, 0.1f * ((x * 7 + y * 13) % 5)));
+      }
+    }
+    for (int y = 0; y < resolution; y++) {
+      for (int x = 0; x < resolution; x++) {
+        const int v = y * (resolution + 1) + x;
+        mesh->add_triangle(v, v + 1, v + resolution + 2, 0, false);
+        mesh->add_triangle(v, v + resolution + 2, v + resolution + 1, 0, false);
+      }
+    }
+    mesh->compute_bounds();
+
+    Object *object = scene->create_node<Object>();
+    object->set_geometry(mesh);
+    object->set_tfm(transform_identity());
+    object->compute_bounds(false);
+
+    return mesh;
+  }
+
+  /* Build the light tree and return the number of nodes. */
+  int build_light_tree(LightTreeCache *cache, float *energy = nullptr)
+  {
+    DeviceScene *dscene = &scene->dscene;
+    dscene->data.integrator.num_lights = 0;
+    dscene->data.integrator.num_distant_lights = 0;
+
+    LightTree light_tree(scene, dscene, progress, 8);
+    LightTreeNode *root = light_tree.build(scene, dscene, cache);
+    EXPECT_NE(root, nullptr);
+
+    if (energy) {
+      *energy = root->measure.energy;
+    }
+    return light_tree.num_nodes;
+  }
+};
+
+TEST_F(LightTreeTest, parallel_build)
+{
+  /* Enough emitters for buckets to be filled in parallel. */
+  add_emissive_grid(128, zero_float3());
+
+  float energy;
+  const int num_nodes = build_light_tree(nullptr, &energy);
+
+  /* Area of the grid, with some triangles tilted. */
+  EXPECT_GT(energy, 128.0f * 128.0f);
+  EXPECT_GT(num_nodes, 128 * 128 * 2 / 8);
+}
+
+TEST_F(LightTreeTest, cache_reuse)
+{
+  Mesh *mesh_a = add_emissive_grid(64, zero_float3());
+  add_emissive_grid(64, make_float3(100.0f, 0.0f, 0.0f));
+
+  LightTreeCache cache;
+
+  float energy_built;
+  const int num_nodes_built = build_light_tree(&cache, &energy_built);
+  EXPECT_EQ(cache.num_built, 2);
+  EXPECT_EQ(cache.num_reused, 0);
+
+  /* Nothing changed, both subtrees are reused and give the same tree. */
+  float energy_reused;
+  const int num_nodes_reused = build_light_tree(&cache, &energy_reused);
+  EXPECT_EQ(cache.num_built, 0);
+  EXPECT_EQ(cache.num_reused, 2);
+  EXPECT_EQ(num_nodes_built, num_nodes_reused);
+  EXPECT_EQ(energy_built, energy_reused);
+
+  /* Modify one mesh, only its subtree is rebuilt. */
+  array<float3> verts = mesh_a->get_verts();
+  verts[0].z += 1.0f;
+  mesh_a->set_verts(verts);
+  mesh_a->compute_bounds();
+
+  build_light_tree(&cache);
+  EXPECT_EQ(cache.num_built, 1);
+  EXPECT_EQ(cache.num_reused, 1);
+}
+
+/* Benchmark of the light tree build for many emissive triangles, run with
+ * `--gtest_also_run_disabled_tests`. */
+TEST_F(LightTreeTest, DISABLED_benchmark)
+{
+  for (int i = 0; i < 4; i++) {
+    add_emissive_grid(512, make_float3(1000.0f * i, 0.0f, 0.0f));
+  }
+
+  LightTreeCache cache;
+
+  double start_time = time_dt();
+  build_light_tree(nullptr);
+  const double time_no_cache = time_dt() - start_time;
+
+  build_light_tree(&cache);
+
+  start_time = time_dt();
+  build_light_tree(&cache);
+  const double time_cache = time_dt() - start_time;
+
+  std::cout << "Light tree with " << 4 * 512 * 512 * 2 << " emissive triangles: "
+            << time_no_cache << "s to build, " << time_cache << "s to rebuild from cache\n";
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,67 @@
+/* SPDX-FileCopyrightText: 2024 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "scene/stats.h"
+
+CCL_NAMESPACE_BEGIN
+
+TEST(scene_stats, nested_json_report)
+{
+  NamedNestedSampleStats kernel("Total render time", 1000);
+  NamedNestedSampleStats &intersect = kernel.add_entry("Intersect Closest", 500);
+  intersect.rays = 10;
+  intersect.bvh_nodes = 250;
+
+  EXPECT_EQ(kernel.json_report(),
+            "{\n"
+            "  \"name\": \"Total render time\",\n"
+            "  \"time\": 1.500,\n"
+            "  \"self_time\": 1.000,\n"
+            "  \"rays\": 0,\n"
+            "  \"stages\": [\n"
+            "    {\n"
+            "      \"name\": \"Intersect Closest\",\n"
+            "      \"time\": 0.500,\n"
+            "      \"self_time\": 0.500,\n"
+            "      \"rays\": 10,\n"
+            "      \"bvh_node_tests_per_ray\": 25.00,\n"
+            "      \"stages\": []\n"
+            "    }\n"
+            "  ]\n"
+            "}");
+}
+
+TEST(scene_stats, render_json_report_no_profiling)
+{
+  RenderStats stats;
+  EXPECT_EQ(stats.json_report(), "{\n  \"has_profiling\": false\n}\n");
+}
+
+TEST(scene_stats, render_json_report)
+{
+  RenderStats stats;
+  stats.has_profiling = true;
+  stats.kernel = NamedNestedSampleStats("Total render time", 100);
+  stats.shaders.add(ustring("Glass \"B\"\n"), 200, 4);
+  stats.shader_evals.add(ustring("Glass \"B\"\n"), 100, 4);
+  stats.texture_lookups.add_entry(NamedSizeEntry("wood.png", 12));
+
+  const string json = stats.json_report();
+  EXPECT_EQ(json.find("{\n  \"has_profiling\": true,\n  \"kernel\":\n  {\n"), size_t(0));
+  EXPECT_NE(json.find("  \"shaders\": [\n"
+                      "    {\"name\": \"Glass \\\"B\\\"\\n\", \"time\": 0.200, "
+                      "\"eval_time\": 0.100, \"hits\": 4}\n"
+                      "  ],\n"),
+            string::npos);
+  EXPECT_NE(json.find("  \"objects\": [],\n"), string::npos);
+  EXPECT_NE(json.find("  \"textures\": [\n"
+                      "    {\"name\": \"wood.png\", \"lookups\": 12}\n"
+                      "  ]\n"
+                      "}\n"),
+            string::npos);
+}
+
+CCL_NAMESPACE_END
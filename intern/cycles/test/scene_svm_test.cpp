@@ -0,0 +1,239 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "device/device.h"
+
+#include "integrator/shader_eval.h"
+
+#include "scene/background.h"
+#include "scene/colorspace.h"
+#include "scene/scene.h"
+#include "scene/shader.h"
+#include "scene/shader_graph.h"
+#include "scene/shader_nodes.h"
+#include "scene/svm.h"
+
+#include "kernel/camera/projection.h"
+#include "kernel/svm/math_util.h"
+
+#include "util/progress.h"
+#include "util/stats.h"
+#include "util/time.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Math operation applied to the result of the previous operation. */
+struct MathOp {
+  NodeMathType type;
+  /* Input the previous result is connected to. */
+  int chain_input;
+  float values[3];
+};
+
+const MathOp math_ops[] = {
+    {NODE_MATH_MULTIPLY, 0, {0.0f, 1.7f, 0.0f}},
+    {NODE_MATH_ADD, 0, {0.0f, 0.25f, 0.0f}},
+    {NODE_MATH_SINE, 0, {0.0f, 0.0f, 0.0f}},
+    {NODE_MATH_SUBTRACT, 1, {1.5f, 0.0f, 0.0f}},
+    {NODE_MATH_MULTIPLY_ADD, 0, {0.0f, 0.5f, 0.1f}},
+    {NODE_MATH_POWER, 0, {0.0f, 1.3f, 0.0f}},
+    {NODE_MATH_WRAP, 0, {0.0f, 2.0f, 0.2f}},
+};
+const int num_math_ops = sizeof(math_ops) / sizeof(MathOp);
+
+}  // namespace
+
+class SVMTest : public testing::Test {
+ protected:
+  Stats stats;
+  Profiler profiler;
+  DeviceInfo device_info;
+  Device *device_cpu;
+  SceneParams scene_params;
+  Scene *scene;
+  Progress progress;
+
+  virtual void SetUp()
+  {
+    ColorSpaceManager::init_fallback_config();
+
+    device_cpu = Device::create(device_info, stats, profiler);
+    scene = new Scene(scene_params, device_cpu);
+  }
+
+  virtual void TearDown()
+  {
+    delete scene;
+    delete device_cpu;
+  }
+
+  /* Background shader with a strength computed by a chain of math nodes from the X component
+   * of the direction. */
+  Shader *add_math_chain_shader(const int num_nodes)
+  {
+    ShaderGraph *graph = new ShaderGraph();
+
+    GeometryNode *geometry = graph->create_node<GeometryNode>();
+    graph->add(geometry);
+    SeparateXYZNode *separate = graph->create_node<SeparateXYZNode>();
+    graph->add(separate);
+    graph->connect(geometry->output("Position"), separate->input("Vector"));
+
+    ShaderOutput *value_out = separate->output("X");
+    for (int i = 0; i < num_nodes; i++) {
+      const MathOp &op = math_ops[i % num_math_ops];
+      MathNode *math = graph->create_node<MathNode>();
+      math->set_math_type(op.type);
+      math->set_value1(op.values[0]);
+      math->set_value2(op.values[1]);
+      math->set_value3(op.values[2]);
+      graph->add(math);
+
+      const char *input_names[3] = {"Value1", "Value2", "Value3"};
+      graph->connect(value_out, math->input(input_names[op.chain_input]));
+      value_out = math->output("Value");
+    }
+
+    BackgroundNode *background = graph->create_node<BackgroundNode>();
+    background->set_color(one_float3());
+    graph->add(background);
+    graph->connect(value_out, background->input("Strength"));
+    graph->connect(background->output("Background"), graph->output()->input("Surface"));
+
+    Shader *shader = scene->create_node<Shader>();
+    shader->set_graph(graph);
+    shader->tag_update(scene);
+
+    scene->background->set_shader(shader);
+    scene->background->tag_update(scene);
+
+    return shader;
+  }
+
+  static float eval_math_chain(const float x, const int num_nodes)
+  {
+    float result = x;
+    for (int i = 0; i < num_nodes; i++) {
+      const MathOp &op = math_ops[i % num_math_ops];
+      float values[3] = {op.values[0], op.values[1], op.values[2]};
+      values[op.chain_input] = result;
+      result = svm_math(op.type, values[0], values[1], values[2]);
+    }
+    return result;
+  }
+
+  /* Evaluate the background shader for a grid of directions. */
+  void eval_background(const int width, const int height, vector<float> &pixels)
+  {
+    const int size = width * height;
+    pixels.resize(size * 3);
+
+    ShaderEval shader_eval(device_cpu, progress);
+    shader_eval.eval(
+        SHADER_EVAL_BACKGROUND,
+        size,
+        3,
+        [&](device_vector<KernelShaderEvalInput> &d_input) {
+          KernelShaderEvalInput *d_input_data = d_input.data();
+          for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+              KernelShaderEvalInput in;
+              in.object = OBJECT_NONE;
+              in.prim = PRIM_NONE;
+              in.u = (x + 0.5f) / width;
+              in.v = (y + 0.5f) / height;
+              d_input_data[x + y * width] = in;
+            }
+          }
+          return size;
+        },
+        [&](device_vector<float> &d_output) {
+          memcpy(pixels.data(), d_output.data(), sizeof(float) * size * 3);
+        });
+  }
+};
+
+TEST_F(SVMTest, math_chain_compile)
+{
+  const int num_nodes = 16;
+  Shader *shader = add_math_chain_shader(num_nodes);
+
+  SVMCompiler::Summary summary;
+  SVMCompiler compiler(scene);
+  array<int4> svm_nodes;
+  compiler.compile(shader, svm_nodes, 0, &summary);
+
+  /* All math nodes are fused into a single chain. */
+  int num_math_chains = 0;
+  int num_math_nodes = 0;
+  for (size_t i = 1; i < svm_nodes.size(); i++) {
+    if (svm_nodes[i].x == NODE_MATH_CHAIN) {
+      EXPECT_EQ(svm_nodes[i].y, num_nodes);
+      num_math_chains++;
+      i += svm_nodes[i].y;
+    }
+    else if (svm_nodes[i].x == NODE_MATH) {
+      num_math_nodes++;
+    }
+  }
+  EXPECT_EQ(num_math_chains, 1);
+  EXPECT_EQ(num_math_nodes, 0);
+
+  EXPECT_LT(summary.num_svm_nodes, summary.num_svm_nodes_unoptimized);
+}
+
+TEST_F(SVMTest, math_chain_eval)
+{
+  const int num_nodes = 16;
+  add_math_chain_shader(num_nodes);
+  scene->device_update(device_cpu, progress);
+
+  const int width = 32;
+  const int height = 16;
+  vector<float> pixels;
+  eval_background(width, height, pixels);
+
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const float3 D = equirectangular_to_direction((x + 0.5f) / width, (y + 0.5f) / height);
+      const float expected = eval_math_chain(D.x, num_nodes);
+      EXPECT_NEAR(pixels[(y * width + x) * 3], expected, 1e-4f);
+    }
+  }
+}
+
+/* Benchmark of evaluating a procedural shader with many math nodes, run with
+ * `--gtest_also_run_disabled_tests`. */
+TEST_F(SVMTest, DISABLED_benchmark_math_chain)
+{
+  const int num_nodes = 200;
+  Shader *shader = add_math_chain_shader(num_nodes);
+
+  SVMCompiler::Summary summary;
+  {
+    SVMCompiler compiler(scene);
+    array<int4> svm_nodes;
+    compiler.compile(shader, svm_nodes, 0, &summary);
+  }
+
+  scene->device_update(device_cpu, progress);
+
+  const int width = 1024;
+  const int height = 512;
+  vector<float> pixels;
+
+  const double start_time = time_dt();
+  eval_background(width, height, pixels);
+  const double time = time_dt() - start_time;
+
+  std::cout << "Shader with " << num_nodes << " math nodes: " << summary.num_svm_nodes
+            << " SVM nodes (" << summary.num_svm_nodes_unoptimized << " without fusion), "
+            << width * height << " evaluations in " << time << "s\n";
+}
+
+CCL_NAMESPACE_END
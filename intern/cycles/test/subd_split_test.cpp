@@ -0,0 +1,124 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "scene/mesh.h"
+
+#include "subd/dice.h"
+#include "subd/split.h"
+
+#include "util/time.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Create a mesh with a grid of resolution x resolution quads using linear subdivision. */
+static void create_subd_grid(Mesh &mesh, const int resolution, const float dicing_rate)
+{
+  mesh.set_subdivision_type(Mesh::SUBDIVISION_LINEAR);
+  mesh.set_subd_dicing_rate(dicing_rate);
+  mesh.set_subd_max_level(12);
+  mesh.set_subd_objecttoworld(transform_identity());
+
+  mesh.reserve_mesh((resolution + 1) * (resolution + 1), 0);
+  for (int y = 0; y <= resolution; y++) {
+    for (int x = 0; x <= resolution; x++) {
+      /* Gentle waves, so that edges get different tessellation rates. */
+      const float z = 0.5f * sinf(x * 0.3f) * cosf(y * 0.2f);
+      mesh.add_vertex(make_float3(x, y, z));
+    }
+  }
+
+  mesh.reserve_subd_faces(resolution * resolution, 0, resolution * resolution * 4);
+  for (int y = 0; y < resolution; y++) {
+    for (int x = 0; x < resolution; x++) {
+      const int v = y * (resolution + 1) + x;
+      const int corners[4] = {v, v + 1, v + resolution + 2, v + resolution + 1};
+      mesh.add_subd_face(corners, 4, 0, false);
+    }
+  }
+}
+
+static void tessellate(Mesh &mesh)
+{
+  DiagSplit dsplit(*mesh.get_subd_params());
+  mesh.tessellate(&dsplit);
+}
+
+TEST(subd_split, tessellate)
+{
+  const int resolution = 32;
+
+  Mesh mesh;
+  create_subd_grid(mesh, resolution, 0.25f);
+  const size_t num_control_verts = mesh.get_verts().size();
+
+  tessellate(mesh);
+
+  const size_t num_verts = mesh.get_verts().size();
+  const size_t num_triangles = mesh.num_triangles();
+
+  EXPECT_GT(num_verts, num_control_verts);
+  EXPECT_GT(num_triangles, resolution * resolution * 2);
+
+  /* All triangles must be filled in and reference diced vertices. */
+  const array<int> &triangles = mesh.get_triangles();
+  for (size_t i = 0; i < triangles.size(); i++) {
+    EXPECT_GE(triangles[i], num_control_verts);
+    EXPECT_LT(triangles[i], num_verts);
+  }
+
+  const array<int> &triangle_patch = mesh.get_triangle_patch();
+  for (size_t i = 0; i < num_triangles; i++) {
+    EXPECT_GE(triangle_patch[i], 0);
+  }
+}
+
+TEST(subd_split, deterministic)
+{
+  /* Enough faces for splitting and dicing to be distributed over multiple threads. */
+  const int resolution = 64;
+
+  Mesh mesh_a;
+  create_subd_grid(mesh_a, resolution, 0.5f);
+  tessellate(mesh_a);
+
+  Mesh mesh_b;
+  create_subd_grid(mesh_b, resolution, 0.5f);
+  tessellate(mesh_b);
+
+  ASSERT_EQ(mesh_a.get_verts().size(), mesh_b.get_verts().size());
+  ASSERT_EQ(mesh_a.num_triangles(), mesh_b.num_triangles());
+
+  const array<float3> &verts_a = mesh_a.get_verts();
+  const array<float3> &verts_b = mesh_b.get_verts();
+  for (size_t i = 0; i < verts_a.size(); i++) {
+    EXPECT_EQ(verts_a[i].x, verts_b[i].x);
+    EXPECT_EQ(verts_a[i].y, verts_b[i].y);
+    EXPECT_EQ(verts_a[i].z, verts_b[i].z);
+  }
+
+  const array<int> &triangles_a = mesh_a.get_triangles();
+  const array<int> &triangles_b = mesh_b.get_triangles();
+  for (size_t i = 0; i < triangles_a.size(); i++) {
+    EXPECT_EQ(triangles_a[i], triangles_b[i]);
+  }
+}
+
+/* Benchmark of dicing a large ocean-like surface with a fine dicing rate, as used for displaced
+ * water, run with `--gtest_also_run_disabled_tests`. */
+TEST(subd_split, DISABLED_benchmark_ocean)
+{
+  Mesh mesh;
+  create_subd_grid(mesh, 256, 0.1f);
+
+  const double start_time = time_dt();
+  tessellate(mesh);
+  const double time = time_dt() - start_time;
+
+  std::cout << "Tessellated " << mesh.get_num_subd_faces() << " faces into "
+            << mesh.num_triangles() << " triangles in " << time << "s\n";
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,62 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "util/half.h"
+
+CCL_NAMESPACE_BEGIN
+
+static int half_bits(half h)
+{
+  return (unsigned short)h;
+}
+
+TEST(util, float_to_half_image)
+{
+  /* Image textures truncate. */
+  EXPECT_EQ(half_bits(float_to_half_image(1.0f)), 0x3c00);
+  EXPECT_EQ(half_bits(float_to_half_image(nextafterf(1.0f + 1.0f / 1024.0f, 0.0f))), 0x3c00);
+  EXPECT_EQ(half_bits(float_to_half_image(-2.0f)), 0xc000);
+  EXPECT_EQ(half_bits(float_to_half_image(1e-6f)), 0);
+  EXPECT_EQ(half_bits(float_to_half_image(1e6f)), 0x7bff);
+}
+
+TEST(util, float_to_half_attribute)
+{
+  /* Exactly representable values. */
+  EXPECT_EQ(half_bits(float_to_half_attribute(0.0f)), 0);
+  EXPECT_EQ(half_bits(float_to_half_attribute(0.5f)), 0x3800);
+  EXPECT_EQ(half_bits(float_to_half_attribute(1.0f)), 0x3c00);
+  EXPECT_EQ(half_bits(float_to_half_attribute(-2.0f)), 0xc000);
+  EXPECT_EQ(half_bits(float_to_half_attribute(65504.0f)), 0x7bff);
+
+  /* Round to nearest, with ties to even. */
+  const float ulp = 1.0f / 1024.0f;
+  EXPECT_EQ(half_bits(float_to_half_attribute(1.0f + ulp * 0.4f)), 0x3c00);
+  EXPECT_EQ(half_bits(float_to_half_attribute(1.0f + ulp * 0.6f)), 0x3c01);
+  EXPECT_EQ(half_bits(float_to_half_attribute(1.0f + ulp * 0.5f)), 0x3c00);
+  EXPECT_EQ(half_bits(float_to_half_attribute(1.0f + ulp * 1.5f)), 0x3c02);
+
+  /* Rounding up carries into the exponent. */
+  EXPECT_EQ(half_bits(float_to_half_attribute(nextafterf(1.0f, 0.0f))), 0x3c00);
+
+  /* Clamp to the largest half, also when rounding up past it. */
+  EXPECT_EQ(half_bits(float_to_half_attribute(65520.0f)), 0x7bff);
+  EXPECT_EQ(half_bits(float_to_half_attribute(1e6f)), 0x7bff);
+  EXPECT_EQ(half_bits(float_to_half_attribute(-1e6f)), 0xfbff);
+
+  /* Denormals are flushed to zero. */
+  EXPECT_EQ(half_bits(float_to_half_attribute(1e-6f)), 0);
+  EXPECT_EQ(half_bits(float_to_half_attribute(-1e-6f)), 0x8000);
+
+  /* Round trip error is at most half a unit in the last place, which is 2^-11 below 1. */
+  for (int i = 0; i <= 1000; i++) {
+    const float f = i / 1000.0f;
+    const float error = fabsf(half_to_float_image(float_to_half_attribute(f)) - f);
+    EXPECT_LE(error, ulp / 4.0f);
+  }
+}
+
+CCL_NAMESPACE_END
@@ -36,6 +36,31 @@ void DebugFlags::CPU::reset()
 #undef CHECK_CPU_FLAGS
 
   bvh_layout = BVH_LAYOUT_AUTO;
+
+  out_of_core_budget = 0;
+  if (auto str = getenv("CYCLES_CPU_OUT_OF_CORE_BUDGET")) {
+    /* Budget is specified in megabytes. */
+    out_of_core_budget = size_t(atoll(str)) * 1024 * 1024;
+  }
+
+  out_of_core_directory = "/tmp";
+  if (auto str = getenv("CYCLES_CPU_OUT_OF_CORE_DIRECTORY")) {
+    out_of_core_directory = str;
+  }
+  else if (auto str = getenv("TMPDIR")) {
+    out_of_core_directory = str;
+  }
+
+  if (out_of_core_budget) {
+    VLOG_INFO << "Storing scene data out of core above "
+              << string_human_readable_size(out_of_core_budget) << " in "
+              << out_of_core_directory;
+  }
+
+  numa_pinning = (getenv("CYCLES_CPU_NUMA_PINNING") != NULL);
+  if (numa_pinning) {
+    VLOG_INFO << "Pinning render threads to NUMA nodes.";
+  }
 }
 
 DebugFlags::CUDA::CUDA()
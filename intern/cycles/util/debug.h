@@ -9,6 +9,8 @@
 
 #include "bvh/params.h"
 
+#include "util/string.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* Global storage for all sort of flags used to fine-tune behavior of particular
@@ -46,6 +48,18 @@ class DebugFlags {
      * CPUs and GPUs can be selected here instead.
      */
     BVHLayout bvh_layout = BVH_LAYOUT_AUTO;
+
+    /* Out-of-core storage of scene data.
+     *
+     * When the device memory usage exceeds the budget (in bytes), large scene arrays are stored
+     * in memory-mapped files in the given directory, so that the operating system can page them
+     * out under memory pressure. Zero budget disables out-of-core storage. */
+    size_t out_of_core_budget = 0;
+    string out_of_core_directory;
+
+    /* Pin render threads to NUMA nodes, with each node rendering and first touching its own part
+     * of the render buffer. By default threads are scheduled freely across nodes. */
+    bool numa_pinning = false;
   };
 
   /* Descriptor of CUDA feature-set to be used. */
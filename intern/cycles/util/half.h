@@ -96,6 +96,35 @@ ccl_device_inline half float_to_half_image(float f)
 #endif
 }
 
+#ifndef __KERNEL_GPU__
+/* Conversion to half float for attributes stored in half precision, decoded in the kernel with
+ * half_to_float_image. Like float_to_half_image, but rounding to nearest even instead of
+ * truncating, since for texture coordinates truncation shifts all values towards zero. */
+ccl_device_inline half float_to_half_attribute(float f)
+{
+  const uint u = __float_as_uint(f);
+  /* Sign bit, shifted to its position. */
+  uint sign_bit = u & 0x80000000;
+  sign_bit >>= 16;
+  /* Exponent. */
+  uint exponent_bits = u & 0x7f800000;
+  /* Non-sign bits. */
+  uint value_bits = u & 0x7fffffff;
+  /* Round to nearest even, a carry into the exponent gives the correct result as well. */
+  value_bits += 0x0fff + ((value_bits >> 13) & 1);
+  value_bits >>= 13;     /* Align mantissa on MSB. */
+  value_bits -= 0x1c000; /* Adjust bias. */
+  /* Flush-to-zero. */
+  value_bits = (exponent_bits < 0x38800000) ? 0 : value_bits;
+  /* Clamp-to-max, including values that were rounded up to infinity. */
+  value_bits = (exponent_bits > 0x47000000 || value_bits > 0x7bff) ? 0x7bff : value_bits;
+  /* Denormals-as-zero. */
+  value_bits = (exponent_bits == 0 ? 0 : value_bits);
+  /* Re-insert sign bit and return. */
+  return (value_bits | sign_bit);
+}
+#endif
+
 ccl_device_inline float half_to_float_image(half h)
 {
 #if defined(__KERNEL_METAL__)
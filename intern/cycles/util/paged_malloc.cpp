@@ -0,0 +1,152 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "util/paged_malloc.h"
+
+#include <atomic>
+
+#include "util/log.h"
+#include "util/map.h"
+#include "util/path.h"
+#include "util/string.h"
+#include "util/thread.h"
+#include "util/vector.h"
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/resource.h>
+#  include <unistd.h>
+#endif
+
+CCL_NAMESPACE_BEGIN
+
+/* All active file-backed allocations, used to tell them apart from regular allocations when
+ * freeing and for statistics. */
+static thread_mutex paged_allocations_mutex;
+static map<void *, size_t> paged_allocations;
+/* Number of entries in #paged_allocations, to skip the lock and lookup when out-of-core storage
+ * is not used, which is the common case for every freed device memory. */
+static std::atomic<size_t> paged_allocations_num = 0;
+
+void *util_paged_malloc(size_t size, const char *directory)
+{
+#ifdef _WIN32
+  (void)size;
+  (void)directory;
+  return NULL;
+#else
+  if (size == 0) {
+    return NULL;
+  }
+
+  /* Create a file which is unlinked right away, so that it is removed by the system once the
+   * memory is unmapped, also when the process is terminated. */
+  const string filepath_template = path_join(directory, "cycles_paged_XXXXXX");
+  vector<char> filepath(filepath_template.begin(), filepath_template.end());
+  filepath.push_back('\0');
+
+  const int fd = mkstemp(filepath.data());
+  if (fd == -1) {
+    VLOG_WARNING << "Failed to create file for paged memory in " << directory;
+    return NULL;
+  }
+  unlink(filepath.data());
+
+  if (ftruncate(fd, size) != 0) {
+    VLOG_WARNING << "Failed to resize file for paged memory to "
+                 << string_human_readable_size(size);
+    close(fd);
+    return NULL;
+  }
+
+  void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    return NULL;
+  }
+
+  /* Scene data is accessed incoherently during traversal and shading, avoid reading ahead pages
+   * which are unlikely to be used. */
+  madvise(ptr, size, MADV_RANDOM);
+
+  thread_scoped_lock lock(paged_allocations_mutex);
+  paged_allocations[ptr] = size;
+  paged_allocations_num++;
+
+  return ptr;
+#endif
+}
+
+bool util_paged_free(void *ptr)
+{
+  if (paged_allocations_num == 0) {
+    return false;
+  }
+
+  size_t size;
+  {
+    thread_scoped_lock lock(paged_allocations_mutex);
+    map<void *, size_t>::iterator it = paged_allocations.find(ptr);
+    if (it == paged_allocations.end()) {
+      return false;
+    }
+    size = it->second;
+    paged_allocations.erase(it);
+    paged_allocations_num--;
+  }
+
+#ifndef _WIN32
+  munmap(ptr, size);
+#else
+  (void)size;
+#endif
+
+  return true;
+}
+
+bool util_paged_is_allocated(const void *ptr)
+{
+  if (paged_allocations_num == 0) {
+    return false;
+  }
+
+  thread_scoped_lock lock(paged_allocations_mutex);
+  return paged_allocations.find(const_cast<void *>(ptr)) != paged_allocations.end();
+}
+
+PagedMemoryUsage util_paged_memory_usage()
+{
+  PagedMemoryUsage usage;
+
+  thread_scoped_lock lock(paged_allocations_mutex);
+  for (const pair<void *const, size_t> &allocation : paged_allocations) {
+    usage.num_allocations++;
+    usage.size += allocation.second;
+#ifdef __linux__
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    vector<unsigned char> pages((allocation.second + page_size - 1) / page_size);
+    if (mincore(allocation.first, allocation.second, pages.data()) == 0) {
+      for (const unsigned char page : pages) {
+        usage.resident_size += (page & 1) ? page_size : 0;
+      }
+    }
+#else
+    usage.resident_size += allocation.second;
+#endif
+  }
+  lock.unlock();
+
+#ifndef _WIN32
+  struct rusage rusage;
+  if (getrusage(RUSAGE_SELF, &rusage) == 0) {
+    usage.minor_page_faults = rusage.ru_minflt;
+    usage.major_page_faults = rusage.ru_majflt;
+  }
+#endif
+
+  return usage;
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,45 @@
+/* SPDX-FileCopyrightText: 2011-2022 Blender Foundation
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __UTIL_PAGED_MALLOC_H__
+#define __UTIL_PAGED_MALLOC_H__
+
+#include "util/types.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Allocate a block of memory which is backed by an anonymous temporary file in the given
+ * directory rather than by swap. The operating system pages it in on access and can evict it
+ * from physical memory under memory pressure, which allows scene data to exceed the available
+ * RAM. The block is aligned to the page size.
+ *
+ * Returns NULL if file-backed memory is not supported on this platform or the file could not
+ * be created, in which case the caller is expected to fall back to a regular allocation. */
+void *util_paged_malloc(size_t size, const char *directory);
+
+/* Free memory allocated by util_paged_malloc.
+ * Returns false if the pointer was not allocated by util_paged_malloc, so that callers which
+ * mix paged and regular allocations can free the latter themselves. */
+bool util_paged_free(void *ptr);
+
+/* Test whether the pointer was allocated by util_paged_malloc. */
+bool util_paged_is_allocated(const void *ptr);
+
+/* Usage of file-backed memory. */
+struct PagedMemoryUsage {
+  /* Number and total size of the file-backed allocations. */
+  size_t num_allocations = 0;
+  size_t size = 0;
+  /* Part of the file-backed allocations which is currently resident in physical memory. */
+  size_t resident_size = 0;
+  /* Page faults of the whole process which were resolved without and with reading from disk. */
+  uint64_t minor_page_faults = 0;
+  uint64_t major_page_faults = 0;
+};
+
+PagedMemoryUsage util_paged_memory_usage();
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_PAGED_MALLOC_H__ */
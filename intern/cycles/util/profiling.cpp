@@ -35,6 +35,9 @@ void Profiler::run()
 
       if (cur_shader >= 0 && cur_shader < shader_samples.size()) {
         shader_samples[cur_shader]++;
+        if (cur_event == PROFILING_SHADE_SURFACE_EVAL || cur_event == PROFILING_SHADE_LIGHT_EVAL) {
+          shader_eval_samples[cur_shader]++;
+        }
       }
 
       if (cur_object >= 0 && cur_object < object_samples.size()) {
@@ -52,7 +55,7 @@ void Profiler::run()
   }
 }
 
-void Profiler::reset(int num_shaders, int num_objects)
+void Profiler::reset(int num_shaders, int num_objects, int num_textures)
 {
   bool running = (worker != NULL);
   if (running) {
@@ -62,9 +65,15 @@ void Profiler::reset(int num_shaders, int num_objects)
   /* Resize and clear the accumulation vectors. */
   shader_hits.assign(num_shaders, 0);
   object_hits.assign(num_objects, 0);
+  texture_hits.assign(num_textures, 0);
+
+  event_rays.assign(PROFILING_NUM_EVENTS, 0);
+  event_bvh_nodes.assign(PROFILING_NUM_EVENTS, 0);
+  event_bvh_prims.assign(PROFILING_NUM_EVENTS, 0);
 
   event_samples.assign(PROFILING_NUM_EVENTS, 0);
   shader_samples.assign(num_shaders, 0);
+  shader_eval_samples.assign(num_shaders, 0);
   object_samples.assign(num_objects, 0);
 
   if (running) {
@@ -101,6 +110,10 @@ void Profiler::add_state(ProfilingState *state)
   /* Resize thread-local hit counters. */
   state->shader_hits.assign(shader_hits.size(), 0);
   state->object_hits.assign(object_hits.size(), 0);
+  state->texture_hits.assign(texture_hits.size(), 0);
+  std::fill_n(state->event_rays, PROFILING_NUM_EVENTS, 0);
+  std::fill_n(state->event_bvh_nodes, PROFILING_NUM_EVENTS, 0);
+  std::fill_n(state->event_bvh_prims, PROFILING_NUM_EVENTS, 0);
 
   /* Initialize the state. */
   state->event = PROFILING_UNKNOWN;
@@ -127,6 +140,17 @@ void Profiler::remove_state(ProfilingState *state)
   for (int i = 0; i < object_hits.size(); i++) {
     object_hits[i] += state->object_hits[i];
   }
+
+  assert(texture_hits.size() == state->texture_hits.size());
+  for (int i = 0; i < texture_hits.size(); i++) {
+    texture_hits[i] += state->texture_hits[i];
+  }
+
+  for (int i = 0; i < PROFILING_NUM_EVENTS; i++) {
+    event_rays[i] += state->event_rays[i];
+    event_bvh_nodes[i] += state->event_bvh_nodes[i];
+    event_bvh_prims[i] += state->event_bvh_prims[i];
+  }
 }
 
 uint64_t Profiler::get_event(ProfilingEvent event)
@@ -157,6 +181,37 @@ bool Profiler::get_object(int object, uint64_t &samples, uint64_t &hits)
   return true;
 }
 
+bool Profiler::get_rays(ProfilingEvent event,
+                        uint64_t &rays,
+                        uint64_t &bvh_nodes,
+                        uint64_t &bvh_prims)
+{
+  assert(worker == NULL);
+  if (event_rays[event] == 0) {
+    return false;
+  }
+  rays = event_rays[event];
+  bvh_nodes = event_bvh_nodes[event];
+  bvh_prims = event_bvh_prims[event];
+  return true;
+}
+
+uint64_t Profiler::get_shader_eval(int shader)
+{
+  assert(worker == NULL);
+  return shader_eval_samples[shader];
+}
+
+bool Profiler::get_texture(int texture, uint64_t &hits)
+{
+  assert(worker == NULL);
+  if (texture >= texture_hits.size() || texture_hits[texture] == 0) {
+    return false;
+  }
+  hits = texture_hits[texture];
+  return true;
+}
+
 bool Profiler::active() const
 {
   return (worker != nullptr);
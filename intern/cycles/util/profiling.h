@@ -67,6 +67,16 @@ struct ProfilingState {
 
   vector<uint64_t> shader_hits;
   vector<uint64_t> object_hits;
+  vector<uint64_t> texture_hits;
+
+  /* Number of rays traced while in each event, and the BVH nodes and primitives that were
+   * tested for them. Node and primitive tests are only counted by the BVH2 traversal, the
+   * running totals are attributed to events by ProfilingRayHelper. */
+  uint64_t event_rays[PROFILING_NUM_EVENTS] = {0};
+  uint64_t event_bvh_nodes[PROFILING_NUM_EVENTS] = {0};
+  uint64_t event_bvh_prims[PROFILING_NUM_EVENTS] = {0};
+  uint64_t bvh_nodes = 0;
+  uint64_t bvh_prims = 0;
 };
 
 class Profiler {
@@ -74,7 +84,7 @@ class Profiler {
   Profiler();
   ~Profiler();
 
-  void reset(int num_shaders, int num_objects);
+  void reset(int num_shaders, int num_objects, int num_textures = 0);
 
   void start();
   void stop();
@@ -85,6 +95,9 @@ class Profiler {
   uint64_t get_event(ProfilingEvent event);
   bool get_shader(int shader, uint64_t &samples, uint64_t &hits);
   bool get_object(int object, uint64_t &samples, uint64_t &hits);
+  bool get_rays(ProfilingEvent event, uint64_t &rays, uint64_t &bvh_nodes, uint64_t &bvh_prims);
+  uint64_t get_shader_eval(int shader);
+  bool get_texture(int texture, uint64_t &hits);
 
   bool active() const;
 
@@ -97,6 +110,8 @@ class Profiler {
   vector<uint64_t> event_samples;
   vector<uint64_t> shader_samples;
   vector<uint64_t> object_samples;
+  /* Samples of each shader spent in the surface and light shader evaluation events. */
+  vector<uint64_t> shader_eval_samples;
 
   /* Tracks the total amounts every object/shader was hit.
    * Used to evaluate relative cost, written by the render thread.
@@ -105,6 +120,14 @@ class Profiler {
   vector<uint64_t> shader_hits;
   vector<uint64_t> object_hits;
 
+  /* Tracks the number of lookups of every image texture, indexed by texture slot. */
+  vector<uint64_t> texture_hits;
+
+  /* Number of rays traced and BVH nodes and primitives tested per event. */
+  vector<uint64_t> event_rays;
+  vector<uint64_t> event_bvh_nodes;
+  vector<uint64_t> event_bvh_prims;
+
   volatile bool do_stop_worker;
   thread *worker;
 
@@ -167,6 +190,56 @@ class ProfilingWithShaderHelper : public ProfilingHelper {
   }
 };
 
+/* Counts a ray traced in the current event, along with the BVH tests done for it until the
+ * helper goes out of scope. Does nothing when the profiler is not active. */
+class ProfilingRayHelper {
+ public:
+  ProfilingRayHelper(ProfilingState *state) : state(state->active ? state : nullptr)
+  {
+    if (this->state) {
+      event = state->event;
+      bvh_nodes = state->bvh_nodes;
+      bvh_prims = state->bvh_prims;
+    }
+  }
+
+  ~ProfilingRayHelper()
+  {
+    if (state && event < PROFILING_NUM_EVENTS) {
+      state->event_rays[event]++;
+      state->event_bvh_nodes[event] += state->bvh_nodes - bvh_nodes;
+      state->event_bvh_prims[event] += state->bvh_prims - bvh_prims;
+    }
+  }
+
+ protected:
+  ProfilingState *state;
+  uint32_t event = PROFILING_NUM_EVENTS;
+  uint64_t bvh_nodes = 0;
+  uint64_t bvh_prims = 0;
+};
+
+inline void profiling_bvh_node(ProfilingState *state)
+{
+  if (state->active) {
+    state->bvh_nodes++;
+  }
+}
+
+inline void profiling_bvh_primitive(ProfilingState *state)
+{
+  if (state->active) {
+    state->bvh_prims++;
+  }
+}
+
+inline void profiling_texture_lookup(ProfilingState *state, int texture)
+{
+  if (state->active && texture >= 0 && texture < state->texture_hits.size()) {
+    state->texture_hits[texture]++;
+  }
+}
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_PROFILING_H__ */
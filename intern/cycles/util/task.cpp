@@ -3,6 +3,9 @@
  * SPDX-License-Identifier: Apache-2.0 */
 
 #include "util/task.h"
+
+#include <atomic>
+
 #include "util/foreach.h"
 #include "util/log.h"
 #include "util/system.h"
@@ -101,6 +104,112 @@ int TaskScheduler::max_concurrency()
   return (users > 0) ? active_num_threads : tbb::this_task_arena::max_concurrency();
 }
 
+/* NUMA Task Arenas */
+
+NumaTaskArenas::NumaTaskArenas(const int num_threads)
+{
+#ifdef WITH_TBB_NUMA
+  const std::vector<tbb::numa_node_id> nodes = tbb::info::numa_nodes();
+
+  if (nodes.size() > 1 && num_threads >= nodes.size()) {
+    int total_concurrency = 0;
+    for (const tbb::numa_node_id node : nodes) {
+      total_concurrency += tbb::info::default_concurrency(node);
+    }
+
+    /* Divide threads proportionally to the number of cores per node. */
+    int concurrency = 0;
+    int thread_offset = 0;
+    for (const tbb::numa_node_id node : nodes) {
+      concurrency += tbb::info::default_concurrency(node);
+      const int thread_end = int(int64_t(num_threads) * concurrency / total_concurrency);
+      const int node_num_threads = thread_end - thread_offset;
+      if (node_num_threads == 0) {
+        continue;
+      }
+
+      /* No slots reserved for the calling thread, it only waits for the work to finish. */
+      arenas.push_back(make_unique<tbb::task_arena>(
+          tbb::task_arena::constraints(node, node_num_threads), 0));
+      arena_num_threads.push_back(node_num_threads);
+      arena_thread_offset.push_back(thread_offset);
+
+      VLOG_INFO << "NUMA node " << node << " arena with " << node_num_threads << " threads.";
+
+      thread_offset = thread_end;
+    }
+
+    return;
+  }
+#endif
+
+  arenas.push_back(make_unique<tbb::task_arena>(num_threads));
+  arena_num_threads.push_back(num_threads);
+  arena_thread_offset.push_back(0);
+}
+
+void NumaTaskArenas::range(const int i,
+                           const int64_t size,
+                           int64_t *r_begin,
+                           int64_t *r_end) const
+{
+  const int last = arenas.size() - 1;
+  const int64_t num_threads = arena_thread_offset[last] + arena_num_threads[last];
+  const int64_t thread_begin = arena_thread_offset[i];
+  const int64_t thread_end = thread_begin + arena_num_threads[i];
+
+  *r_begin = size * thread_begin / num_threads;
+  *r_end = size * thread_end / num_threads;
+}
+
+void NumaTaskArenas::execute(const function<void(int)> &func)
+{
+  if (arenas.size() == 1) {
+    arenas[0]->execute([&]() { func(0); });
+    return;
+  }
+
+  /* Start work in all arenas before waiting for any of them. */
+  vector<tbb::task_group> task_groups(arenas.size());
+  for (int i = 0; i < arenas.size(); i++) {
+    arenas[i]->execute([&, i]() { task_groups[i].run([&, i]() { func(i); }); });
+  }
+  for (int i = 0; i < arenas.size(); i++) {
+    arenas[i]->execute([&, i]() { task_groups[i].wait(); });
+  }
+}
+
+void NumaTaskArenas::parallel_for(const int64_t size,
+                                  const int64_t chunk_size,
+                                  const function<void(int, int64_t, int64_t)> &func)
+{
+  const int num_arenas = arenas.size();
+  const int64_t num_chunks = (size + chunk_size - 1) / chunk_size;
+
+  /* Next chunk to take and end of the chunks assigned to each arena. */
+  vector<std::atomic<int64_t>> next_chunk(num_arenas);
+  vector<int64_t> end_chunk(num_arenas);
+  for (int i = 0; i < num_arenas; i++) {
+    int64_t begin;
+    range(i, num_chunks, &begin, &end_chunk[i]);
+    next_chunk[i] = begin;
+  }
+
+  execute([&](const int arena_index) {
+    /* One task per thread, each taking chunks until none are left in any arena. */
+    tbb::parallel_for(0, num_threads(arena_index), [&](int /*thread*/) {
+      for (int i = 0; i < num_arenas; i++) {
+        const int victim = (arena_index + i) % num_arenas;
+        for (int64_t chunk = next_chunk[victim]++; chunk < end_chunk[victim];
+             chunk = next_chunk[victim]++)
+        {
+          func(arena_index, chunk * chunk_size, std::min((chunk + 1) * chunk_size, size));
+        }
+      }
+    });
+  });
+}
+
 /* Dedicated Task Pool */
 
 DedicatedTaskPool::DedicatedTaskPool()
@@ -9,6 +9,7 @@
 #include "util/string.h"
 #include "util/tbb.h"
 #include "util/thread.h"
+#include "util/unique_ptr.h"
 #include "util/vector.h"
 
 CCL_NAMESPACE_BEGIN
@@ -89,6 +90,52 @@ class TaskScheduler {
 #endif
 };
 
+/* NUMA Task Arenas
+ *
+ * Task arenas with threads pinned to NUMA nodes. The given number of threads is divided between
+ * the nodes, proportional to the number of cores of each node. When NUMA information is not
+ * available or there is only one node, there is a single arena without constraints. */
+
+class NumaTaskArenas {
+ public:
+  explicit NumaTaskArenas(int num_threads);
+
+  int size() const
+  {
+    return arenas.size();
+  }
+
+  /* Number of threads of an arena, and offset of its threads when indexing per-thread data for
+   * all arenas. Threads of arena i can use thread_offset(i) + current_thread_index() as index. */
+  int num_threads(const int i) const
+  {
+    return arena_num_threads[i];
+  }
+  int thread_offset(const int i) const
+  {
+    return arena_thread_offset[i];
+  }
+
+  /* Part of the range [0, size) assigned to an arena, proportional to its number of threads. */
+  void range(int i, int64_t size, int64_t *r_begin, int64_t *r_end) const;
+
+  /* Run function in all arenas at the same time with the arena index as argument, and wait for
+   * all of them to finish. */
+  void execute(const function<void(int)> &func);
+
+  /* Run function on chunks of the range [0, size), with the index of the arena running it and
+   * the begin and end of the chunk as arguments. Threads first take chunks from the part of the
+   * range assigned to their own arena, and then steal the remaining chunks of other arenas. */
+  void parallel_for(int64_t size,
+                    int64_t chunk_size,
+                    const function<void(int, int64_t, int64_t)> &func);
+
+ protected:
+  vector<unique_ptr<tbb::task_arena>> arenas;
+  vector<int> arena_num_threads;
+  vector<int> arena_thread_offset;
+};
+
 /* Dedicated Task Pool
  *
  * Like a TaskPool, but will launch one dedicated thread to execute all tasks.
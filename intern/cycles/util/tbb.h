@@ -21,6 +21,10 @@
 #  include <tbb/global_control.h>
 #endif
 
+#ifdef WITH_TBB_NUMA
+#  include <tbb/info.h>
+#endif
+
 CCL_NAMESPACE_BEGIN
 
 using tbb::blocked_range;
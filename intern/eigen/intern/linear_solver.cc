@@ -22,6 +22,8 @@
 
 typedef Eigen::SparseMatrix<double, Eigen::ColMajor> EigenSparseMatrix;
 typedef Eigen::SparseLU<EigenSparseMatrix> EigenSparseLU;
+typedef Eigen::ConjugateGradient<EigenSparseMatrix, Eigen::Lower | Eigen::Upper>
+    EigenConjugateGradient;
 typedef Eigen::VectorXd EigenVectorX;
 typedef Eigen::Triplet<double> EigenTriplet;
 
@@ -64,6 +66,9 @@ struct LinearSolver {
     m = 0;
     n = 0;
     sparseLU = NULL;
+    conjugate_gradient = NULL;
+    use_conjugate_gradient = false;
+    tolerance = 0.0;
     num_variables = num_variables_;
     num_rhs = num_rhs_;
     num_rows = num_rows_;
@@ -75,6 +80,7 @@ struct LinearSolver {
   ~LinearSolver()
   {
     delete sparseLU;
+    delete conjugate_gradient;
   }
 
   State state;
@@ -89,6 +95,10 @@ struct LinearSolver {
   std::vector<EigenVectorX> x;
 
   EigenSparseLU *sparseLU;
+  EigenConjugateGradient *conjugate_gradient;
+
+  bool use_conjugate_gradient;
+  double tolerance;
 
   int num_variables;
   std::vector<Variable> variable;
@@ -114,6 +124,14 @@ void EIG_linear_solver_delete(LinearSolver *solver)
   delete solver;
 }
 
+void EIG_linear_solver_use_conjugate_gradient(LinearSolver *solver, double tolerance)
+{
+  assert(solver->least_squares);
+  assert(solver->state == LinearSolver::STATE_VARIABLES_CONSTRUCT);
+  solver->use_conjugate_gradient = true;
+  solver->tolerance = tolerance;
+}
+
 /* Variables */
 
 void EIG_linear_solver_variable_set(LinearSolver *solver, int rhs, int index, double value)
@@ -262,6 +280,18 @@ void EIG_linear_solver_right_hand_side_add(LinearSolver *solver, int rhs, int in
 
 /* Solve */
 
+static bool linear_solver_factorize(LinearSolver *solver)
+{
+  EigenSparseMatrix &M = (solver->least_squares) ? solver->MtM : solver->M;
+
+  /* perform sparse LU factorization */
+  EigenSparseLU *sparseLU = new EigenSparseLU();
+  solver->sparseLU = sparseLU;
+
+  sparseLU->compute(M);
+  return (sparseLU->info() == Eigen::Success);
+}
+
 bool EIG_linear_solver_solve(LinearSolver *solver)
 {
   /* nothing to solve, perhaps all variables were locked */
@@ -288,12 +318,19 @@ bool EIG_linear_solver_solve(LinearSolver *solver)
     EigenSparseMatrix &M = (solver->least_squares) ? solver->MtM : solver->M;
     M.makeCompressed();
 
-    /* perform sparse LU factorization */
-    EigenSparseLU *sparseLU = new EigenSparseLU();
-    solver->sparseLU = sparseLU;
+    if (solver->use_conjugate_gradient) {
+      /* AtA is symmetric positive definite, only needs a diagonal preconditioner instead of a
+       * factorization with fill-in. */
+      EigenConjugateGradient *conjugate_gradient = new EigenConjugateGradient();
+      solver->conjugate_gradient = conjugate_gradient;
 
-    sparseLU->compute(M);
-    result = (sparseLU->info() == Eigen::Success);
+      conjugate_gradient->setTolerance(solver->tolerance);
+      conjugate_gradient->compute(M);
+      result = (conjugate_gradient->info() == Eigen::Success);
+    }
+    else {
+      result = linear_solver_factorize(solver);
+    }
 
     solver->state = LinearSolver::STATE_MATRIX_SOLVED;
   }
@@ -319,6 +356,26 @@ bool EIG_linear_solver_solve(LinearSolver *solver)
       /* solve */
       if (solver->least_squares) {
         EigenVectorX Mtb = solver->M.transpose() * b;
+
+        if (solver->conjugate_gradient) {
+          /* start from the previous solution, repeated solves only change b a little */
+          EigenVectorX x = solver->conjugate_gradient->solveWithGuess(Mtb, solver->x[rhs]);
+
+          if (solver->conjugate_gradient->info() == Eigen::Success) {
+            solver->x[rhs] = x;
+            continue;
+          }
+
+          /* fall back to the factorization when not converging */
+          delete solver->conjugate_gradient;
+          solver->conjugate_gradient = NULL;
+
+          if (!linear_solver_factorize(solver)) {
+            result = false;
+            break;
+          }
+        }
+
         solver->x[rhs] = solver->sparseLU->solve(Mtb);
       }
       else {
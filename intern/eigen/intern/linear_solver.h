@@ -28,6 +28,13 @@ LinearSolver *EIG_linear_least_squares_solver_new(int num_rows,
 
 void EIG_linear_solver_delete(LinearSolver *solver);
 
+/* Solve AtAx = Atb with preconditioned conjugate gradients instead of a sparse LU factorization,
+ * which uses less memory and time for large systems. Falls back to the factorization when the
+ * iterations don't converge to the relative tolerance. Must be called before matrix
+ * construction, for least squares solvers only. */
+
+void EIG_linear_solver_use_conjugate_gradient(LinearSolver *solver, double tolerance);
+
 /* Variables (x). Any locking must be done before matrix construction. */
 
 void EIG_linear_solver_variable_set(LinearSolver *solver, int rhs, int index, double value);
@@ -9,6 +9,7 @@
  * \brief Low-level operations for curves.
  */
 
+#include "BLI_bit_vector.hh"
 #include "BLI_bounds_types.hh"
 #include "BLI_generic_virtual_array.hh"
 #include "BLI_implicit_sharing_ptr.hh"
@@ -115,6 +116,14 @@ class CurvesGeometryRuntime {
   /** Normal direction vectors for each evaluated point. */
   mutable SharedCache<Vector<float3>> evaluated_normal_cache;
 
+  /**
+   * Curves with changed positions whose evaluated positions or tangents have not been updated
+   * yet, see #CurvesGeometry::tag_positions_changed. The cached data of the other curves is still
+   * valid. Empty when the whole cache is computed again.
+   */
+  mutable BitVector<> evaluated_position_dirty_curves;
+  mutable BitVector<> evaluated_tangent_dirty_curves;
+
   /** Stores weak references to material data blocks. */
   std::unique_ptr<bake::BakeMaterialsList> bake_materials;
 };
@@ -366,6 +375,12 @@ class CurvesGeometry : public ::CurvesGeometry {
 
   /** Call after deforming the position attribute. */
   void tag_positions_changed();
+  /**
+   * Call after deforming the positions of only some curves. Evaluated positions and tangents that
+   * are already computed are updated for those curves only when they are needed again, instead of
+   * for all curves.
+   */
+  void tag_positions_changed(const IndexMask &curves);
   /**
    * Call after any operation that changes the topology
    * (number of points, evaluated points, or the total count).
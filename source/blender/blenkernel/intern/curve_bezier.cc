@@ -8,6 +8,7 @@
 
 #include <algorithm>
 
+#include "BLI_simd.hh"
 #include "BLI_task.hh"
 
 #include "BKE_attribute_math.hh"
@@ -208,12 +209,22 @@ void calculate_auto_handles(const bool cyclic,
                           positions_right.last());
 }
 
+/** The first point of a segment and its forward differences for evaluating `size` points. */
+template<typename T> struct ForwardDifferences {
+  T q0;
+  T q1;
+  T q2;
+  T q3;
+};
+
 template<typename T>
-void evaluate_segment_ex(
-    const T &point_0, const T &point_1, const T &point_2, const T &point_3, MutableSpan<T> result)
+static ForwardDifferences<T> calculate_forward_differences(const T &point_0,
+                                                           const T &point_1,
+                                                           const T &point_2,
+                                                           const T &point_3,
+                                                           const int64_t size)
 {
-  BLI_assert(result.size() > 0);
-  const float inv_len = 1.0f / float(result.size());
+  const float inv_len = 1.0f / float(size);
   const float inv_len_squared = inv_len * inv_len;
   const float inv_len_cubed = inv_len_squared * inv_len;
 
@@ -221,15 +232,21 @@ void evaluate_segment_ex(
   const T rt2 = 3.0f * (point_0 - 2.0f * point_1 + point_2) * inv_len_squared;
   const T rt3 = (point_3 - point_0 + 3.0f * (point_1 - point_2)) * inv_len_cubed;
 
-  T q0 = point_0;
-  T q1 = rt1 + rt2 + rt3;
-  T q2 = 2.0f * rt2 + 6.0f * rt3;
-  T q3 = 6.0f * rt3;
+  return {point_0, rt1 + rt2 + rt3, 2.0f * rt2 + 6.0f * rt3, 6.0f * rt3};
+}
+
+template<typename T>
+void evaluate_segment_ex(
+    const T &point_0, const T &point_1, const T &point_2, const T &point_3, MutableSpan<T> result)
+{
+  BLI_assert(result.size() > 0);
+  ForwardDifferences<T> q = calculate_forward_differences(
+      point_0, point_1, point_2, point_3, result.size());
   for (const int i : result.index_range()) {
-    result[i] = q0;
-    q0 += q1;
-    q1 += q2;
-    q2 += q3;
+    result[i] = q.q0;
+    q.q0 += q.q1;
+    q.q1 += q.q2;
+    q.q2 += q.q3;
   }
 }
 template<>
@@ -239,7 +256,30 @@ void evaluate_segment(const float3 &point_0,
                       const float3 &point_3,
                       MutableSpan<float3> result)
 {
+#if BLI_HAVE_SSE2
+  /* Same as #evaluate_segment_ex, but with all components of a difference in one register. The
+   * additions are the same per component, so the result is identical. */
+  BLI_assert(result.size() > 0);
+  const ForwardDifferences<float3> q = calculate_forward_differences(
+      point_0, point_1, point_2, point_3, result.size());
+  __m128 q0 = _mm_setr_ps(q.q0.x, q.q0.y, q.q0.z, 0.0f);
+  __m128 q1 = _mm_setr_ps(q.q1.x, q.q1.y, q.q1.z, 0.0f);
+  __m128 q2 = _mm_setr_ps(q.q2.x, q.q2.y, q.q2.z, 0.0f);
+  const __m128 q3 = _mm_setr_ps(q.q3.x, q.q3.y, q.q3.z, 0.0f);
+  const int64_t last = result.size() - 1;
+  for (int64_t i = 0; i < last; i++) {
+    /* Also writes the first component of the next point, it is overwritten in the next step. */
+    _mm_storeu_ps(&result[i].x, q0);
+    q0 = _mm_add_ps(q0, q1);
+    q1 = _mm_add_ps(q1, q2);
+    q2 = _mm_add_ps(q2, q3);
+  }
+  float last_point[4];
+  _mm_storeu_ps(last_point, q0);
+  result[last] = float3(last_point);
+#else
   evaluate_segment_ex<float3>(point_0, point_1, point_2, point_3, result);
+#endif
 }
 template<>
 void evaluate_segment(const float2 &point_0,
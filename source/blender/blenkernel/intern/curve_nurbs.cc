@@ -198,9 +198,13 @@ static void interpolate_to_evaluated(const BasisCache &basis_cache,
   threading::parallel_for(dst.index_range(), 128, [&](const IndexRange range) {
     for (const int i : range) {
       Span<float> point_weights = basis_cache.weights.as_span().slice(i * order, order);
+      /* Wrap around for cyclic curves without a division for every control point. */
+      int point_index = basis_cache.start_indices[i] % src.size();
       for (const int j : point_weights.index_range()) {
-        const int point_index = (basis_cache.start_indices[i] + j) % src.size();
         mixer.mix_in(i, src[point_index], point_weights[j]);
+        if (++point_index == src.size()) {
+          point_index = 0;
+        }
       }
     }
     mixer.finalize(range);
@@ -220,10 +224,13 @@ static void interpolate_to_evaluated_rational(const BasisCache &basis_cache,
     for (const int i : range) {
       Span<float> point_weights = basis_cache.weights.as_span().slice(i * order, order);
 
+      int point_index = basis_cache.start_indices[i] % src.size();
       for (const int j : point_weights.index_range()) {
-        const int point_index = (basis_cache.start_indices[i] + j) % src.size();
         const float weight = point_weights[j] * control_weights[point_index];
         mixer.mix_in(i, src[point_index], weight);
+        if (++point_index == src.size()) {
+          point_index = 0;
+        }
       }
     }
     mixer.finalize(range);
@@ -116,6 +116,8 @@ CurvesGeometry::CurvesGeometry(const CurvesGeometry &other)
                             other.runtime->evaluated_length_cache,
                             other.runtime->evaluated_tangent_cache,
                             other.runtime->evaluated_normal_cache,
+                            other.runtime->evaluated_position_dirty_curves,
+                            other.runtime->evaluated_tangent_dirty_curves,
                             {}});
 
   if (other.runtime->bake_materials) {
@@ -654,138 +656,174 @@ void CurvesGeometry::ensure_nurbs_basis_cache() const
   });
 }
 
+/**
+ * Evaluate the positions of the selected curves. The evaluated offsets and NURBS basis cache must
+ * be computed already.
+ */
+static void evaluate_positions(const CurvesGeometry &curves,
+                               const IndexMask &curve_selection,
+                               MutableSpan<float3> evaluated_positions)
+{
+  const OffsetIndices<int> points_by_curve = curves.points_by_curve();
+  const OffsetIndices<int> evaluated_points_by_curve = curves.evaluated_points_by_curve();
+  const Span<float3> positions = curves.positions();
+
+  auto evaluate_catmull = [&](const IndexMask &selection) {
+    const VArray<bool> cyclic = curves.cyclic();
+    const VArray<int> resolution = curves.resolution();
+    selection.foreach_index(GrainSize(128), [&](const int curve_index) {
+      const IndexRange points = points_by_curve[curve_index];
+      const IndexRange evaluated_points = evaluated_points_by_curve[curve_index];
+      curves::catmull_rom::interpolate_to_evaluated(positions.slice(points),
+                                                    cyclic[curve_index],
+                                                    resolution[curve_index],
+                                                    evaluated_positions.slice(evaluated_points));
+    });
+  };
+  auto evaluate_poly = [&](const IndexMask &selection) {
+    array_utils::copy_group_to_group(
+        points_by_curve, evaluated_points_by_curve, selection, positions, evaluated_positions);
+  };
+  auto evaluate_bezier = [&](const IndexMask &selection) {
+    const Span<float3> handle_positions_left = curves.handle_positions_left();
+    const Span<float3> handle_positions_right = curves.handle_positions_right();
+    if (handle_positions_left.is_empty() || handle_positions_right.is_empty()) {
+      curves::fill_points(evaluated_points_by_curve, selection, float3(0), evaluated_positions);
+      return;
+    }
+    const Span<int> all_bezier_offsets =
+        curves.runtime->evaluated_offsets_cache.data().all_bezier_offsets;
+    selection.foreach_index(GrainSize(128), [&](const int curve_index) {
+      const IndexRange points = points_by_curve[curve_index];
+      const IndexRange evaluated_points = evaluated_points_by_curve[curve_index];
+      const IndexRange offsets = curves::per_curve_point_offsets_range(points, curve_index);
+      curves::bezier::calculate_evaluated_positions(positions.slice(points),
+                                                    handle_positions_left.slice(points),
+                                                    handle_positions_right.slice(points),
+                                                    all_bezier_offsets.slice(offsets),
+                                                    evaluated_positions.slice(evaluated_points));
+    });
+  };
+  auto evaluate_nurbs = [&](const IndexMask &selection) {
+    const VArray<int8_t> nurbs_orders = curves.nurbs_orders();
+    const Span<float> nurbs_weights = curves.nurbs_weights();
+    const Span<curves::nurbs::BasisCache> nurbs_basis_cache =
+        curves.runtime->nurbs_basis_cache.data();
+    selection.foreach_index(GrainSize(128), [&](const int curve_index) {
+      const IndexRange points = points_by_curve[curve_index];
+      const IndexRange evaluated_points = evaluated_points_by_curve[curve_index];
+      curves::nurbs::interpolate_to_evaluated(nurbs_basis_cache[curve_index],
+                                              nurbs_orders[curve_index],
+                                              nurbs_weights.slice_safe(points),
+                                              positions.slice(points),
+                                              evaluated_positions.slice(evaluated_points));
+    });
+  };
+  curves::foreach_curve_by_type(curves.curve_types(),
+                                curves.curve_type_counts(),
+                                curve_selection,
+                                evaluate_catmull,
+                                evaluate_poly,
+                                evaluate_bezier,
+                                evaluate_nurbs);
+}
+
 Span<float3> CurvesGeometry::evaluated_positions() const
 {
   const CurvesGeometryRuntime &runtime = *this->runtime;
   if (this->is_single_type(CURVE_TYPE_POLY)) {
-    runtime.evaluated_position_cache.ensure(
-        [&](Vector<float3> &r_data) { r_data.clear_and_shrink(); });
+    runtime.evaluated_position_cache.ensure([&](Vector<float3> &r_data) {
+      r_data.clear_and_shrink();
+      runtime.evaluated_position_dirty_curves.clear_and_shrink();
+    });
     return this->positions();
   }
   this->ensure_nurbs_basis_cache();
   runtime.evaluated_position_cache.ensure([&](Vector<float3> &r_data) {
-    r_data.resize(this->evaluated_points_num());
-    MutableSpan<float3> evaluated_positions = r_data;
+    if (runtime.evaluated_position_dirty_curves.is_empty()) {
+      r_data.resize(this->evaluated_points_num());
+      evaluate_positions(*this, this->curves_range(), r_data);
+      return;
+    }
+    /* Only evaluate the changed curves, keeping the evaluated data of other curves. */
+    BLI_assert(r_data.size() == this->evaluated_points_num());
+    IndexMaskMemory memory;
+    const IndexMask dirty_curves = IndexMask::from_bits(runtime.evaluated_position_dirty_curves,
+                                                        memory);
+    evaluate_positions(*this, dirty_curves, r_data);
+    runtime.evaluated_position_dirty_curves.clear_and_shrink();
+  });
+  return runtime.evaluated_position_cache.data();
+}
 
-    const OffsetIndices<int> points_by_curve = this->points_by_curve();
-    const OffsetIndices<int> evaluated_points_by_curve = this->evaluated_points_by_curve();
-    const Span<float3> positions = this->positions();
+/** Calculate the tangents of the selected curves from their evaluated positions. */
+static void calculate_evaluated_tangents(const CurvesGeometry &curves,
+                                         const IndexMask &curve_selection,
+                                         const Span<float3> evaluated_positions,
+                                         MutableSpan<float3> tangents)
+{
+  const OffsetIndices<int> evaluated_points_by_curve = curves.evaluated_points_by_curve();
+  const VArray<bool> cyclic = curves.cyclic();
 
-    auto evaluate_catmull = [&](const IndexMask &selection) {
-      const VArray<bool> cyclic = this->cyclic();
-      const VArray<int> resolution = this->resolution();
-      selection.foreach_index(GrainSize(128), [&](const int curve_index) {
-        const IndexRange points = points_by_curve[curve_index];
-        const IndexRange evaluated_points = evaluated_points_by_curve[curve_index];
-        curves::catmull_rom::interpolate_to_evaluated(positions.slice(points),
-                                                      cyclic[curve_index],
-                                                      resolution[curve_index],
-                                                      evaluated_positions.slice(evaluated_points));
-      });
-    };
-    auto evaluate_poly = [&](const IndexMask &selection) {
-      array_utils::copy_group_to_group(
-          points_by_curve, evaluated_points_by_curve, selection, positions, evaluated_positions);
-    };
-    auto evaluate_bezier = [&](const IndexMask &selection) {
-      const Span<float3> handle_positions_left = this->handle_positions_left();
-      const Span<float3> handle_positions_right = this->handle_positions_right();
-      if (handle_positions_left.is_empty() || handle_positions_right.is_empty()) {
-        curves::fill_points(evaluated_points_by_curve, selection, float3(0), evaluated_positions);
+  curve_selection.foreach_index(GrainSize(128), [&](const int curve_index) {
+    const IndexRange evaluated_points = evaluated_points_by_curve[curve_index];
+    curves::poly::calculate_tangents(evaluated_positions.slice(evaluated_points),
+                                     cyclic[curve_index],
+                                     tangents.slice(evaluated_points));
+  });
+
+  /* Correct the first and last tangents of non-cyclic Bezier curves so that they align with
+   * the inner handles. This is a separate loop to avoid the cost when Bezier type curves are
+   * not used. */
+  IndexMaskMemory memory;
+  const IndexMask bezier_mask = curves.indices_for_curve_type(
+      CURVE_TYPE_BEZIER, curve_selection, memory);
+  if (!bezier_mask.is_empty()) {
+    const OffsetIndices<int> points_by_curve = curves.points_by_curve();
+    const Span<float3> positions = curves.positions();
+    const Span<float3> handles_left = curves.handle_positions_left();
+    const Span<float3> handles_right = curves.handle_positions_right();
+
+    bezier_mask.foreach_index(GrainSize(1024), [&](const int curve_index) {
+      if (cyclic[curve_index]) {
         return;
       }
-      const Span<int> all_bezier_offsets =
-          runtime.evaluated_offsets_cache.data().all_bezier_offsets;
-      selection.foreach_index(GrainSize(128), [&](const int curve_index) {
-        const IndexRange points = points_by_curve[curve_index];
-        const IndexRange evaluated_points = evaluated_points_by_curve[curve_index];
-        const IndexRange offsets = curves::per_curve_point_offsets_range(points, curve_index);
-        curves::bezier::calculate_evaluated_positions(positions.slice(points),
-                                                      handle_positions_left.slice(points),
-                                                      handle_positions_right.slice(points),
-                                                      all_bezier_offsets.slice(offsets),
-                                                      evaluated_positions.slice(evaluated_points));
-      });
-    };
-    auto evaluate_nurbs = [&](const IndexMask &selection) {
-      this->ensure_nurbs_basis_cache();
-      const VArray<int8_t> nurbs_orders = this->nurbs_orders();
-      const Span<float> nurbs_weights = this->nurbs_weights();
-      const Span<curves::nurbs::BasisCache> nurbs_basis_cache = runtime.nurbs_basis_cache.data();
-      selection.foreach_index(GrainSize(128), [&](const int curve_index) {
-        const IndexRange points = points_by_curve[curve_index];
-        const IndexRange evaluated_points = evaluated_points_by_curve[curve_index];
-        curves::nurbs::interpolate_to_evaluated(nurbs_basis_cache[curve_index],
-                                                nurbs_orders[curve_index],
-                                                nurbs_weights.slice_safe(points),
-                                                positions.slice(points),
-                                                evaluated_positions.slice(evaluated_points));
-      });
-    };
-    curves::foreach_curve_by_type(this->curve_types(),
-                                  this->curve_type_counts(),
-                                  this->curves_range(),
-                                  evaluate_catmull,
-                                  evaluate_poly,
-                                  evaluate_bezier,
-                                  evaluate_nurbs);
-  });
-  return runtime.evaluated_position_cache.data();
+      const IndexRange points = points_by_curve[curve_index];
+      const IndexRange evaluated_points = evaluated_points_by_curve[curve_index];
+
+      const float epsilon = 1e-6f;
+      if (!math::almost_equal_relative(
+              handles_right[points.first()], positions[points.first()], epsilon))
+      {
+        tangents[evaluated_points.first()] = math::normalize(handles_right[points.first()] -
+                                                             positions[points.first()]);
+      }
+      if (!math::almost_equal_relative(
+              handles_left[points.last()], positions[points.last()], epsilon))
+      {
+        tangents[evaluated_points.last()] = math::normalize(positions[points.last()] -
+                                                            handles_left[points.last()]);
+      }
+    });
+  }
 }
 
 Span<float3> CurvesGeometry::evaluated_tangents() const
 {
   const CurvesGeometryRuntime &runtime = *this->runtime;
   runtime.evaluated_tangent_cache.ensure([&](Vector<float3> &r_data) {
-    const OffsetIndices<int> evaluated_points_by_curve = this->evaluated_points_by_curve();
     const Span<float3> evaluated_positions = this->evaluated_positions();
-    const VArray<bool> cyclic = this->cyclic();
-
-    r_data.resize(this->evaluated_points_num());
-    MutableSpan<float3> tangents = r_data;
-
-    threading::parallel_for(this->curves_range(), 128, [&](IndexRange curves_range) {
-      for (const int curve_index : curves_range) {
-        const IndexRange evaluated_points = evaluated_points_by_curve[curve_index];
-        curves::poly::calculate_tangents(evaluated_positions.slice(evaluated_points),
-                                         cyclic[curve_index],
-                                         tangents.slice(evaluated_points));
-      }
-    });
-
-    /* Correct the first and last tangents of non-cyclic Bezier curves so that they align with
-     * the inner handles. This is a separate loop to avoid the cost when Bezier type curves are
-     * not used. */
-    IndexMaskMemory memory;
-    const IndexMask bezier_mask = this->indices_for_curve_type(CURVE_TYPE_BEZIER, memory);
-    if (!bezier_mask.is_empty()) {
-      const OffsetIndices<int> points_by_curve = this->points_by_curve();
-      const Span<float3> positions = this->positions();
-      const Span<float3> handles_left = this->handle_positions_left();
-      const Span<float3> handles_right = this->handle_positions_right();
-
-      bezier_mask.foreach_index(GrainSize(1024), [&](const int curve_index) {
-        if (cyclic[curve_index]) {
-          return;
-        }
-        const IndexRange points = points_by_curve[curve_index];
-        const IndexRange evaluated_points = evaluated_points_by_curve[curve_index];
-
-        const float epsilon = 1e-6f;
-        if (!math::almost_equal_relative(
-                handles_right[points.first()], positions[points.first()], epsilon))
-        {
-          tangents[evaluated_points.first()] = math::normalize(handles_right[points.first()] -
-                                                               positions[points.first()]);
-        }
-        if (!math::almost_equal_relative(
-                handles_left[points.last()], positions[points.last()], epsilon))
-        {
-          tangents[evaluated_points.last()] = math::normalize(positions[points.last()] -
-                                                              handles_left[points.last()]);
-        }
-      });
+    if (runtime.evaluated_tangent_dirty_curves.is_empty()) {
+      r_data.resize(this->evaluated_points_num());
+      calculate_evaluated_tangents(*this, this->curves_range(), evaluated_positions, r_data);
+      return;
     }
+    BLI_assert(r_data.size() == this->evaluated_points_num());
+    IndexMaskMemory memory;
+    const IndexMask dirty_curves = IndexMask::from_bits(runtime.evaluated_tangent_dirty_curves,
+                                                        memory);
+    calculate_evaluated_tangents(*this, dirty_curves, evaluated_positions, r_data);
+    runtime.evaluated_tangent_dirty_curves.clear_and_shrink();
   });
   return runtime.evaluated_tangent_cache.data();
 }
@@ -1059,6 +1097,44 @@ void CurvesGeometry::tag_positions_changed()
   this->runtime->evaluated_normal_cache.tag_dirty();
   this->runtime->evaluated_length_cache.tag_dirty();
   this->runtime->bounds_cache.tag_dirty();
+  this->runtime->evaluated_position_dirty_curves.clear_and_shrink();
+  this->runtime->evaluated_tangent_dirty_curves.clear_and_shrink();
+}
+
+/**
+ * Add the curves to the ones that are evaluated again the next time the cache is used. When the
+ * cache isn't computed yet or already invalidated completely, all curves are evaluated anyway.
+ */
+static void tag_curves_dirty(SharedCache<Vector<float3>> &cache,
+                             BitVector<> &dirty_curves,
+                             const IndexMask &curves,
+                             const int curves_num)
+{
+  if (cache.is_cached()) {
+    dirty_curves.clear();
+    dirty_curves.resize(curves_num, false);
+    cache.tag_dirty_keep_data();
+  }
+  else if (dirty_curves.is_empty()) {
+    return;
+  }
+  curves.foreach_index([&](const int curve_i) { dirty_curves[curve_i].set(); });
+}
+
+void CurvesGeometry::tag_positions_changed(const IndexMask &curves)
+{
+  CurvesGeometryRuntime &runtime = *this->runtime;
+  tag_curves_dirty(runtime.evaluated_position_cache,
+                   runtime.evaluated_position_dirty_curves,
+                   curves,
+                   this->curves_num());
+  tag_curves_dirty(runtime.evaluated_tangent_cache,
+                   runtime.evaluated_tangent_dirty_curves,
+                   curves,
+                   this->curves_num());
+  runtime.evaluated_normal_cache.tag_dirty();
+  runtime.evaluated_length_cache.tag_dirty();
+  runtime.bounds_cache.tag_dirty();
 }
 void CurvesGeometry::tag_topology_changed()
 {
@@ -8,6 +8,8 @@
 
 #include "BKE_curves.hh"
 
+#include "BLI_timeit.hh"
+
 #include "testing/testing.h"
 
 namespace blender::bke::tests {
@@ -29,6 +31,30 @@ static CurvesGeometry create_basic_curves(const int points_size, const int curve
   return curves;
 }
 
+/** Curves of every evaluated type, with handles and NURBS attributes filled in. */
+static CurvesGeometry create_mixed_type_curves(const int points_size, const int curves_size)
+{
+  CurvesGeometry curves = create_basic_curves(points_size, curves_size);
+  MutableSpan<int8_t> types = curves.curve_types_for_write();
+  for (const int i : curves.curves_range()) {
+    const CurveType evaluated_types[3] = {
+        CURVE_TYPE_BEZIER, CURVE_TYPE_NURBS, CURVE_TYPE_CATMULL_ROM};
+    types[i] = evaluated_types[i % 3];
+  }
+  curves.update_curve_types();
+  curves.resolution_for_write().fill(6);
+  curves.nurbs_orders_for_write().fill(3);
+
+  const Span<float3> positions = curves.positions();
+  MutableSpan<float3> handles_left = curves.handle_positions_left_for_write();
+  MutableSpan<float3> handles_right = curves.handle_positions_right_for_write();
+  for (const int i : curves.points_range()) {
+    handles_left[i] = positions[i] - float3(0.25f, 0.5f, 0.0f);
+    handles_right[i] = positions[i] + float3(0.25f, 0.5f, 0.0f);
+  }
+  return curves;
+}
+
 TEST(curves_geometry, Empty)
 {
   CurvesGeometry empty(0, 0);
@@ -476,4 +502,74 @@ TEST(curves_geometry, BezierGenericEvaluation)
   }
 }
 
+TEST(curves_geometry, PartialPositionUpdate)
+{
+  CurvesGeometry curves = create_mixed_type_curves(64, 8);
+  curves.evaluated_positions();
+  curves.evaluated_tangents();
+
+  /* Move the points of some of the curves, and only tag those as changed. Tagging twice before
+   * evaluating updates the curves of both calls. */
+  const OffsetIndices<int> points_by_curve = curves.points_by_curve();
+  const auto move_curves = [&](const IndexMask &changed_curves) {
+    MutableSpan<float3> positions = curves.positions_for_write();
+    MutableSpan<float3> handles_left = curves.handle_positions_left_for_write();
+    MutableSpan<float3> handles_right = curves.handle_positions_right_for_write();
+    changed_curves.foreach_index([&](const int curve) {
+      for (const int point : points_by_curve[curve]) {
+        const float3 offset(0.0f, 0.0f, float(point % 3));
+        positions[point] += offset;
+        handles_left[point] += offset;
+        handles_right[point] += offset;
+      }
+    });
+    curves.tag_positions_changed(changed_curves);
+  };
+  move_curves(IndexRange(2, 2));
+  move_curves(IndexRange(5, 2));
+
+  /* A copy shares the caches and evaluates the changed curves in the same way. */
+  const CurvesGeometry copy = curves;
+  const Array<float3> copy_positions(copy.evaluated_positions());
+
+  const Array<float3> partial_positions(curves.evaluated_positions());
+  const Array<float3> partial_tangents(curves.evaluated_tangents());
+
+  curves.tag_positions_changed();
+  const Span<float3> full_positions = curves.evaluated_positions();
+  const Span<float3> full_tangents = curves.evaluated_tangents();
+
+  ASSERT_EQ(partial_positions.size(), full_positions.size());
+  ASSERT_EQ(copy_positions.size(), full_positions.size());
+  for (const int i : full_positions.index_range()) {
+    EXPECT_V3_NEAR(partial_positions[i], full_positions[i], 1e-6f);
+    EXPECT_V3_NEAR(copy_positions[i], full_positions[i], 1e-6f);
+    EXPECT_V3_NEAR(partial_tangents[i], full_tangents[i], 1e-6f);
+  }
+}
+
+/* Disable benchmark by default. */
+#if 0
+TEST(curves_geometry, EvaluationBenchmark)
+{
+  CurvesGeometry curves = create_mixed_type_curves(4'000'000, 100'000);
+  const IndexMask changed_curves = IndexRange(0, 1000);
+
+  for ([[maybe_unused]] const int64_t _ : IndexRange(3)) {
+    curves.tag_positions_changed();
+    {
+      SCOPED_TIMER("evaluate all");
+      curves.evaluated_positions();
+      curves.evaluated_tangents();
+    }
+    {
+      SCOPED_TIMER("evaluate 1% changed");
+      curves.tag_positions_changed(changed_curves);
+      curves.evaluated_positions();
+      curves.evaluated_tangents();
+    }
+  }
+}
+#endif
+
 }  // namespace blender::bke::tests
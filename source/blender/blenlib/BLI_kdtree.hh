@@ -0,0 +1,96 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ * \brief Build KD-trees from spans of positions and query them with many positions at once.
+ *
+ * Queries for the positions in a mask are done in parallel. Results are written at the index of
+ * the query position, so output spans must be at least `mask.min_array_size()` long.
+ */
+
+#include "BLI_index_mask.hh"
+#include "BLI_kdtree.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
+
+namespace blender::kdtree {
+
+/**
+ * Build a balanced tree of the positions in the mask, using the indices of the positions as the
+ * indices in the tree.
+ */
+KDTree_3d *build_3d(Span<float3> positions, const IndexMask &mask);
+
+/**
+ * Find the nearest point in the tree for every position in the mask. The index is -1 when the
+ * tree is empty. Squared distances are optional.
+ */
+void find_nearest_3d(const KDTree_3d &tree,
+                     Span<float3> positions,
+                     const IndexMask &mask,
+                     MutableSpan<int> r_indices,
+                     MutableSpan<float> r_distances_sq = {});
+
+/**
+ * Find the nearest `k` points in the tree for every position in the mask, sorted by distance.
+ * Results for the position at index `i` start at `i * k` in the output spans, entries that are
+ * not found are set to -1 and `FLT_MAX`. Distances are optional.
+ */
+void find_nearest_n_3d(const KDTree_3d &tree,
+                       Span<float3> positions,
+                       const IndexMask &mask,
+                       int k,
+                       MutableSpan<int> r_indices,
+                       MutableSpan<float> r_distances = {});
+
+/**
+ * Find the nearest point in the tree for every position in the mask, filtered by
+ * `filter(query_index, tree_index, dist_sq)` which returns 1 to accept the point, 0 to skip it
+ * and -1 to stop the search. The index is -1 when no point is accepted.
+ */
+template<typename FilterFn>
+inline void find_nearest_cb_3d(const KDTree_3d &tree,
+                               const Span<float3> positions,
+                               const IndexMask &mask,
+                               const FilterFn &filter,
+                               MutableSpan<int> r_indices)
+{
+  mask.foreach_index(GrainSize(1024), [&](const int query_index) {
+    r_indices[query_index] = BLI_kdtree_3d_find_nearest_cb_cpp(
+        &tree,
+        positions[query_index],
+        nullptr,
+        [&](const int tree_index, const float * /*co*/, const float dist_sq) {
+          return filter(query_index, tree_index, dist_sq);
+        });
+  });
+}
+
+/**
+ * Call `fn(query_index, tree_index, dist_sq)` for every point in the tree within `distance` of
+ * every position in the mask, until it returns false. The callback is called from multiple
+ * threads for different query positions.
+ */
+template<typename Fn>
+inline void range_search_3d(const KDTree_3d &tree,
+                            const Span<float3> positions,
+                            const IndexMask &mask,
+                            const float distance,
+                            const Fn &fn)
+{
+  mask.foreach_index(GrainSize(512), [&](const int query_index) {
+    BLI_kdtree_3d_range_search_cb_cpp(
+        &tree,
+        positions[query_index],
+        distance,
+        [&](const int tree_index, const float * /*co*/, const float dist_sq) {
+          return fn(query_index, tree_index, dist_sq);
+        });
+  });
+}
+
+}  // namespace blender::kdtree
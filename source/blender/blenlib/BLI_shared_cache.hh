@@ -79,6 +79,21 @@ template<typename T> class SharedCache {
     cache_->mutex.ensure([&]() { compute_cache(this->cache_->data); });
   }
 
+  /**
+   * Tag the data for recomputation like #tag_dirty, but keep the existing cached values available
+   * to the next #ensure (copied from shared data if necessary). This is a lazy version of
+   * #update, for when only part of the data changed and it doesn't have to be recomputed yet.
+   */
+  void tag_dirty_keep_data()
+  {
+    if (cache_.unique()) {
+      cache_->mutex.tag_dirty();
+    }
+    else {
+      cache_ = std::make_shared<CacheData>(cache_->data);
+    }
+  }
+
   /** Retrieve the cached data. */
   const T &data() const
   {
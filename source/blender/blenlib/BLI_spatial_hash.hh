@@ -0,0 +1,112 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ * \brief A uniform grid of points for fixed radius neighbor queries.
+ *
+ * Points are bucketed by the grid cell they are in, through a hash of the cell coordinates. The
+ * buckets are built with a parallel counting sort, which is faster to build than a KD-tree and
+ * faster to query when the search radius is known in advance and close to the cell size.
+ */
+
+#include "BLI_array.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_offset_indices.hh"
+#include "BLI_span.hh"
+
+namespace blender {
+
+class SpatialHash {
+  float3 min_;
+  float cell_size_ = 1.0f;
+  float inv_cell_size_ = 1.0f;
+  int3 max_cell_ = int3(0);
+  uint32_t bucket_mask_ = 0;
+
+  /* Start of every bucket in the sorted arrays. */
+  Array<int> bucket_offsets_;
+  /* Indices and positions of the points, sorted by bucket and by index within a bucket. */
+  Array<int> indices_;
+  Array<float3> positions_;
+
+ public:
+  SpatialHash() = default;
+  /**
+   * Build the grid for the positions in the mask. Queries are fastest with a radius of up to
+   * \a cell_size, the actual cell size may be larger to keep the number of cells bounded.
+   */
+  SpatialHash(Span<float3> positions, const IndexMask &mask, float cell_size);
+
+  int64_t size() const
+  {
+    return indices_.size();
+  }
+
+  /**
+   * Call `fn(index, dist_sq)` for every point within \a radius of \a position, where `index` is
+   * the index of the point in the positions used to build the grid. Points are visited grouped
+   * by cell, in an arbitrary but deterministic order.
+   */
+  template<typename Fn>
+  void foreach_in_radius(const float3 &position, const float radius, const Fn &fn) const
+  {
+    if (indices_.is_empty()) {
+      return;
+    }
+    const float radius_sq = radius * radius;
+    const int3 cell_min = math::max(this->cell_of(position - float3(radius)), int3(0));
+    const int3 cell_max = math::min(this->cell_of(position + float3(radius)), max_cell_);
+    const OffsetIndices<int> buckets = bucket_offsets_.as_span();
+
+    int3 cell;
+    for (cell.z = cell_min.z; cell.z <= cell_max.z; cell.z++) {
+      for (cell.y = cell_min.y; cell.y <= cell_max.y; cell.y++) {
+        for (cell.x = cell_min.x; cell.x <= cell_max.x; cell.x++) {
+          for (const int64_t i : buckets[this->bucket_of(cell)]) {
+            const float dist_sq = math::distance_squared(positions_[i], position);
+            /* Different cells can share a bucket, only visit points once. */
+            if (dist_sq <= radius_sq && this->cell_of(positions_[i]) == cell) {
+              fn(indices_[i], dist_sq);
+            }
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  int3 cell_of(const float3 &position) const
+  {
+    return int3(math::floor((position - min_) * inv_cell_size_));
+  }
+
+  int bucket_of(const int3 &cell) const
+  {
+    const uint32_t hash = uint32_t(cell.x) * 73856093u ^ uint32_t(cell.y) * 19349663u ^
+                          uint32_t(cell.z) * 83492791u;
+    return int(hash & bucket_mask_);
+  }
+};
+
+/**
+ * Find points within \a merge_distance of each other, like #BLI_kdtree_3d_calc_duplicates_fast
+ * with index order. Points in the grid are visited by increasing index, every point that isn't
+ * merged yet becomes the target of all of its neighbors that aren't merged yet.
+ *
+ * \param r_duplicates: Entries of points in the grid must be -1 (a candidate for merging) or
+ * their own index (never merged, but can be a target). Merged points get the index of their
+ * target.
+ * \returns The number of merged points.
+ */
+int spatial_hash_calc_duplicates(const SpatialHash &hash,
+                                 Span<float3> positions,
+                                 const IndexMask &mask,
+                                 float merge_distance,
+                                 MutableSpan<int> r_duplicates);
+
+}  // namespace blender
@@ -0,0 +1,78 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <cfloat>
+
+#include "BLI_array.hh"
+#include "BLI_enumerable_thread_specific.hh"
+#include "BLI_kdtree.hh"
+#include "BLI_task.hh"
+
+#include "BLI_strict_flags.h" /* Keep last. */
+
+namespace blender::kdtree {
+
+KDTree_3d *build_3d(const Span<float3> positions, const IndexMask &mask)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(uint(mask.size()));
+  mask.foreach_index(
+      [&](const int index) { BLI_kdtree_3d_insert(tree, index, positions[index]); });
+  BLI_kdtree_3d_balance(tree);
+  return tree;
+}
+
+void find_nearest_3d(const KDTree_3d &tree,
+                     const Span<float3> positions,
+                     const IndexMask &mask,
+                     MutableSpan<int> r_indices,
+                     MutableSpan<float> r_distances_sq)
+{
+  mask.foreach_index(GrainSize(1024), [&](const int query_index) {
+    KDTreeNearest_3d nearest;
+    const int index = BLI_kdtree_3d_find_nearest(&tree, positions[query_index], &nearest);
+    r_indices[query_index] = index;
+    if (!r_distances_sq.is_empty()) {
+      r_distances_sq[query_index] = (index == -1) ? FLT_MAX : nearest.dist * nearest.dist;
+    }
+  });
+}
+
+void find_nearest_n_3d(const KDTree_3d &tree,
+                       const Span<float3> positions,
+                       const IndexMask &mask,
+                       const int k,
+                       MutableSpan<int> r_indices,
+                       MutableSpan<float> r_distances)
+{
+  BLI_assert(k > 0);
+  threading::EnumerableThreadSpecific<Array<KDTreeNearest_3d>> all_nearest(
+      [&]() { return Array<KDTreeNearest_3d>(k); });
+
+  mask.foreach_index(GrainSize(512), [&](const int query_index) {
+    MutableSpan<KDTreeNearest_3d> nearest = all_nearest.local();
+    const int found = BLI_kdtree_3d_find_nearest_n(
+        &tree, positions[query_index], nearest.data(), uint(k));
+
+    const IndexRange range(int64_t(query_index) * k, k);
+    MutableSpan<int> indices = r_indices.slice(range);
+    for (const int64_t i : IndexRange(found)) {
+      indices[i] = nearest[i].index;
+    }
+    indices.drop_front(found).fill(-1);
+
+    if (!r_distances.is_empty()) {
+      MutableSpan<float> distances = r_distances.slice(range);
+      for (const int64_t i : IndexRange(found)) {
+        distances[i] = nearest[i].dist;
+      }
+      distances.drop_front(found).fill(FLT_MAX);
+    }
+  });
+}
+
+}  // namespace blender::kdtree
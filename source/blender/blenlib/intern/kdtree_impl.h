@@ -10,6 +10,7 @@
 
 #include "BLI_kdtree_impl.h"
 #include "BLI_math_base.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include <string.h>
@@ -56,6 +57,12 @@ struct KDTree {
  */
 #define KD_NODE_ROOT_IS_INIT ((uint)-2)
 
+/**
+ * Sub-trees with at least this many nodes are balanced in a separate task,
+ * smaller ones are balanced by the task that partitioned their parent.
+ */
+#define KD_BALANCE_TASK_NODES_LEN 8192u
+
 /* -------------------------------------------------------------------- */
 /** \name Local Math API
  * \{ */
@@ -139,7 +146,58 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+/**
+ * Index of the root of a sub-tree after balancing, the median of its nodes.
+ */
+static uint kdtree_balance_root(const uint nodes_len, const uint ofs)
+{
+  if (nodes_len == 0) {
+    return KD_NODE_UNSET;
+  }
+  if (nodes_len == 1) {
+    return ofs;
+  }
+  return nodes_len / 2 + ofs;
+}
+
+static uint kdtree_balance(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs);
+
+typedef struct KDTreeBalanceTask {
+  KDTreeNode *nodes;
+  uint nodes_len;
+  uint axis;
+  uint ofs;
+} KDTreeBalanceTask;
+
+static void kdtree_balance_task(TaskPool *__restrict pool, void *taskdata)
+{
+  const KDTreeBalanceTask *task = taskdata;
+  kdtree_balance(pool, task->nodes, task->nodes_len, task->axis, task->ofs);
+}
+
+/**
+ * Balance the nodes of a sub-tree, in a separate task when it is large enough.
+ * Since the root of a sub-tree only depends on its size, the resulting tree is the same
+ * as when balancing serially.
+ */
+static uint kdtree_balance_subtree(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  if (pool && nodes_len >= KD_BALANCE_TASK_NODES_LEN) {
+    KDTreeBalanceTask *task = MEM_mallocN(sizeof(KDTreeBalanceTask), __func__);
+    task->nodes = nodes;
+    task->nodes_len = nodes_len;
+    task->axis = axis;
+    task->ofs = ofs;
+    BLI_task_pool_push(pool, kdtree_balance_task, task, true, NULL);
+    return kdtree_balance_root(nodes_len, ofs);
+  }
+  return kdtree_balance(pool, nodes, nodes_len, axis, ofs);
+}
+
+static uint kdtree_balance(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
 {
   KDTreeNode *node;
   float co;
@@ -188,15 +246,17 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   node = &nodes[median];
   node->d = axis;
   axis = (axis + 1) % KD_DIMS;
-  node->left = kdtree_balance(nodes, median, axis, ofs);
-  node->right = kdtree_balance(
-      nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs);
+  node->right = kdtree_balance_subtree(
+      pool, nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs);
+  node->left = kdtree_balance(pool, nodes, median, axis, ofs);
 
   return median + ofs;
 }
 
 void BLI_kdtree_nd_(balance)(KDTree *tree)
 {
+  TaskPool *pool = NULL;
+
   if (tree->root != KD_NODE_ROOT_IS_INIT) {
     for (uint i = 0; i < tree->nodes_len; i++) {
       tree->nodes[i].left = KD_NODE_UNSET;
@@ -204,7 +264,17 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  /* Partitioning is the bulk of the work, balance large sub-trees in parallel. */
+  if (tree->nodes_len >= 2 * KD_BALANCE_TASK_NODES_LEN) {
+    pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+  }
+
+  tree->root = kdtree_balance(pool, tree->nodes, tree->nodes_len, 0, 0);
+
+  if (pool) {
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+  }
 
 #ifndef NDEBUG
   tree->is_balanced = true;
@@ -14,6 +14,7 @@
 #  include <functional>
 #  include <iostream>
 #  include <memory>
+#  include <optional>
 
 #  include "BLI_allocator.hh"
 #  include "BLI_array.hh"
@@ -40,8 +41,14 @@
 
 #  include "BLI_mesh_intersect.hh"
 
+#  include "atomic_ops.h"
+
 // #  define PERFDEBUG
 
+#  ifdef PERFDEBUG
+#    include "BLI_time.h"
+#  endif
+
 namespace blender::meshintersect {
 
 #  ifdef PERFDEBUG
@@ -1118,11 +1125,71 @@ static int filter_plane_side(const double3 &p,
   double supremum = math::dot(abs_p + abs_plane_p, abs_plane_no);
   double err_bound = supremum * index_plane_side * DBL_EPSILON;
   if (fabs(d) > err_bound) {
+#  ifdef PERFDEBUG
+    incperfcount(5); /* Predicates decided by double filters. */
+#  endif
     return d > 0 ? 1 : -1;
   }
   return 0;
 }
 
+/**
+ * Return the exact side of point p on a plane with normal plane_no and point plane_p, for when
+ * #filter_plane_side can't decide: `sgn(dot(p - plane_p, plane_no))`.
+ * The buf argument holds two temporaries, to avoid allocations of mpq3 in the caller's loops.
+ */
+static int exact_plane_side(const mpq3 &p, const mpq3 &plane_p, const mpq3 &plane_no, mpq3 buf[2])
+{
+#  ifdef PERFDEBUG
+  incperfcount(6); /* Predicates decided by exact arithmetic. */
+#  endif
+  buf[0] = p;
+  buf[0] -= plane_p;
+  return sgn(math::dot_with_buffer(buf[0], plane_no, buf[1]));
+}
+
+/**
+ * The index of #filter_tti_above, where the input coordinates have index 1:
+ * the differences have index 2, the cross product coordinates have index 6,
+ * and the dot product of the difference with the cross product has index 11.
+ */
+constexpr int index_tti_above = 11;
+
+/**
+ * Return the approximate side of point d with respect to the oriented plane containing
+ * a, b, c in CCW order, like #tti_above with `ad = d - a`.
+ * The answer is 0 if the error bound doesn't allow deciding the sign with doubles.
+ */
+static int filter_tti_above(const double3 &a,
+                            const double3 &b,
+                            const double3 &c,
+                            const double3 &d)
+{
+  const double3 ba = b - a;
+  const double3 ca = c - a;
+  const double3 ad = d - a;
+  const double det = math::dot(ad, math::cross(ba, ca));
+  if (det == 0.0) {
+    return 0;
+  }
+  const double3 abs_a = math::abs(a);
+  const double3 abs_ba = math::abs(b) + abs_a;
+  const double3 abs_ca = math::abs(c) + abs_a;
+  const double3 abs_ad = math::abs(d) + abs_a;
+  const double3 abs_n(abs_ba.y * abs_ca.z + abs_ba.z * abs_ca.y,
+                      abs_ba.z * abs_ca.x + abs_ba.x * abs_ca.z,
+                      abs_ba.x * abs_ca.y + abs_ba.y * abs_ca.x);
+  const double supremum = math::dot(abs_ad, abs_n);
+  const double err_bound = supremum * index_tti_above * DBL_EPSILON;
+  if (fabs(det) > err_bound) {
+#  ifdef PERFDEBUG
+    incperfcount(5); /* Predicates decided by double filters. */
+#  endif
+    return det > 0 ? 1 : -1;
+  }
+  return 0;
+}
+
 /*
  * #intersect_tri_tri and helper functions.
  * This code uses the algorithm of Guigue and Devillers, as described
@@ -1155,7 +1222,7 @@ static inline mpq3 tti_interp(
 /**
  * Return +1, 0, -1 as a + ad is above, on, or below the oriented plane containing a, b, c in CCW
  * order. This is the same as -oriented(a, b, c, a + ad), but uses fewer arithmetic operations.
- * TODO: change arguments to `const Vert *` and use floating filters.
+ * Callers should try #filter_tti_above first.
  * The ba, ca, n, and dotbuf arguments are used as temporaries; declaring them
  * in the caller can avoid many allocations and frees of mpq3 and mpq_class structures.
  */
@@ -1168,6 +1235,9 @@ static inline int tti_above(const mpq3 &a,
                             mpq3 &n,
                             mpq3 &dotbuf)
 {
+#  ifdef PERFDEBUG
+  incperfcount(6); /* Predicates decided by exact arithmetic. */
+#  endif
   ba = b;
   ba -= a;
   ca = c;
@@ -1193,16 +1263,22 @@ static inline int tti_above(const mpq3 &a,
  *   of the plane and at least one of q1 and r1 are off the plane.
  * Similarly for p2, q2, r2 with respect to the first triangle's plane.
  */
-static ITT_value itt_canon2(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon2(const Vert *vp1,
+                            const Vert *vq1,
+                            const Vert *vr1,
+                            const Vert *vp2,
+                            const Vert *vq2,
+                            const Vert *vr2,
                             const mpq3 &n1,
                             const mpq3 &n2)
 {
   constexpr int dbg_level = 0;
+  const mpq3 &p1 = vp1->co_exact;
+  const mpq3 &q1 = vq1->co_exact;
+  const mpq3 &r1 = vr1->co_exact;
+  const mpq3 &p2 = vp2->co_exact;
+  const mpq3 &q2 = vq2->co_exact;
+  const mpq3 &r2 = vr2->co_exact;
   if (dbg_level > 0) {
     std::cout << "\ntri_tri_intersect_canon:\n";
     std::cout << "p1=" << p1 << " q1=" << q1 << " r1=" << r1 << "\n";
@@ -1218,17 +1294,30 @@ static ITT_value itt_canon2(const mpq3 &p1,
     std::cout << "n1=(" << n1[0].get_d() << "," << n1[1].get_d() << "," << n1[2].get_d() << ")\n";
     std::cout << "n2=(" << n2[0].get_d() << "," << n2[1].get_d() << "," << n2[2].get_d() << ")\n";
   }
-  mpq3 p1p2 = p2 - p1;
   mpq3 intersect_1;
   mpq3 intersect_2;
   mpq3 buf[4];
   bool no_overlap = false;
+
+  /* Side of p2 with respect to the plane of p1, b and c. Exact arithmetic is only used when
+   * the floating point filter can't decide. */
+  std::optional<mpq3> p1p2;
+  const auto above = [&](const Vert *b, const Vert *c) {
+    const int side = filter_tti_above(vp1->co, b->co, c->co, vp2->co);
+    if (side != 0) {
+      return side;
+    }
+    if (!p1p2) {
+      p1p2 = p2 - p1;
+    }
+    return tti_above(p1, b->co_exact, c->co_exact, *p1p2, buf[0], buf[1], buf[2], buf[3]);
+  };
   /* Top test in classification tree. */
-  if (tti_above(p1, q1, r2, p1p2, buf[0], buf[1], buf[2], buf[3]) > 0) {
+  if (above(vq1, vr2) > 0) {
     /* Middle right test in classification tree. */
-    if (tti_above(p1, r1, r2, p1p2, buf[0], buf[1], buf[2], buf[3]) <= 0) {
+    if (above(vr1, vr2) <= 0) {
       /* Bottom right test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) > 0) {
+      if (above(vr1, vq2) > 0) {
         /* Overlap is [k [i l] j]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i l] j]\n";
@@ -1257,7 +1346,7 @@ static ITT_value itt_canon2(const mpq3 &p1,
   }
   else {
     /* Middle left test in classification tree. */
-    if (tti_above(p1, q1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) < 0) {
+    if (above(vq1, vq2) < 0) {
       /* No overlap: [i j] [k l]. */
       if (dbg_level > 0) {
         std::cout << "no overlap: [i j] [k l]\n";
@@ -1266,7 +1355,7 @@ static ITT_value itt_canon2(const mpq3 &p1,
     }
     else {
       /* Bottom left test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) >= 0) {
+      if (above(vr1, vq2) >= 0) {
         /* Overlap is [k [i j] l]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i j] l]\n";
@@ -1303,12 +1392,12 @@ static ITT_value itt_canon2(const mpq3 &p1,
 
 /* Helper function for intersect_tri_tri. Arguments have been canonicalized for triangle 1. */
 
-static ITT_value itt_canon1(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon1(const Vert *p1,
+                            const Vert *q1,
+                            const Vert *r1,
+                            const Vert *p2,
+                            const Vert *q2,
+                            const Vert *r2,
                             const mpq3 &n1,
                             const mpq3 &n2,
                             int sp2,
@@ -1443,19 +1532,13 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
 
   const mpq3 &n2 = tri2.plane->norm_exact;
   if (sp1 == 0) {
-    buf[0] = p1;
-    buf[0] -= r2;
-    sp1 = sgn(math::dot_with_buffer(buf[0], n2, buf[1]));
+    sp1 = exact_plane_side(p1, r2, n2, buf);
   }
   if (sq1 == 0) {
-    buf[0] = q1;
-    buf[0] -= r2;
-    sq1 = sgn(math::dot_with_buffer(buf[0], n2, buf[1]));
+    sq1 = exact_plane_side(q1, r2, n2, buf);
   }
   if (sr1 == 0) {
-    buf[0] = r1;
-    buf[0] -= r2;
-    sr1 = sgn(math::dot_with_buffer(buf[0], n2, buf[1]));
+    sr1 = exact_plane_side(r1, r2, n2, buf);
   }
 
   if (dbg_level > 1) {
@@ -1475,19 +1558,13 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
   /* Repeat for signs of t2's vertices with respect to plane of t1. */
   const mpq3 &n1 = tri1.plane->norm_exact;
   if (sp2 == 0) {
-    buf[0] = p2;
-    buf[0] -= r1;
-    sp2 = sgn(math::dot_with_buffer(buf[0], n1, buf[1]));
+    sp2 = exact_plane_side(p2, r1, n1, buf);
   }
   if (sq2 == 0) {
-    buf[0] = q2;
-    buf[0] -= r1;
-    sq2 = sgn(math::dot_with_buffer(buf[0], n1, buf[1]));
+    sq2 = exact_plane_side(q2, r1, n1, buf);
   }
   if (sr2 == 0) {
-    buf[0] = r2;
-    buf[0] -= r1;
-    sr2 = sgn(math::dot_with_buffer(buf[0], n1, buf[1]));
+    sr2 = exact_plane_side(r2, r1, n1, buf);
   }
 
   if (dbg_level > 1) {
@@ -1510,49 +1587,49 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
   ITT_value ans;
   if (sp1 > 0) {
     if (sq1 > 0) {
-      ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
     else if (sr1 > 0) {
-      ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
   }
   else if (sp1 < 0) {
     if (sq1 < 0) {
-      ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
     else if (sr1 < 0) {
-      ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
   }
   else {
     if (sq1 < 0) {
       if (sr1 >= 0) {
-        ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
-        ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
     }
     else if (sq1 > 0) {
       if (sr1 > 0) {
-        ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
-        ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
     }
     else {
       if (sr1 > 0) {
-        ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
       else if (sr1 < 0) {
-        ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
         if (dbg_level > 0) {
@@ -3025,10 +3102,14 @@ IMesh trimesh_nary_intersect(const IMesh &tm_in,
   std::cout << "subdivided non-cluster tris found, time = " << subdivided_tris_time - itt_time
             << "\n";
 #  endif
+  /* Clusters are independent, the results are extracted serially in #calc_cluster_tris. */
   Array<CDT_data> cluster_subdivided(clinfo.tot_cluster());
-  for (int c : clinfo.index_range()) {
-    cluster_subdivided[c] = calc_cluster_subdivided(clinfo, c, *tm_clean, tri_ov, itt_map, arena);
-  }
+  threading::parallel_for(clinfo.index_range(), 1, [&](IndexRange range) {
+    for (int c : range) {
+      cluster_subdivided[c] = calc_cluster_subdivided(
+          clinfo, c, *tm_clean, tri_ov, itt_map, arena);
+    }
+  });
 #  ifdef PERFDEBUG
   double cluster_subdivide_time = BLI_time_now_seconds();
   std::cout << "subdivided clusters found, time = "
@@ -3176,6 +3257,14 @@ static void perfdata_init()
   perfdata->count.append(0);
   perfdata->count_name.append("final non-NONE intersects");
 
+  /* count 5. */
+  perfdata->count.append(0);
+  perfdata->count_name.append("predicates decided by double filters");
+
+  /* count 6. */
+  perfdata->count.append(0);
+  perfdata->count_name.append("predicates decided by exact arithmetic");
+
   /* max 0. */
   perfdata->max.append(0);
   perfdata->max_name.append("total faces");
@@ -3189,14 +3278,15 @@ static void perfdata_init()
   perfdata->max_name.append("total overlaps");
 }
 
+/* Counts are incremented from multiple threads. */
 static void incperfcount(int countnum)
 {
-  perfdata->count[countnum]++;
+  atomic_add_and_fetch_int32(&perfdata->count[countnum], 1);
 }
 
 static void bumpperfcount(int countnum, int amt)
 {
-  perfdata->count[countnum] += amt;
+  atomic_add_and_fetch_int32(&perfdata->count[countnum], amt);
 }
 
 static void doperfmax(int maxnum, int val)
@@ -3213,6 +3303,11 @@ static void dump_perfdata()
   for (int i : perfdata->max.index_range()) {
     std::cout << perfdata->max_name[i] << " = " << perfdata->max[i] << "\n";
   }
+  const int predicates_num = perfdata->count[5] + perfdata->count[6];
+  if (predicates_num > 0) {
+    std::cout << "fraction of predicates decided by double filters = "
+              << double(perfdata->count[5]) / predicates_num << "\n";
+  }
   delete perfdata;
 }
 #  endif
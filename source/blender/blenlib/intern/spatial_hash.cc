@@ -0,0 +1,122 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <algorithm>
+
+#include "BLI_array_utils.hh"
+#include "BLI_bounds.hh"
+#include "BLI_math_base.h"
+#include "BLI_spatial_hash.hh"
+#include "BLI_task.hh"
+
+#include "atomic_ops.h"
+
+#include "BLI_strict_flags.h" /* Keep last. */
+
+namespace blender {
+
+SpatialHash::SpatialHash(const Span<float3> positions,
+                         const IndexMask &mask,
+                         const float cell_size)
+{
+  const int points_num = int(mask.size());
+  if (points_num == 0) {
+    return;
+  }
+
+  const Bounds<float3> bounds = *bounds::min_max(mask, positions);
+  min_ = bounds.min;
+  /* Limit the number of cells along an axis, so that cell coordinates always fit in an integer,
+   * also when merging points at (almost) zero distance. */
+  const float max_extent = math::reduce_max(bounds.max - bounds.min);
+  cell_size_ = std::max(cell_size, max_extent / float(1 << 20));
+  if (cell_size_ <= 0.0f) {
+    cell_size_ = 1.0f;
+  }
+  inv_cell_size_ = 1.0f / cell_size_;
+  max_cell_ = this->cell_of(bounds.max);
+
+  /* About one bucket per point, so that most buckets only contain a single cell. */
+  bucket_mask_ = power_of_2_max_u(uint(points_num)) - 1;
+  const int buckets_num = int(bucket_mask_) + 1;
+
+  /* Counting sort of the points by bucket. */
+  Array<int> point_buckets(points_num);
+  bucket_offsets_.reinitialize(buckets_num + 1);
+  bucket_offsets_.fill(0);
+  mask.foreach_index(GrainSize(4096), [&](const int i, const int pos) {
+    const int bucket = this->bucket_of(this->cell_of(positions[i]));
+    point_buckets[pos] = bucket;
+    atomic_add_and_fetch_int32(&bucket_offsets_[bucket], 1);
+  });
+  const OffsetIndices<int> buckets = offset_indices::accumulate_counts_to_offsets(
+      bucket_offsets_);
+
+  indices_.reinitialize(points_num);
+  Array<int> bucket_sizes(buckets_num, 0);
+  mask.foreach_index(GrainSize(4096), [&](const int i, const int pos) {
+    const int bucket = point_buckets[pos];
+    const int offset = atomic_fetch_and_add_int32(&bucket_sizes[bucket], 1);
+    indices_[buckets[bucket].start() + offset] = i;
+  });
+
+  /* Points are added to buckets in a non-deterministic order, sort them by index. */
+  threading::parallel_for(IndexRange(buckets_num), 4096, [&](const IndexRange range) {
+    for (const int64_t bucket : range) {
+      MutableSpan<int> bucket_indices = indices_.as_mutable_span().slice(buckets[bucket]);
+      if (bucket_indices.size() > 1) {
+        std::sort(bucket_indices.begin(), bucket_indices.end());
+      }
+    }
+  });
+
+  positions_.reinitialize(points_num);
+  array_utils::gather(positions, indices_.as_span(), positions_.as_mutable_span());
+}
+
+int spatial_hash_calc_duplicates(const SpatialHash &hash,
+                                 const Span<float3> positions,
+                                 const IndexMask &mask,
+                                 const float merge_distance,
+                                 MutableSpan<int> r_duplicates)
+{
+  /* Usually most points don't have any neighbors. Find the ones that do in parallel, so that
+   * only those have to be visited in order. */
+  IndexMaskMemory memory;
+  const IndexMask candidates = IndexMask::from_predicate(
+      mask, GrainSize(1024), memory, [&](const int index) {
+        bool has_neighbor = false;
+        hash.foreach_in_radius(
+            positions[index], merge_distance, [&](const int other, const float /*dist_sq*/) {
+              has_neighbor |= (other != index);
+            });
+        return has_neighbor;
+      });
+
+  int found = 0;
+  candidates.foreach_index([&](const int index) {
+    if (!ELEM(r_duplicates[index], -1, index)) {
+      return;
+    }
+    const int found_prev = found;
+    hash.foreach_in_radius(
+        positions[index], merge_distance, [&](const int other, const float /*dist_sq*/) {
+          if (other != index && r_duplicates[other] == -1) {
+            r_duplicates[other] = index;
+            found++;
+          }
+        });
+    if (found != found_prev) {
+      /* Prevent chains of doubles. */
+      r_duplicates[index] = index;
+    }
+  });
+  return found;
+}
+
+}  // namespace blender
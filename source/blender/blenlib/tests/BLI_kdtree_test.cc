@@ -4,8 +4,12 @@
 
 #include "testing/testing.h"
 
-#include "BLI_kdtree.h"
+#include "BLI_kdtree.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+#include "BLI_timeit.hh"
 
+#include <atomic>
 #include <cmath>
 
 /* -------------------------------------------------------------------- */
@@ -63,3 +67,147 @@ TEST(kdtree, Deduplicate)
 {
   deduplicate_test();
 }
+
+namespace blender::kdtree::tests {
+
+static Array<float3> random_positions(const int size, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float3> positions(size);
+  for (float3 &position : positions) {
+    position = float3(rng.get_float(), rng.get_float(), rng.get_float());
+  }
+  return positions;
+}
+
+static int find_nearest_brute_force(const Span<float3> positions, const float3 &co)
+{
+  int nearest = -1;
+  float nearest_dist_sq = FLT_MAX;
+  for (const int i : positions.index_range()) {
+    const float dist_sq = math::distance_squared(positions[i], co);
+    if (dist_sq < nearest_dist_sq) {
+      nearest_dist_sq = dist_sq;
+      nearest = i;
+    }
+  }
+  return nearest;
+}
+
+TEST(kdtree, ParallelBalance)
+{
+  /* Large enough for sub-trees to be balanced in parallel. */
+  const Array<float3> positions = random_positions(100'000, 0);
+  const Array<float3> queries = random_positions(200, 1);
+
+  KDTree_3d *tree = build_3d(positions, positions.index_range());
+
+  Array<int> indices(queries.size());
+  Array<float> distances_sq(queries.size());
+  find_nearest_3d(*tree, queries, queries.index_range(), indices, distances_sq);
+
+  for (const int i : queries.index_range()) {
+    const int expected = find_nearest_brute_force(positions, queries[i]);
+    EXPECT_EQ(indices[i], expected);
+    EXPECT_FLOAT_EQ(distances_sq[i], math::distance_squared(positions[expected], queries[i]));
+  }
+
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, FindNearestN)
+{
+  const Array<float3> positions = random_positions(1000, 2);
+  const Array<float3> queries = random_positions(50, 3);
+  const int k = 5;
+
+  KDTree_3d *tree = build_3d(positions, positions.index_range());
+
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_every_nth(2, queries.size() / 2, 0, memory);
+  Array<int> indices(queries.size() * k, -2);
+  Array<float> distances(queries.size() * k);
+  find_nearest_n_3d(*tree, queries, mask, k, indices, distances);
+
+  for (const int i : queries.index_range()) {
+    const Span<int> query_indices = indices.as_span().slice(i * k, k);
+    if (!mask.contains(i)) {
+      EXPECT_EQ(query_indices[0], -2);
+      continue;
+    }
+    EXPECT_EQ(query_indices[0], find_nearest_brute_force(positions, queries[i]));
+    for (const int j : IndexRange(1, k - 1)) {
+      EXPECT_LE(distances[i * k + j - 1], distances[i * k + j]);
+    }
+  }
+
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, RangeSearch)
+{
+  const Array<float3> positions = random_positions(1000, 4);
+  const Array<float3> queries = random_positions(50, 5);
+  const float distance = 0.2f;
+
+  KDTree_3d *tree = build_3d(positions, positions.index_range());
+
+  Array<std::atomic<int>> counts(queries.size());
+  for (std::atomic<int> &count : counts) {
+    count = 0;
+  }
+  range_search_3d(*tree,
+                  queries,
+                  queries.index_range(),
+                  distance,
+                  [&](const int query_index, const int /*index*/, const float /*dist_sq*/) {
+                    counts[query_index]++;
+                    return true;
+                  });
+
+  for (const int i : queries.index_range()) {
+    int expected = 0;
+    for (const float3 &position : positions) {
+      if (math::distance(position, queries[i]) <= distance) {
+        expected++;
+      }
+    }
+    EXPECT_EQ(counts[i], expected);
+  }
+
+  BLI_kdtree_3d_free(tree);
+}
+
+/* Disable benchmark by default. */
+#if 0
+TEST(kdtree, Benchmark)
+{
+  const Array<float3> positions = random_positions(10'000'000, 6);
+
+  for ([[maybe_unused]] const int64_t _ : IndexRange(3)) {
+    KDTree_3d *tree = BLI_kdtree_3d_new(uint(positions.size()));
+    for (const int i : positions.index_range()) {
+      BLI_kdtree_3d_insert(tree, i, positions[i]);
+    }
+    {
+      SCOPED_TIMER("balance");
+      BLI_kdtree_3d_balance(tree);
+    }
+
+    Array<int> indices(positions.size());
+    {
+      SCOPED_TIMER("find nearest (serial)");
+      for (const int i : positions.index_range()) {
+        indices[i] = BLI_kdtree_3d_find_nearest(tree, positions[i], nullptr);
+      }
+    }
+    {
+      SCOPED_TIMER("find nearest (batched)");
+      find_nearest_3d(*tree, positions, positions.index_range(), indices);
+    }
+    BLI_kdtree_3d_free(tree);
+  }
+}
+#endif
+
+}  // namespace blender::kdtree::tests
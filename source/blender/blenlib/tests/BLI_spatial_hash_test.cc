@@ -0,0 +1,127 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_kdtree.h"
+#include "BLI_rand.hh"
+#include "BLI_spatial_hash.hh"
+#include "BLI_timeit.hh"
+
+namespace blender::tests {
+
+static Array<float3> random_positions(const int size, const float scale, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float3> positions(size);
+  for (float3 &position : positions) {
+    position = float3(rng.get_float(), rng.get_float(), rng.get_float()) * scale;
+  }
+  return positions;
+}
+
+TEST(spatial_hash, Empty)
+{
+  const SpatialHash hash({}, IndexMask(), 0.1f);
+  EXPECT_EQ(hash.size(), 0);
+  hash.foreach_in_radius(float3(0.0f), 1.0f, [&](const int /*index*/, const float /*dist_sq*/) {
+    FAIL();
+  });
+}
+
+TEST(spatial_hash, RadiusQuery)
+{
+  const Array<float3> positions = random_positions(10'000, 1.0f, 0);
+  const Array<float3> queries = random_positions(100, 1.2f, 1);
+
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_every_nth(3, positions.size() / 3, 0, memory);
+
+  for (const float radius : {0.0f, 0.02f, 0.05f, 0.2f}) {
+    const SpatialHash hash(positions, mask, 0.05f);
+    EXPECT_EQ(hash.size(), mask.size());
+
+    for (const float3 &query : queries) {
+      Vector<int> found;
+      hash.foreach_in_radius(query, radius, [&](const int index, const float dist_sq) {
+        EXPECT_FLOAT_EQ(dist_sq, math::distance_squared(positions[index], query));
+        found.append(index);
+      });
+      std::sort(found.begin(), found.end());
+
+      Vector<int> expected;
+      mask.foreach_index([&](const int index) {
+        if (math::distance_squared(positions[index], query) <= radius * radius) {
+          expected.append(index);
+        }
+      });
+      EXPECT_EQ(found.as_span(), expected.as_span());
+    }
+  }
+}
+
+TEST(spatial_hash, CalcDuplicates)
+{
+  /* Clusters of points, so that many points are merged. */
+  Array<float3> positions = random_positions(5'000, 1.0f, 2);
+  const Array<float3> offsets = random_positions(positions.size(), 0.01f, 3);
+  for (const int i : positions.index_range()) {
+    positions[i] = positions[i / 4] + offsets[i];
+  }
+  const float merge_distance = 0.01f;
+
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_every_nth(2, positions.size() / 2, 1, memory);
+
+  /* Results match the KD-tree ordered by index. */
+  Array<int> expected(positions.size(), -1);
+  KDTree_3d *tree = BLI_kdtree_3d_new(mask.size());
+  mask.foreach_index([&](const int i) { BLI_kdtree_3d_insert(tree, i, positions[i]); });
+  BLI_kdtree_3d_balance(tree);
+  const int expected_count = BLI_kdtree_3d_calc_duplicates_fast(
+      tree, merge_distance, true, expected.data());
+  BLI_kdtree_3d_free(tree);
+
+  Array<int> duplicates(positions.size(), -1);
+  const SpatialHash hash(positions, mask, merge_distance);
+  const int count = spatial_hash_calc_duplicates(
+      hash, positions, mask, merge_distance, duplicates);
+
+  EXPECT_GT(count, 0);
+  EXPECT_EQ(count, expected_count);
+  EXPECT_EQ(duplicates.as_span(), expected.as_span());
+}
+
+/* Disable benchmark by default. */
+#if 0
+TEST(spatial_hash, Benchmark)
+{
+  const Array<float3> positions = random_positions(10'000'000, 100.0f, 4);
+  const float merge_distance = 0.005f;
+
+  for ([[maybe_unused]] const int64_t _ : IndexRange(3)) {
+    {
+      SCOPED_TIMER("kdtree");
+      Array<int> duplicates(positions.size(), -1);
+      KDTree_3d *tree = BLI_kdtree_3d_new(uint(positions.size()));
+      for (const int i : positions.index_range()) {
+        BLI_kdtree_3d_insert(tree, i, positions[i]);
+      }
+      BLI_kdtree_3d_balance(tree);
+      BLI_kdtree_3d_calc_duplicates_fast(tree, merge_distance, true, duplicates.data());
+      BLI_kdtree_3d_free(tree);
+    }
+    {
+      SCOPED_TIMER("spatial hash");
+      Array<int> duplicates(positions.size(), -1);
+      const SpatialHash hash(positions, positions.index_range(), merge_distance);
+      spatial_hash_calc_duplicates(
+          hash, positions, positions.index_range(), merge_distance, duplicates);
+    }
+  }
+}
+#endif
+
+}  // namespace blender::tests
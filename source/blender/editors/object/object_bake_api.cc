@@ -22,6 +22,8 @@
 #include "BLI_math_geom.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_time.h"
 
 #include "BLT_translation.hh"
 
@@ -114,6 +116,11 @@ struct BakeAPIRender {
   float *progress;
   bool *do_update;
 
+  /* Index of the object being baked and number of objects, when baking multiple objects in a
+   * single render engine session. */
+  int batch_index;
+  int batch_num;
+
   /* Operator state. */
   ReportList *reports;
   int result;
@@ -126,6 +133,10 @@ static void bake_progress_update(void *bjv, float progress)
 {
   BakeAPIRender *bj = static_cast<BakeAPIRender *>(bjv);
 
+  if (bj->batch_num > 0) {
+    progress = (bj->batch_index + progress) / bj->batch_num;
+  }
+
   if (bj->progress && *bj->progress != progress) {
     *bj->progress = progress;
 
@@ -1388,6 +1399,88 @@ static void bake_targets_free(BakeTargets *targets)
   MEM_SAFE_FREE(targets->result);
 }
 
+/**
+ * Convert baked normals from world space, +X +Y +Z, to the space and swizzle of the bake settings.
+ */
+static void bake_normals_convert(const BakeAPIRender *bkr,
+                                 BakeTargets *targets,
+                                 Object *ob_low,
+                                 Object *ob_low_eval,
+                                 Mesh *me_low_eval,
+                                 BakePixel *pixel_array_low)
+{
+  switch (bkr->normal_space) {
+    case R_BAKE_SPACE_WORLD: {
+      /* Cycles internal format */
+      if ((bkr->normal_swizzle[0] == R_BAKE_POSX) && (bkr->normal_swizzle[1] == R_BAKE_POSY) &&
+          (bkr->normal_swizzle[2] == R_BAKE_POSZ))
+      {
+        break;
+      }
+      RE_bake_normal_world_to_world(pixel_array_low,
+                                    targets->pixels_num,
+                                    targets->channels_num,
+                                    targets->result,
+                                    bkr->normal_swizzle);
+      break;
+    }
+    case R_BAKE_SPACE_OBJECT: {
+      RE_bake_normal_world_to_object(pixel_array_low,
+                                     targets->pixels_num,
+                                     targets->channels_num,
+                                     targets->result,
+                                     ob_low_eval,
+                                     bkr->normal_swizzle);
+      break;
+    }
+    case R_BAKE_SPACE_TANGENT: {
+      if (bkr->is_selected_to_active) {
+        RE_bake_normal_world_to_tangent(pixel_array_low,
+                                        targets->pixels_num,
+                                        targets->channels_num,
+                                        targets->result,
+                                        me_low_eval,
+                                        bkr->normal_swizzle,
+                                        ob_low_eval->object_to_world().ptr());
+      }
+      else {
+        /* From multi-resolution. */
+        Mesh *me_nores = nullptr;
+        ModifierData *md = nullptr;
+        int mode;
+
+        md = BKE_modifiers_findby_type(ob_low_eval, eModifierType_Multires);
+
+        if (md) {
+          BKE_object_eval_reset(ob_low_eval);
+          mode = md->mode;
+          md->mode &= ~eModifierMode_Render;
+
+          /* Evaluate modifiers again. */
+          me_nores = BKE_mesh_new_from_object(nullptr, ob_low_eval, false, false);
+          bake_targets_populate_pixels(bkr, targets, ob_low, me_nores, pixel_array_low);
+        }
+
+        RE_bake_normal_world_to_tangent(pixel_array_low,
+                                        targets->pixels_num,
+                                        targets->channels_num,
+                                        targets->result,
+                                        (me_nores) ? me_nores : me_low_eval,
+                                        bkr->normal_swizzle,
+                                        ob_low_eval->object_to_world().ptr());
+
+        if (md) {
+          BKE_id_free(nullptr, &me_nores->id);
+          md->mode = mode;
+        }
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
 /* Main Bake Logic */
 
 static int bake(const BakeAPIRender *bkr,
@@ -1662,76 +1755,7 @@ static int bake(const BakeAPIRender *bkr,
   /* normal space conversion
    * the normals are expected to be in world space, +X +Y +Z */
   if (ok && bkr->pass_type == SCE_PASS_NORMAL) {
-    switch (bkr->normal_space) {
-      case R_BAKE_SPACE_WORLD: {
-        /* Cycles internal format */
-        if ((bkr->normal_swizzle[0] == R_BAKE_POSX) && (bkr->normal_swizzle[1] == R_BAKE_POSY) &&
-            (bkr->normal_swizzle[2] == R_BAKE_POSZ))
-        {
-          break;
-        }
-        RE_bake_normal_world_to_world(pixel_array_low,
-                                      targets.pixels_num,
-                                      targets.channels_num,
-                                      targets.result,
-                                      bkr->normal_swizzle);
-        break;
-      }
-      case R_BAKE_SPACE_OBJECT: {
-        RE_bake_normal_world_to_object(pixel_array_low,
-                                       targets.pixels_num,
-                                       targets.channels_num,
-                                       targets.result,
-                                       ob_low_eval,
-                                       bkr->normal_swizzle);
-        break;
-      }
-      case R_BAKE_SPACE_TANGENT: {
-        if (bkr->is_selected_to_active) {
-          RE_bake_normal_world_to_tangent(pixel_array_low,
-                                          targets.pixels_num,
-                                          targets.channels_num,
-                                          targets.result,
-                                          me_low_eval,
-                                          bkr->normal_swizzle,
-                                          ob_low_eval->object_to_world().ptr());
-        }
-        else {
-          /* From multi-resolution. */
-          Mesh *me_nores = nullptr;
-          ModifierData *md = nullptr;
-          int mode;
-
-          BKE_object_eval_reset(ob_low_eval);
-          md = BKE_modifiers_findby_type(ob_low_eval, eModifierType_Multires);
-
-          if (md) {
-            mode = md->mode;
-            md->mode &= ~eModifierMode_Render;
-
-            /* Evaluate modifiers again. */
-            me_nores = BKE_mesh_new_from_object(nullptr, ob_low_eval, false, false);
-            bake_targets_populate_pixels(bkr, &targets, ob_low, me_nores, pixel_array_low);
-          }
-
-          RE_bake_normal_world_to_tangent(pixel_array_low,
-                                          targets.pixels_num,
-                                          targets.channels_num,
-                                          targets.result,
-                                          (me_nores) ? me_nores : me_low_eval,
-                                          bkr->normal_swizzle,
-                                          ob_low_eval->object_to_world().ptr());
-
-          if (md) {
-            BKE_id_free(nullptr, &me_nores->id);
-            md->mode = mode;
-          }
-        }
-        break;
-      }
-      default:
-        break;
-    }
+    bake_normals_convert(bkr, &targets, ob_low, ob_low_eval, me_low_eval, pixel_array_low);
   }
 
   if (!ok) {
@@ -1790,6 +1814,235 @@ cleanup:
   return op_result;
 }
 
+/* Batch Bake
+ *
+ * Baking the selected objects one by one creates a new dependency graph and render engine
+ * session for every object, synchronizing the entire scene to the render engine again each time.
+ * Without "Selected to Active", the objects are instead baked one after the other in a single
+ * session on a dependency graph evaluated once. Writing the results of an object to its targets
+ * runs in the background while the next object is baked. */
+
+struct BakeBatchObject {
+  Object *ob;
+  Object *ob_eval;
+  Mesh *me_eval;
+  BakePixel *pixel_array;
+  BakeTargets targets;
+
+  bool ok;
+  double bake_time;
+  double output_time;
+};
+
+static bool bake_batch_supported(const BakeAPIRender *bkr)
+{
+  if (bkr->is_selected_to_active || bkr->selected_objects.size() < 2) {
+    return false;
+  }
+
+  /* Tangent space normals of multi-resolution objects are converted by evaluating the object
+   * again, which can not happen while other objects are being baked from the same dependency
+   * graph. */
+  if (bkr->pass_type == SCE_PASS_NORMAL && bkr->normal_space == R_BAKE_SPACE_TANGENT) {
+    for (const PointerRNA &ptr : bkr->selected_objects) {
+      Object *ob_iter = static_cast<Object *>(ptr.data);
+      if (BKE_modifiers_findby_type(ob_iter, eModifierType_Multires)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static void bake_batch_object_free(BakeBatchObject *item)
+{
+  MEM_SAFE_FREE(item->pixel_array);
+  bake_targets_free(&item->targets);
+  if (item->me_eval != nullptr) {
+    BKE_id_free(nullptr, &item->me_eval->id);
+  }
+  MEM_delete(item);
+}
+
+static BakeBatchObject *bake_batch_object_init(const BakeAPIRender *bkr,
+                                               Depsgraph *depsgraph,
+                                               Object *ob,
+                                               ReportList *reports)
+{
+  const bool preserve_origindex = (bkr->target == R_BAKE_TARGET_VERTEX_COLORS);
+
+  if (bkr->uv_layer[0] != '\0') {
+    Mesh *mesh = (Mesh *)ob->data;
+    if (CustomData_get_named_layer(&mesh->corner_data, CD_PROP_FLOAT2, bkr->uv_layer) == -1) {
+      BKE_reportf(reports,
+                  RPT_ERROR,
+                  "No UV layer named \"%s\" found in the object \"%s\"",
+                  bkr->uv_layer,
+                  ob->id.name + 2);
+      return nullptr;
+    }
+  }
+
+  BakeBatchObject *item = MEM_new<BakeBatchObject>(__func__);
+  item->ob = ob;
+  item->ob_eval = DEG_get_evaluated_object(depsgraph, ob);
+  item->me_eval = bake_mesh_new_from_object(depsgraph, item->ob_eval, preserve_origindex);
+
+  if (!bake_targets_init(bkr, &item->targets, ob, item->ob_eval, reports)) {
+    bake_batch_object_free(item);
+    return nullptr;
+  }
+
+  item->pixel_array = static_cast<BakePixel *>(
+      MEM_mallocN(sizeof(BakePixel) * item->targets.pixels_num, "bake pixels"));
+  bake_targets_populate_pixels(bkr, &item->targets, ob, item->me_eval, item->pixel_array);
+
+  return item;
+}
+
+static void bake_batch_object_output(const BakeAPIRender *bkr, BakeBatchObject *item)
+{
+  const double start_time = BLI_time_now_seconds();
+
+  if (bkr->pass_type == SCE_PASS_NORMAL) {
+    bake_normals_convert(
+        bkr, &item->targets, item->ob, item->ob_eval, item->me_eval, item->pixel_array);
+  }
+
+  item->ok = bake_targets_output(bkr,
+                                 &item->targets,
+                                 item->ob,
+                                 item->ob_eval,
+                                 item->me_eval,
+                                 item->pixel_array,
+                                 bkr->reports);
+
+  item->output_time = BLI_time_now_seconds() - start_time;
+}
+
+static void bake_batch_object_output_task(TaskPool *__restrict pool, void *taskdata)
+{
+  const BakeAPIRender *bkr = static_cast<const BakeAPIRender *>(BLI_task_pool_user_data(pool));
+  bake_batch_object_output(bkr, static_cast<BakeBatchObject *>(taskdata));
+}
+
+/** Wait for the output of an object to be written, and free it. */
+static bool bake_batch_object_finish(TaskPool *output_pool,
+                                     BakeBatchObject *item,
+                                     ReportList *reports)
+{
+  BLI_task_pool_work_and_wait(output_pool);
+
+  bake_targets_refresh(&item->targets);
+
+  const bool ok = item->ok;
+  if (ok) {
+    BKE_reportf(reports,
+                RPT_INFO,
+                "Baked object \"%s\" in %.2fs (writing output took %.2fs)",
+                item->ob->id.name + 2,
+                item->bake_time,
+                item->output_time);
+  }
+
+  bake_batch_object_free(item);
+  return ok;
+}
+
+static int bake_batch(BakeAPIRender *bkr, ReportList *reports)
+{
+  Render *re = bkr->render;
+  Main *bmain = bkr->main;
+  Scene *scene = bkr->scene;
+
+  RE_bake_engine_set_engine_parameters(re, bmain, scene);
+
+  if (!RE_bake_has_engine(re)) {
+    BKE_report(reports, RPT_ERROR, "Current render engine does not support baking");
+    return OPERATOR_CANCELLED;
+  }
+
+  Depsgraph *depsgraph = DEG_graph_new(bmain, scene, bkr->view_layer, DAG_EVAL_RENDER);
+  DEG_graph_build_from_view_layer(depsgraph);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  RE_bake_engine_begin(re, depsgraph);
+
+  /* Vertex colors are written to the original meshes, which is left to the baking thread. */
+  const bool use_output_pool = (bkr->target == R_BAKE_TARGET_IMAGE_TEXTURES);
+  TaskPool *output_pool = BLI_task_pool_create_background(bkr, TASK_PRIORITY_HIGH);
+  BakeBatchObject *item_output = nullptr;
+
+  int op_result = OPERATOR_FINISHED;
+  bkr->batch_num = bkr->selected_objects.size();
+
+  for (const int i : bkr->selected_objects.index_range()) {
+    Object *ob_iter = static_cast<Object *>(bkr->selected_objects[i].data);
+    bkr->batch_index = i;
+
+    if (G.is_break) {
+      op_result = OPERATOR_CANCELLED;
+      break;
+    }
+
+    BakeBatchObject *item = bake_batch_object_init(bkr, depsgraph, ob_iter, reports);
+    if (item == nullptr) {
+      op_result = OPERATOR_CANCELLED;
+      break;
+    }
+
+    /* If low poly is not renderable it should have failed long ago. */
+    BLI_assert((item->ob_eval->visibility_flag & OB_HIDE_RENDER) == 0);
+
+    const double start_time = BLI_time_now_seconds();
+    const bool ok = RE_bake_engine_object(re,
+                                          item->ob_eval,
+                                          0,
+                                          item->pixel_array,
+                                          &item->targets,
+                                          bkr->pass_type,
+                                          bkr->pass_filter,
+                                          item->targets.result);
+    item->bake_time = BLI_time_now_seconds() - start_time;
+
+    /* Output of the previous object was written while baking this one. */
+    if (item_output && !bake_batch_object_finish(output_pool, item_output, reports)) {
+      op_result = OPERATOR_CANCELLED;
+    }
+    item_output = nullptr;
+
+    if (!ok) {
+      BKE_reportf(reports, RPT_ERROR, "Problem baking object \"%s\"", ob_iter->id.name + 2);
+      bake_batch_object_free(item);
+      op_result = OPERATOR_CANCELLED;
+      break;
+    }
+
+    if (use_output_pool) {
+      BLI_task_pool_push(output_pool, bake_batch_object_output_task, item, false, nullptr);
+    }
+    else {
+      bake_batch_object_output(bkr, item);
+    }
+    item_output = item;
+  }
+
+  if (item_output && !bake_batch_object_finish(output_pool, item_output, reports)) {
+    op_result = OPERATOR_CANCELLED;
+  }
+
+  BLI_task_pool_free(output_pool);
+
+  bkr->batch_index = 0;
+  bkr->batch_num = 0;
+
+  RE_bake_engine_end(re);
+  DEG_graph_free(depsgraph);
+
+  return op_result;
+}
+
 /* Bake Operator */
 
 static void bake_init_api_data(wmOperator *op, bContext *C, BakeAPIRender *bkr)
@@ -1906,6 +2159,10 @@ static int bake_exec(bContext *C, wmOperator *op)
   if (bkr.is_selected_to_active) {
     result = bake(&bkr, bkr.ob, bkr.selected_objects, bkr.reports);
   }
+  else if (bake_batch_supported(&bkr)) {
+    bkr.is_clear = false;
+    result = bake_batch(&bkr, bkr.reports);
+  }
   else {
     bkr.is_clear = bkr.is_clear && bkr.selected_objects.size() == 1;
     for (const PointerRNA &ptr : bkr.selected_objects) {
@@ -1957,6 +2214,10 @@ static void bake_startjob(void *bkv, wmJobWorkerStatus *worker_status)
   if (bkr->is_selected_to_active) {
     bkr->result = bake(bkr, bkr->ob, bkr->selected_objects, bkr->reports);
   }
+  else if (bake_batch_supported(bkr)) {
+    bkr->is_clear = false;
+    bkr->result = bake_batch(bkr, bkr->reports);
+  }
   else {
     bkr->is_clear = bkr->is_clear && bkr->selected_objects.size() == 1;
     for (const PointerRNA &ptr : bkr->selected_objects) {
@@ -177,7 +177,7 @@ struct CombOperationExecutor {
     const IndexMask changed_curves_mask = IndexMask::from_bools(changed_curves, memory);
     self_->constraint_solver_.solve_step(*curves_orig_, changed_curves_mask, surface, transforms_);
 
-    curves_orig_->tag_positions_changed();
+    curves_orig_->tag_positions_changed(changed_curves_mask);
     DEG_id_tag_update(&curves_id_orig_->id, ID_RECALC_GEOMETRY);
     WM_main_add_notifier(NC_GEOM | ND_DATA, &curves_id_orig_->id);
     ED_region_tag_redraw(ctx_.region);
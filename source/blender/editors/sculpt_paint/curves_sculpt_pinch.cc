@@ -144,7 +144,7 @@ struct PinchOperationExecutor {
                               nullptr;
     self_->constraint_solver_.solve_step(*curves_, changed_curves_mask, surface, transforms_);
 
-    curves_->tag_positions_changed();
+    curves_->tag_positions_changed(changed_curves_mask);
     DEG_id_tag_update(&curves_id_->id, ID_RECALC_GEOMETRY);
     WM_main_add_notifier(NC_GEOM | ND_DATA, &curves_id_->id);
     ED_region_tag_redraw(ctx_.region);
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "BLI_function_ref.hh"
+
 #include "BKE_geometry_set.hh"
 
 namespace blender::geometry {
@@ -57,6 +59,10 @@ struct VariedDepthOptions {
  * The `id` attribute has special handling. If there is an id attribute on any component, the
  * output will contain an `id` attribute as well. The output id is generated by mixing/hashing ids
  * of instances and of the instanced geometry data.
+ *
+ * When the realized geometry has more elements than a single geometry can hold, it is split
+ * with #realize_instances_chunked into multiple geometries that are kept as instances with an
+ * identity transform instead.
  */
 bke::GeometrySet realize_instances(bke::GeometrySet geometry_set,
                                    const RealizeInstancesOptions &options);
@@ -69,4 +75,17 @@ bke::GeometrySet realize_instances(bke::GeometrySet geometry_set,
                                    const RealizeInstancesOptions &options,
                                    const VariedDepthOptions &varied_depth_option);
 
+/**
+ * Realize all instances like #realize_instances, but pass the realized geometry to \a fn in
+ * chunks instead of joining it into a single geometry. Every chunk contains the realized point
+ * cloud, mesh or curves of a range of consecutive instances, with at most \a max_chunk_elements
+ * elements unless a single instance is larger. Only one chunk exists at a time, so the fully
+ * realized geometry is never allocated. Indices in a chunk are local to it, generated ids are
+ * the same as with #realize_instances. Volumes and edit data are not passed to the callback.
+ */
+void realize_instances_chunked(bke::GeometrySet geometry_set,
+                               const RealizeInstancesOptions &options,
+                               int64_t max_chunk_elements,
+                               FunctionRef<void(bke::GeometrySet &chunk)> fn);
+
 }  // namespace blender::geometry
@@ -53,6 +53,11 @@ class ParamHandle {
 
   float aspect_y = 1.0f;
 
+  /* Charts with at least this many vertices are solved with conjugate gradients instead of a
+   * sparse factorization by LSCM, which scales better for very large charts. Zero to always
+   * factorize. */
+  int lscm_iterative_min_verts = 0;
+
   RNG *rng = nullptr;
   float blend = 0.0f;
 };
@@ -105,6 +110,8 @@ void uv_parametrizer_construct_end(ParamHandle *handle,
  * 2. Solve using pinned coordinates (cheap).
  * 3. End: clean up.
  *
+ * Charts are independent, begin and solve process them in parallel.
+ *
  * UV coordinates are allowed to change within begin/end, for quick re-solving.
  *
  * \{ */
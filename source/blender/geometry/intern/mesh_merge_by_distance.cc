@@ -7,10 +7,12 @@
 
 #include "BLI_array.hh"
 #include "BLI_bit_vector.hh"
+#include "BLI_enumerable_thread_specific.hh"
 #include "BLI_index_mask.hh"
-#include "BLI_kdtree.h"
 #include "BLI_math_vector.h"
 #include "BLI_offset_indices.hh"
+#include "BLI_spatial_hash.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "BKE_customdata.hh"
@@ -20,6 +22,8 @@
 #include "GEO_mesh_merge_by_distance.hh"
 #include "GEO_randomize.hh"
 
+#include "atomic_ops.h"
+
 #ifdef USE_WELD_DEBUG_TIME
 #  include "BLI_timeit.hh"
 
@@ -333,35 +337,52 @@ static Vector<WeldEdge> weld_edge_ctx_alloc_and_find_collapsed(Span<int2> edges,
                                                                int *r_edge_collapsed_len)
 {
   /* Edge Context. */
-  int edge_collapsed_len = 0;
-
-  Vector<WeldEdge> wedge;
-  wedge.reserve(edges.size());
-
-  for (const int i : edges.index_range()) {
-    int v1 = edges[i][0];
-    int v2 = edges[i][1];
-    int v_dest_1 = vert_dest_map[v1];
-    int v_dest_2 = vert_dest_map[v2];
-    if (v_dest_1 == OUT_OF_CONTEXT && v_dest_2 == OUT_OF_CONTEXT) {
-      r_edge_dest_map[i] = OUT_OF_CONTEXT;
-      continue;
-    }
-
-    const int vert_a = (v_dest_1 == OUT_OF_CONTEXT) ? v1 : v_dest_1;
-    const int vert_b = (v_dest_2 == OUT_OF_CONTEXT) ? v2 : v_dest_2;
+  threading::parallel_for(edges.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      const int v1 = edges[i][0];
+      const int v2 = edges[i][1];
+      const int v_dest_1 = vert_dest_map[v1];
+      const int v_dest_2 = vert_dest_map[v2];
+      if (v_dest_1 == OUT_OF_CONTEXT && v_dest_2 == OUT_OF_CONTEXT) {
+        r_edge_dest_map[i] = OUT_OF_CONTEXT;
+        continue;
+      }
 
-    if (vert_a == vert_b) {
-      r_edge_dest_map[i] = ELEM_COLLAPSED;
-      edge_collapsed_len++;
+      const int vert_a = (v_dest_1 == OUT_OF_CONTEXT) ? v1 : v_dest_1;
+      const int vert_b = (v_dest_2 == OUT_OF_CONTEXT) ? v2 : v_dest_2;
+      r_edge_dest_map[i] = (vert_a == vert_b) ? ELEM_COLLAPSED : i;
     }
-    else {
-      wedge.append({i, vert_a, vert_b});
-      r_edge_dest_map[i] = i;
-    }
-  }
+  });
 
-  *r_edge_collapsed_len = edge_collapsed_len;
+  *r_edge_collapsed_len = threading::parallel_reduce(
+      edges.index_range(),
+      4096,
+      0,
+      [&](const IndexRange range, int count) {
+        for (const int i : range) {
+          count += r_edge_dest_map[i] == ELEM_COLLAPSED;
+        }
+        return count;
+      },
+      std::plus<int>());
+
+  /* Context edges are stored in order of their original index. */
+  IndexMaskMemory memory;
+  const IndexMask wedge_mask = IndexMask::from_predicate(
+      edges.index_range(), GrainSize(4096), memory, [&](const int i) {
+        return r_edge_dest_map[i] >= 0;
+      });
+
+  Vector<WeldEdge> wedge(wedge_mask.size());
+  wedge_mask.foreach_index(GrainSize(4096), [&](const int i, const int pos) {
+    const int v1 = edges[i][0];
+    const int v2 = edges[i][1];
+    const int v_dest_1 = vert_dest_map[v1];
+    const int v_dest_2 = vert_dest_map[v2];
+    wedge[pos] = {i,
+                  (v_dest_1 == OUT_OF_CONTEXT) ? v1 : v_dest_1,
+                  (v_dest_2 == OUT_OF_CONTEXT) ? v2 : v_dest_2};
+  });
   return wedge;
 }
 
@@ -380,104 +401,79 @@ static void weld_edge_find_doubles(Span<WeldEdge> weld_edges,
                                    int *r_edge_double_kill_len)
 {
   /* Setup Edge Overlap. */
-  int edge_double_kill_len = 0;
-
   if (weld_edges.is_empty()) {
-    *r_edge_double_kill_len = edge_double_kill_len;
+    *r_edge_double_kill_len = 0;
     return;
   }
 
   /* Add +1 to allow calculation of the length of the last group. */
   Array<int> v_links(mvert_num + 1, 0);
-
-  for (const WeldEdge &we : weld_edges) {
-    BLI_assert(r_edge_dest_map[we.edge_orig] != ELEM_COLLAPSED);
-    BLI_assert(we.vert_a != we.vert_b);
-    v_links[we.vert_a]++;
-    v_links[we.vert_b]++;
-  }
-
-  int link_len = 0;
-  for (const int i : IndexRange(mvert_num)) {
-    link_len += v_links[i];
-    v_links[i] = link_len;
-  }
-  v_links.last() = link_len;
-
-  BLI_assert(link_len > 0);
-  Array<int> link_edge_buffer(link_len);
-
-  /* Use a reverse for loop to ensure that indexes are assigned in ascending order. */
-  for (int i = weld_edges.size(); i--;) {
-    const WeldEdge &we = weld_edges[i];
-    BLI_assert(r_edge_dest_map[we.edge_orig] != ELEM_COLLAPSED);
-    int dst_vert_a = we.vert_a;
-    int dst_vert_b = we.vert_b;
-
-    link_edge_buffer[--v_links[dst_vert_a]] = i;
-    link_edge_buffer[--v_links[dst_vert_b]] = i;
-  }
-
-  for (const int i : weld_edges.index_range()) {
-    const WeldEdge &we = weld_edges[i];
-    BLI_assert(r_edge_dest_map[we.edge_orig] != OUT_OF_CONTEXT);
-    if (r_edge_dest_map[we.edge_orig] != we.edge_orig) {
-      /* Already a duplicate. */
-      continue;
-    }
-
-    int dst_vert_a = we.vert_a;
-    int dst_vert_b = we.vert_b;
-
-    const int link_a = v_links[dst_vert_a];
-    const int link_b = v_links[dst_vert_b];
-
-    int edges_len_a = v_links[dst_vert_a + 1] - link_a;
-    int edges_len_b = v_links[dst_vert_b + 1] - link_b;
-
-    int edge_orig = we.edge_orig;
-    if (edges_len_a <= 1 || edges_len_b <= 1) {
-      /* This edge would form a group with only one element.
-       * For better performance, mark these edges and avoid forming these groups. */
-      r_edge_dest_map[edge_orig] = OUT_OF_CONTEXT;
-      continue;
-    }
-
-    int *edges_ctx_a = &link_edge_buffer[link_a];
-    int *edges_ctx_b = &link_edge_buffer[link_b];
-
-    const int edge_double_len_prev = edge_double_kill_len;
-    for (; edges_len_a--; edges_ctx_a++) {
-      int e_ctx_a = *edges_ctx_a;
-      if (e_ctx_a == i) {
-        continue;
-      }
-      while (edges_len_b && *edges_ctx_b < e_ctx_a) {
-        edges_ctx_b++;
-        edges_len_b--;
-      }
-      if (edges_len_b == 0) {
-        break;
+  threading::parallel_for(weld_edges.index_range(), 4096, [&](const IndexRange range) {
+    for (const WeldEdge &we : weld_edges.slice(range)) {
+      BLI_assert(r_edge_dest_map[we.edge_orig] != ELEM_COLLAPSED);
+      BLI_assert(we.vert_a != we.vert_b);
+      atomic_add_and_fetch_int32(&v_links[we.vert_a], 1);
+      atomic_add_and_fetch_int32(&v_links[we.vert_b], 1);
+    }
+  });
+  const OffsetIndices<int> links = offset_indices::accumulate_counts_to_offsets(v_links);
+
+  /* The edges linked to each vertex are in arbitrary order, they are only searched for the
+   * lowest index. */
+  Array<int> link_edge_buffer(links.total_size());
+  Array<int> link_counts(mvert_num, 0);
+  threading::parallel_for(weld_edges.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      const WeldEdge &we = weld_edges[i];
+      for (const int vert : {we.vert_a, we.vert_b}) {
+        const int index_in_group = atomic_fetch_and_add_int32(&link_counts[vert], 1);
+        link_edge_buffer[links[vert][index_in_group]] = i;
       }
-      int e_ctx_b = *edges_ctx_b;
-      if (e_ctx_a == e_ctx_b) {
-        const WeldEdge &we_b = weld_edges[e_ctx_b];
-        BLI_assert(ELEM(we_b.vert_a, dst_vert_a, dst_vert_b));
-        BLI_assert(ELEM(we_b.vert_b, dst_vert_a, dst_vert_b));
-        BLI_assert(we_b.edge_orig != edge_orig);
-        BLI_assert(r_edge_dest_map[we_b.edge_orig] == we_b.edge_orig);
-        r_edge_dest_map[we_b.edge_orig] = edge_orig;
-        edge_double_kill_len++;
-      }
-    }
-    if (edge_double_len_prev == edge_double_kill_len) {
-      /* This edge would form a group with only one element.
-       * For better performance, mark these edges and avoid forming these groups. */
-      r_edge_dest_map[edge_orig] = OUT_OF_CONTEXT;
     }
-  }
+  });
+
+  /* Edges with the same vertices form a group, the edge with the lowest index is the target of
+   * the others. This gives the same result as merging in order of the edge index. Edges that
+   * would form a group with only one element are marked, so these groups are not formed later. */
+  *r_edge_double_kill_len = threading::parallel_reduce(
+      weld_edges.index_range(),
+      1024,
+      0,
+      [&](const IndexRange range, int edge_double_kill_len) {
+        for (const int i : range) {
+          const WeldEdge &we = weld_edges[i];
+          BLI_assert(r_edge_dest_map[we.edge_orig] == we.edge_orig);
+
+          /* Search the shorter list of edges linked to either vertex. */
+          const IndexRange links_a = links[we.vert_a];
+          const IndexRange links_b = links[we.vert_b];
+          const Span<int> edges_ctx = link_edge_buffer.as_span().slice(
+              links_a.size() <= links_b.size() ? links_a : links_b);
+
+          int group_first = i;
+          int group_len = 0;
+          for (const int e_ctx : edges_ctx) {
+            const WeldEdge &we_b = weld_edges[e_ctx];
+            if ((we_b.vert_a == we.vert_a && we_b.vert_b == we.vert_b) ||
+                (we_b.vert_a == we.vert_b && we_b.vert_b == we.vert_a))
+            {
+              group_first = std::min(group_first, e_ctx);
+              group_len++;
+            }
+          }
+          BLI_assert(group_len >= 1);
 
-  *r_edge_double_kill_len = edge_double_kill_len;
+          if (group_len == 1) {
+            r_edge_dest_map[we.edge_orig] = OUT_OF_CONTEXT;
+          }
+          else if (group_first != i) {
+            r_edge_dest_map[we.edge_orig] = weld_edges[group_first].edge_orig;
+            edge_double_kill_len++;
+          }
+        }
+        return edge_double_kill_len;
+      },
+      std::plus<int>());
 }
 
 /** \} */
@@ -580,103 +576,106 @@ static void weld_poly_loop_ctx_alloc(const OffsetIndices<int> faces,
   Span<int> vert_dest_map = r_weld_mesh->vert_dest_map;
   Span<int> edge_dest_map = r_weld_mesh->edge_dest_map;
 
+  /* A loop is in the context if its vertex or the next vertex of the face will be merged. */
+  const auto is_vert_ctx = [&](const int vert) { return vert_dest_map[vert] != OUT_OF_CONTEXT; };
+
+  /* Count the context loops of every face, so their position in the context arrays is known
+   * before filling them in parallel. */
+  Array<int> loop_ctx_offsets_data(faces.size() + 1);
+  threading::parallel_for(faces.index_range(), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      const Span<int> face_verts = corner_verts.slice(faces[i]);
+      bool is_vert_next_ctx = is_vert_ctx(face_verts.first());
+      int loop_ctx_len = 0;
+      for (int j = face_verts.size(); j--;) {
+        const bool is_vert_cur_ctx = is_vert_ctx(face_verts[j]);
+        loop_ctx_len += is_vert_cur_ctx || is_vert_next_ctx;
+        is_vert_next_ctx = is_vert_cur_ctx;
+      }
+      loop_ctx_offsets_data[i] = loop_ctx_len;
+    }
+  });
+
+  IndexMaskMemory memory;
+  const IndexMask faces_ctx = IndexMask::from_predicate(
+      faces.index_range(), GrainSize(4096), memory, [&](const int i) {
+        return loop_ctx_offsets_data[i] != 0;
+      });
+  const OffsetIndices<int> loop_ctx_offsets = offset_indices::accumulate_counts_to_offsets(
+      loop_ctx_offsets_data);
+
   /* Loop/Poly Context. */
   Array<int> loop_map(corner_verts.size());
   Array<int> face_map(faces.size());
-  int wloop_len = 0;
-  int wpoly_len = 0;
-  int max_ctx_poly_len = 4;
-
-  Vector<WeldLoop> wloop;
-  wloop.reserve(corner_verts.size());
-
-  Vector<WeldPoly> wpoly;
-  wpoly.reserve(faces.size());
-
-  int maybe_new_poly = 0;
-
-  for (const int i : faces.index_range()) {
-    const int loopstart = faces[i].start();
-    const int totloop = faces[i].size();
-    const int loop_end = loopstart + totloop - 1;
-    int v_first = corner_verts[loopstart];
-    int v_dest_first = vert_dest_map[v_first];
-    bool is_vert_first_ctx = v_dest_first != OUT_OF_CONTEXT;
+  Vector<WeldLoop> wloop(loop_ctx_offsets.total_size());
+  Vector<WeldPoly> wpoly(faces_ctx.size());
 
-    int v_next = v_first;
-    int v_dest_next = v_dest_first;
-    bool is_vert_next_ctx = is_vert_first_ctx;
-
-    int prev_wloop_len = wloop_len;
-    for (const int loop_orig : faces[i]) {
-      int v = v_next;
-      int v_dest = v_dest_next;
-      bool is_vert_ctx = is_vert_next_ctx;
-
-      int loop_next;
-      if (loop_orig != loop_end) {
-        loop_next = loop_orig + 1;
-        v_next = corner_verts[loop_next];
-        v_dest_next = vert_dest_map[v_next];
-        is_vert_next_ctx = v_dest_next != OUT_OF_CONTEXT;
-      }
-      else {
-        loop_next = loopstart;
-        v_next = v_first;
-        v_dest_next = v_dest_first;
-        is_vert_next_ctx = is_vert_first_ctx;
+  threading::parallel_for(faces.index_range(), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      const IndexRange face = faces[i];
+      face_map[i] = OUT_OF_CONTEXT;
+      if (loop_ctx_offsets[i].is_empty()) {
+        loop_map.as_mutable_span().slice(face).fill(OUT_OF_CONTEXT);
+        continue;
       }
 
-      if (is_vert_ctx || is_vert_next_ctx) {
-        int e = corner_edges[loop_orig];
-        int e_dest = edge_dest_map[e];
-        bool is_edge_ctx = e_dest != OUT_OF_CONTEXT;
+      int wloop_index = loop_ctx_offsets[i].start();
+      for (const int loop_orig : face) {
+        const int loop_next = (loop_orig == face.last()) ? face.start() : loop_orig + 1;
+        const int v = corner_verts[loop_orig];
+        const int v_dest = vert_dest_map[v];
+        if (v_dest == OUT_OF_CONTEXT && !is_vert_ctx(corner_verts[loop_next])) {
+          loop_map[loop_orig] = OUT_OF_CONTEXT;
+          continue;
+        }
+
+        const int e = corner_edges[loop_orig];
+        const int e_dest = edge_dest_map[e];
 
-        wloop.increase_size_by_unchecked(1);
-        WeldLoop &wl = wloop.last();
-        wl.vert = is_vert_ctx ? v_dest : v;
-        wl.edge = is_edge_ctx ? e_dest : e;
+        WeldLoop &wl = wloop[wloop_index];
+        wl.vert = (v_dest != OUT_OF_CONTEXT) ? v_dest : v;
+        wl.edge = (e_dest != OUT_OF_CONTEXT) ? e_dest : e;
         wl.loop_orig = loop_orig;
         wl.loop_next = loop_next;
 
-        loop_map[loop_orig] = wloop_len++;
-      }
-      else {
-        loop_map[loop_orig] = OUT_OF_CONTEXT;
+        loop_map[loop_orig] = wloop_index++;
       }
+      BLI_assert(wloop_index == loop_ctx_offsets[i].one_after_last());
     }
+  });
 
-    if (wloop_len != prev_wloop_len) {
-      int loop_ctx_len = wloop_len - prev_wloop_len;
-      wpoly.increase_size_by_unchecked(1);
-
-      WeldPoly &wp = wpoly.last();
-      wp.poly_dst = OUT_OF_CONTEXT;
-      wp.poly_orig = i;
-      wp.loop_start = loopstart;
-      wp.loop_end = loop_end;
+  faces_ctx.foreach_index(GrainSize(4096), [&](const int i, const int pos) {
+    const IndexRange face = faces[i];
+    WeldPoly &wp = wpoly[pos];
+    wp.poly_dst = OUT_OF_CONTEXT;
+    wp.poly_orig = i;
+    wp.loop_start = face.start();
+    wp.loop_end = face.last();
 
-      wp.loop_ctx_start = prev_wloop_len;
-      wp.loop_ctx_len = loop_ctx_len;
+    wp.loop_ctx_start = loop_ctx_offsets[i].start();
+    wp.loop_ctx_len = loop_ctx_offsets[i].size();
 
 #ifdef USE_WELD_DEBUG
-      wp.loop_len = totloop;
+    wp.loop_len = face.size();
 #endif
 
-      face_map[i] = wpoly_len++;
-      if (totloop > 5 && loop_ctx_len > 1) {
-        /* We could be smarter here and actually count how many new polygons will be created.
-         * But counting this can be inefficient as it depends on the number of non-consecutive
-         * self face merges. For now just estimate a maximum value. */
-        int max_new = std::min((totloop / 3), loop_ctx_len) - 1;
-        maybe_new_poly += max_new;
-        CLAMP_MIN(max_ctx_poly_len, totloop);
-      }
-    }
-    else {
-      face_map[i] = OUT_OF_CONTEXT;
+    face_map[i] = pos;
+  });
+
+  int maybe_new_poly = 0;
+  int max_ctx_poly_len = 4;
+  faces_ctx.foreach_index([&](const int i) {
+    const int totloop = faces[i].size();
+    const int loop_ctx_len = loop_ctx_offsets[i].size();
+    if (totloop > 5 && loop_ctx_len > 1) {
+      /* We could be smarter here and actually count how many new polygons will be created.
+       * But counting this can be inefficient as it depends on the number of non-consecutive
+       * self face merges. For now just estimate a maximum value. */
+      int max_new = std::min((totloop / 3), loop_ctx_len) - 1;
+      maybe_new_poly += max_new;
+      CLAMP_MIN(max_ctx_poly_len, totloop);
     }
-  }
+  });
 
   wpoly.reserve(wpoly.size() + maybe_new_poly);
 
@@ -1157,34 +1156,46 @@ static void weld_poly_find_doubles(const Span<int> corner_verts,
   WeldPoly *wpoly = r_weld_mesh->wpoly.data();
   MutableSpan<WeldLoop> wloop = r_weld_mesh->wloop;
   Span<int> loop_map = r_weld_mesh->loop_map;
-  int face_index = 0;
 
   const int face_len = r_weld_mesh->wpoly.size();
-  Array<int> poly_offs_(face_len + 1);
-  Vector<int> new_corner_edges;
-  new_corner_edges.reserve(corner_verts.size() - r_weld_mesh->loop_kill_len);
-
-  for (const WeldPoly &wp : r_weld_mesh->wpoly) {
-    poly_offs_[face_index++] = new_corner_edges.size();
 
-    WeldLoopOfPolyIter iter;
-    if (!weld_iter_loop_of_poly_begin(
-            iter, wp, wloop, corner_verts, corner_edges, loop_map, nullptr))
-    {
-      continue;
+  /* Gather the edges of the remaining polygons, first counting them to fill them in parallel. */
+  Array<int> poly_offs_(face_len + 1);
+  threading::parallel_for(IndexRange(face_len), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      const WeldPoly &wp = wpoly[i];
+      poly_offs_[i] = 0;
+      WeldLoopOfPolyIter iter;
+      if (!weld_iter_loop_of_poly_begin(
+              iter, wp, wloop, corner_verts, corner_edges, loop_map, nullptr))
+      {
+        continue;
+      }
+      if (wp.poly_dst != OUT_OF_CONTEXT) {
+        continue;
+      }
+      do {
+        poly_offs_[i]++;
+      } while (weld_iter_loop_of_poly_next(iter));
     }
+  });
+  OffsetIndices<int> poly_offs = offset_indices::accumulate_counts_to_offsets(poly_offs_);
 
-    if (wp.poly_dst != OUT_OF_CONTEXT) {
-      continue;
+  Array<int> new_corner_edges(poly_offs.total_size());
+  threading::parallel_for(IndexRange(face_len), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      if (poly_offs[i].is_empty()) {
+        continue;
+      }
+      WeldLoopOfPolyIter iter;
+      weld_iter_loop_of_poly_begin(
+          iter, wpoly[i], wloop, corner_verts, corner_edges, loop_map, nullptr);
+      int corner = poly_offs[i].start();
+      do {
+        new_corner_edges[corner++] = iter.e;
+      } while (weld_iter_loop_of_poly_next(iter));
     }
-
-    do {
-      new_corner_edges.append(iter.e);
-    } while (weld_iter_loop_of_poly_next(iter));
-  }
-
-  poly_offs_[face_len] = new_corner_edges.size();
-  OffsetIndices<int> poly_offs(poly_offs_);
+  });
 
   Vector<int> doubles_offsets;
   Array<int> doubles_buffer;
@@ -1455,8 +1466,8 @@ static void merge_customdata_all(const CustomData *source,
   Array<int> groups_buffer;
   if (do_mix_data) {
     r_final_map.reinitialize(source_size + 1);
-
-    /* Be careful when setting values to this array as it uses the same buffer as `r_final_map`. */
+    /* The group offsets use the same buffer as `r_final_map`, which is only written once all
+     * groups have been welded. */
     groups_offs_ = r_final_map;
     merge_groups_create(dest_map, double_elems, groups_offs_, groups_buffer);
   }
@@ -1465,69 +1476,60 @@ static void merge_customdata_all(const CustomData *source,
   }
   OffsetIndices<int> groups_offs(groups_offs_);
 
-  bool finalize_map = false;
-  int dest_index = 0;
-  for (int i = 0; i < source_size; i++) {
-    const int source_index = i;
-    int count = 0;
-    while (i < source_size && dest_map[i] == OUT_OF_CONTEXT) {
-      r_final_map[i] = dest_index + count;
-      count++;
-      i++;
-    }
-    if (count) {
-      CustomData_copy_data(source, dest, source_index, dest_index, count);
-      dest_index += count;
-    }
-    if (i == source_size) {
-      break;
-    }
-    if (dest_map[i] == i) {
-      if (do_mix_data) {
-        const IndexRange grp_buffer_range = groups_offs[i];
-        customdata_weld(source,
-                        dest,
-                        &groups_buffer[grp_buffer_range.start()],
-                        grp_buffer_range.size(),
-                        dest_index);
-      }
-      else {
-        CustomData_copy_data(source, dest, i, dest_index, 1);
-      }
-      r_final_map[i] = dest_index;
-      dest_index++;
-    }
-    else if (dest_map[i] == ELEM_COLLAPSED) {
-      /* Any value will do. This field must not be accessed anymore. */
-      r_final_map[i] = 0;
-    }
-    else {
+  /* Elements that are not merged and the targets of merged elements are kept in the same order,
+   * so their new index is their position in the mask. */
+  IndexMaskMemory memory;
+  const IndexMask kept_elems = IndexMask::from_predicate(
+      dest_map.index_range(), GrainSize(4096), memory, [&](const int i) {
+        return ELEM(dest_map[i], OUT_OF_CONTEXT, i);
+      });
+  BLI_assert(kept_elems.size() == dest_size);
+
+  kept_elems.foreach_segment(
+      GrainSize(4096), [&](const IndexMaskSegment segment, const int64_t segment_pos) {
+        for (int64_t pos = 0; pos < segment.size();) {
+          const int i = segment[pos];
+          const int dest_index = segment_pos + pos;
+          if (do_mix_data && dest_map[i] == i) {
+            const IndexRange grp_buffer_range = groups_offs[i];
+            customdata_weld(source,
+                            dest,
+                            &groups_buffer[grp_buffer_range.start()],
+                            grp_buffer_range.size(),
+                            dest_index);
+            pos++;
+            continue;
+          }
+          /* Copy consecutive elements that are not welded at once. */
+          int count = 1;
+          while (pos + count < segment.size() && segment[pos + count] == i + count &&
+                 !(do_mix_data && dest_map[i + count] == i + count))
+          {
+            count++;
+          }
+          CustomData_copy_data(source, dest, i, dest_index, count);
+          pos += count;
+        }
+      });
+
+  kept_elems.foreach_index_optimized<int>(
+      GrainSize(4096), [&](const int i, const int pos) { r_final_map[i] = pos; });
+
+  /* Merged elements take the new index of their target, which has to be set first. */
+  threading::parallel_for(dest_map.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
       const int elem_dest = dest_map[i];
-      BLI_assert(elem_dest != OUT_OF_CONTEXT);
-      BLI_assert(dest_map[elem_dest] == elem_dest);
-      if (elem_dest < i) {
-        r_final_map[i] = r_final_map[elem_dest];
-        BLI_assert(r_final_map[i] < dest_size);
-      }
-      else {
-        /* Mark as negative to set at the end. */
-        r_final_map[i] = -elem_dest;
-        finalize_map = true;
+      if (elem_dest == ELEM_COLLAPSED) {
+        /* Any value will do. This field must not be accessed anymore. */
+        r_final_map[i] = 0;
       }
-    }
-  }
-
-  if (finalize_map) {
-    for (const int i : r_final_map.index_range()) {
-      if (r_final_map[i] < 0) {
-        r_final_map[i] = r_final_map[-r_final_map[i]];
+      else if (!ELEM(elem_dest, OUT_OF_CONTEXT, i)) {
+        BLI_assert(dest_map[elem_dest] == elem_dest);
+        r_final_map[i] = r_final_map[elem_dest];
         BLI_assert(r_final_map[i] < dest_size);
       }
-      BLI_assert(r_final_map[i] >= 0);
     }
-  }
-
-  BLI_assert(dest_index == dest_size);
+  });
 }
 
 /** \} */
@@ -1590,84 +1592,108 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
                        do_mix_data,
                        edge_final_map);
 
-  for (int2 &edge : dst_edges) {
-    edge[0] = vert_final_map[edge[0]];
-    edge[1] = vert_final_map[edge[1]];
-    BLI_assert(edge[0] != edge[1]);
-    BLI_assert(IN_RANGE_INCL(edge[0], 0, result_nverts - 1));
-    BLI_assert(IN_RANGE_INCL(edge[1], 0, result_nverts - 1));
-  }
+  threading::parallel_for(dst_edges.index_range(), 4096, [&](const IndexRange range) {
+    for (int2 &edge : dst_edges.slice(range)) {
+      edge[0] = vert_final_map[edge[0]];
+      edge[1] = vert_final_map[edge[1]];
+      BLI_assert(edge[0] != edge[1]);
+      BLI_assert(IN_RANGE_INCL(edge[0], 0, result_nverts - 1));
+      BLI_assert(IN_RANGE_INCL(edge[1], 0, result_nverts - 1));
+    }
+  });
 
   /* Faces/Loops. */
 
-  int r_i = 0;
-  int loop_cur = 0;
-  Array<int, 64> group_buffer(weld_mesh.max_face_len);
-  for (const int i : src_faces.index_range()) {
-    const int loop_start = loop_cur;
-    const int poly_ctx = weld_mesh.face_map[i];
-    if (poly_ctx == OUT_OF_CONTEXT) {
-      int mp_loop_len = src_faces[i].size();
-      CustomData_copy_data(
-          &mesh.corner_data, &result->corner_data, src_faces[i].start(), loop_cur, mp_loop_len);
-      for (; mp_loop_len--; loop_cur++) {
-        dst_corner_verts[loop_cur] = vert_final_map[dst_corner_verts[loop_cur]];
-        dst_corner_edges[loop_cur] = edge_final_map[dst_corner_edges[loop_cur]];
-      }
+  /* The original faces are followed by the new polygons created by splitting. Count the
+   * corners of every resulting face first, so all faces can be written in parallel. */
+  const IndexRange wpoly_new_range = weld_mesh.wpoly.index_range().take_back(
+      weld_mesh.wpoly_new_len);
+  const auto wpoly_from_face = [&](const int i) -> const WeldPoly * {
+    if (i >= src_faces.size()) {
+      return &weld_mesh.wpoly[wpoly_new_range[i - src_faces.size()]];
     }
-    else {
-      const WeldPoly &wp = weld_mesh.wpoly[poly_ctx];
-      WeldLoopOfPolyIter iter;
-      if (!weld_iter_loop_of_poly_begin(iter,
-                                        wp,
-                                        weld_mesh.wloop,
-                                        src_corner_verts,
-                                        src_corner_edges,
-                                        weld_mesh.loop_map,
-                                        group_buffer.data()))
-      {
-        continue;
-      }
+    const int poly_ctx = weld_mesh.face_map[i];
+    return (poly_ctx == OUT_OF_CONTEXT) ? nullptr : &weld_mesh.wpoly[poly_ctx];
+  };
 
-      if (wp.poly_dst != OUT_OF_CONTEXT) {
-        continue;
-      }
-      do {
-        customdata_weld(&mesh.corner_data,
-                        &result->corner_data,
-                        group_buffer.data(),
-                        iter.group_len,
-                        loop_cur);
-        dst_corner_verts[loop_cur] = vert_final_map[iter.v];
-        dst_corner_edges[loop_cur] = edge_final_map[iter.e];
-        loop_cur++;
-      } while (weld_iter_loop_of_poly_next(iter));
+  /* Number of corners of the resulting face, zero when the face is removed. */
+  const auto dst_face_size = [&](const int i) {
+    const WeldPoly *wp = wpoly_from_face(i);
+    if (wp == nullptr) {
+      return int(src_faces[i].size());
     }
-
-    CustomData_copy_data(&mesh.face_data, &result->face_data, i, r_i, 1);
-    dst_face_offsets[r_i] = loop_start;
-    r_i++;
-  }
-
-  /* New Polygons. */
-  for (const int i : weld_mesh.wpoly.index_range().take_back(weld_mesh.wpoly_new_len)) {
-    const WeldPoly &wp = weld_mesh.wpoly[i];
-    const int loop_start = loop_cur;
     WeldLoopOfPolyIter iter;
     if (!weld_iter_loop_of_poly_begin(iter,
-                                      wp,
+                                      *wp,
                                       weld_mesh.wloop,
                                       src_corner_verts,
                                       src_corner_edges,
                                       weld_mesh.loop_map,
-                                      group_buffer.data()))
+                                      nullptr))
     {
-      continue;
+      return 0;
+    }
+    if (wp->poly_dst != OUT_OF_CONTEXT) {
+      return 0;
     }
+    int size = 0;
+    do {
+      size++;
+    } while (weld_iter_loop_of_poly_next(iter));
+    return size;
+  };
 
-    if (wp.poly_dst != OUT_OF_CONTEXT) {
-      continue;
+  Array<int> face_offsets_data(src_faces.size() + wpoly_new_range.size() + 1);
+  threading::parallel_for(
+      face_offsets_data.index_range().drop_back(1), 1024, [&](const IndexRange range) {
+        for (const int i : range) {
+          face_offsets_data[i] = dst_face_size(i);
+        }
+      });
+
+  IndexMaskMemory memory;
+  const IndexMask dst_faces_mask = IndexMask::from_predicate(
+      face_offsets_data.index_range().drop_back(1), GrainSize(4096), memory, [&](const int i) {
+        return face_offsets_data[i] != 0;
+      });
+  const OffsetIndices<int> dst_corners = offset_indices::accumulate_counts_to_offsets(
+      face_offsets_data);
+  BLI_assert(dst_faces_mask.size() == result_nfaces);
+  BLI_assert(dst_corners.total_size() == result_nloops);
+
+  threading::EnumerableThreadSpecific<Array<int, 64>> group_buffers(
+      [&]() { return Array<int, 64>(weld_mesh.max_face_len); });
+  dst_faces_mask.foreach_index(GrainSize(1024), [&](const int i, const int r_i) {
+    const IndexRange dst_face = dst_corners[i];
+    dst_face_offsets[r_i] = dst_face.start();
+    if (i < src_faces.size()) {
+      CustomData_copy_data(&mesh.face_data, &result->face_data, i, r_i, 1);
+    }
+
+    const WeldPoly *wp = wpoly_from_face(i);
+    if (wp == nullptr) {
+      CustomData_copy_data(&mesh.corner_data,
+                           &result->corner_data,
+                           src_faces[i].start(),
+                           dst_face.start(),
+                           dst_face.size());
+      for (const int loop_cur : dst_face) {
+        dst_corner_verts[loop_cur] = vert_final_map[dst_corner_verts[loop_cur]];
+        dst_corner_edges[loop_cur] = edge_final_map[dst_corner_edges[loop_cur]];
+      }
+      return;
     }
+
+    Array<int, 64> &group_buffer = group_buffers.local();
+    WeldLoopOfPolyIter iter;
+    weld_iter_loop_of_poly_begin(iter,
+                                 *wp,
+                                 weld_mesh.wloop,
+                                 src_corner_verts,
+                                 src_corner_edges,
+                                 weld_mesh.loop_map,
+                                 group_buffer.data());
+    int loop_cur = dst_face.start();
     do {
       customdata_weld(
           &mesh.corner_data, &result->corner_data, group_buffer.data(), iter.group_len, loop_cur);
@@ -1675,13 +1701,8 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
       dst_corner_edges[loop_cur] = edge_final_map[iter.e];
       loop_cur++;
     } while (weld_iter_loop_of_poly_next(iter));
-
-    dst_face_offsets[r_i] = loop_start;
-    r_i++;
-  }
-
-  BLI_assert(int(r_i) == result_nfaces);
-  BLI_assert(loop_cur == result_nloops);
+    BLI_assert(loop_cur == dst_face.one_after_last());
+  });
 
   debug_randomize_mesh_order(result);
 
@@ -1700,15 +1721,10 @@ std::optional<Mesh *> mesh_merge_by_distance_all(const Mesh &mesh,
 {
   Array<int> vert_dest_map(mesh.verts_num, OUT_OF_CONTEXT);
 
-  KDTree_3d *tree = BLI_kdtree_3d_new(selection.size());
-
   const Span<float3> positions = mesh.vert_positions();
-  selection.foreach_index([&](const int64_t i) { BLI_kdtree_3d_insert(tree, i, positions[i]); });
-
-  BLI_kdtree_3d_balance(tree);
-  const int vert_kill_len = BLI_kdtree_3d_calc_duplicates_fast(
-      tree, merge_distance, true, vert_dest_map.data());
-  BLI_kdtree_3d_free(tree);
+  const SpatialHash hash(positions, selection, merge_distance);
+  const int vert_kill_len = spatial_hash_calc_duplicates(
+      hash, positions, selection, merge_distance, vert_dest_map);
 
   if (vert_kill_len == 0) {
     return std::nullopt;
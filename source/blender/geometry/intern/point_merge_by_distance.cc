@@ -35,7 +35,8 @@ PointCloud *point_merge_by_distance(const PointCloud &src_points,
 
   /* Find the duplicates in the KD tree. Because the tree only contains the selected points, the
    * resulting indices are indices into the selection, rather than indices of the source point
-   * cloud. */
+   * cloud. The merge targets depend on the order of the KD tree, unlike the spatial hash used for
+   * meshes, so it is kept to avoid changing the results of existing files. */
   Array<int> selection_merge_indices(selection.size(), -1);
   const int duplicate_count = BLI_kdtree_3d_calc_duplicates_fast(
       tree, merge_distance, false, selection_merge_indices.data());
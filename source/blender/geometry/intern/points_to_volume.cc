@@ -2,7 +2,14 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include "BLI_array.hh"
+#include "BLI_bounds_types.hh"
+#include "BLI_index_mask.hh"
 #include "BLI_math_matrix.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_offset_indices.hh"
+#include "BLI_sort.hh"
+#include "BLI_task.hh"
 
 #include "BKE_volume.hh"
 #include "BKE_volume_grid.hh"
@@ -12,66 +19,232 @@
 
 #ifdef WITH_OPENVDB
 #  include <openvdb/openvdb.h>
-#  include <openvdb/tools/LevelSetUtil.h>
-#  include <openvdb/tools/ParticlesToLevelSet.h>
+#  include <openvdb/tools/Prune.h>
 
 namespace blender::geometry {
 
-/* Implements the interface required by #openvdb::tools::ParticlesToLevelSet. */
-class OpenVDBParticleList {
- public:
-  using PosType = openvdb::Vec3R;
-
- private:
-  Span<float3> positions_;
-  Span<float> radii_;
-  float voxel_size_inv_;
-
- public:
-  OpenVDBParticleList(const Span<float3> positions,
-                      const Span<float> radii,
-                      const float voxel_size)
-      : positions_(positions), radii_(radii), voxel_size_inv_(math::rcp(voxel_size))
-  {
-    BLI_assert(voxel_size > 0.0f);
-  }
+using FloatLeaf = openvdb::FloatTree::LeafNodeType;
+
+/**
+ * Half width of the narrow band in voxels. Same as #openvdb::tools::ParticlesToLevelSet for a
+ * grid with a background value of one voxel, which the grids built here also use.
+ */
+static constexpr float half_width = 1.0f;
+
+static int3 leaf_origin(const int3 &voxel)
+{
+  const int mask = ~(int(FloatLeaf::DIM) - 1);
+  return int3(voxel.x & mask, voxel.y & mask, voxel.z & mask);
+}
 
-  size_t size() const
-  {
-    return size_t(positions_.size());
+static bool leaf_less(const int3 &a, const int3 &b)
+{
+  return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+}
+
+/** Keep the minimum signed distance to the sphere for every voxel of the leaf inside its reach. */
+static void rasterize_sphere(const float3 &center,
+                             const float radius,
+                             const int3 &origin,
+                             MutableSpan<float> sdf)
+{
+  const float reach = radius + half_width;
+  const int3 min = math::max(int3(math::ceil(center - reach)), origin);
+  const int3 max = math::min(int3(math::floor(center + reach)),
+                             origin + int3(int(FloatLeaf::DIM) - 1));
+  for (int x = min.x; x <= max.x; x++) {
+    for (int y = min.y; y <= max.y; y++) {
+      for (int z = min.z; z <= max.z; z++) {
+        const float distance = math::distance(float3(x, y, z), center) - radius;
+        const int offset = ((x - origin.x) << (2 * FloatLeaf::LOG2DIM)) +
+                           ((y - origin.y) << FloatLeaf::LOG2DIM) + (z - origin.z);
+        sdf[offset] = std::min(sdf[offset], distance);
+      }
+    }
   }
+}
 
-  void getPos(size_t n, openvdb::Vec3R &xyz) const
-  {
-    float3 pos = positions_[n] * voxel_size_inv_;
-    /* Better align generated grid with source points. */
-    pos -= float3(0.5f);
-    xyz = &pos.x;
+/**
+ * Rasterize the signed distance to the union of spheres around the points into leaf nodes of the
+ * tree, in index space and limited to the narrow band.
+ *
+ * Points are sorted into buckets by the leaf node containing their center. Every leaf node in the
+ * reach of a bucket is then computed independently from the buckets touching it, so there are no
+ * per-thread grids to merge like in #openvdb::tools::ParticlesToLevelSet.
+ *
+ * \param finish_leaf: Write the distances of a leaf node to its voxels, returns false to discard
+ * the leaf node. Called from multiple threads for different leaf nodes.
+ */
+template<typename FinishLeafFn>
+static void rasterize_spheres(const Span<float3> positions,
+                              const Span<float> radii,
+                              const float voxel_size,
+                              const float background,
+                              const FinishLeafFn &finish_leaf,
+                              openvdb::FloatTree &tree)
+{
+  const float voxel_size_inv = math::rcp(voxel_size);
+  /* Better align generated grid with source points. */
+  const auto sphere_center = [&](const int i) { return positions[i] * voxel_size_inv - 0.5f; };
+  const auto sphere_radius = [&](const int i) { return radii[i] * voxel_size_inv; };
+
+  /* Voxel coordinates in the reach of a sphere have to fit into an int, points further away from
+   * the origin are skipped. Zero radius points still produce a distance field around them. */
+  const float max_coordinate = float(1 << 30);
+  IndexMaskMemory memory;
+  const IndexMask points = IndexMask::from_predicate(
+      positions.index_range(), GrainSize(4096), memory, [&](const int64_t i) {
+        const float3 center = sphere_center(i);
+        const float radius = sphere_radius(i);
+        const float max_reach = math::reduce_max(math::abs(center)) + radius + half_width;
+        /* Also false for NaN and infinite values. */
+        return radius >= 0.0f && max_reach < max_coordinate;
+      });
+  if (points.is_empty()) {
+    return;
   }
 
-  void getPosRad(size_t n, openvdb::Vec3R &xyz, openvdb::Real &radius) const
-  {
-    this->getPos(n, xyz);
-    radius = radii_[n] * voxel_size_inv_;
+  /* Sort points into buckets by the leaf node containing their center. */
+  Array<int3> point_leaves(positions.size());
+  points.foreach_index(GrainSize(4096), [&](const int i) {
+    point_leaves[i] = leaf_origin(int3(math::floor(sphere_center(i))));
+  });
+  Array<int> sorted_points(points.size());
+  points.to_indices(sorted_points.as_mutable_span());
+  parallel_sort(sorted_points.begin(), sorted_points.end(), [&](const int a, const int b) {
+    if (point_leaves[a] != point_leaves[b]) {
+      return leaf_less(point_leaves[a], point_leaves[b]);
+    }
+    return a < b;
+  });
+  const IndexMask bucket_starts = IndexMask::from_predicate(
+      sorted_points.index_range(), GrainSize(4096), memory, [&](const int64_t i) {
+        return i == 0 || point_leaves[sorted_points[i]] != point_leaves[sorted_points[i - 1]];
+      });
+  Array<int> bucket_offsets(bucket_starts.size() + 1);
+  bucket_starts.to_indices(bucket_offsets.as_mutable_span().drop_back(1));
+  bucket_offsets.last() = int(sorted_points.size());
+  const OffsetIndices<int> buckets(bucket_offsets);
+
+  /* Find the range of leaf nodes in the reach of every bucket. */
+  Array<Bounds<int3>> bucket_leaf_bounds(buckets.size());
+  Array<int> pair_offsets(buckets.size() + 1);
+  threading::parallel_for(buckets.index_range(), 256, [&](const IndexRange range) {
+    for (const int64_t bucket : range) {
+      Bounds<float3> bounds(float3(std::numeric_limits<float>::max()),
+                            float3(std::numeric_limits<float>::lowest()));
+      for (const int i : sorted_points.as_span().slice(buckets[bucket])) {
+        const float3 center = sphere_center(i);
+        const float reach = sphere_radius(i) + half_width;
+        bounds.min = math::min(bounds.min, center - reach);
+        bounds.max = math::max(bounds.max, center + reach);
+      }
+      const Bounds<int3> leaf_bounds(leaf_origin(int3(math::floor(bounds.min))),
+                                     leaf_origin(int3(math::floor(bounds.max))));
+      const int3 size = (leaf_bounds.max - leaf_bounds.min) / int(FloatLeaf::DIM) + 1;
+      bucket_leaf_bounds[bucket] = leaf_bounds;
+      pair_offsets[bucket] = size.x * size.y * size.z;
+    }
+  });
+  const OffsetIndices<int> pairs_by_bucket = offset_indices::accumulate_counts_to_offsets(
+      pair_offsets);
+
+  /* Gather the buckets touching every leaf node. */
+  struct LeafBucket {
+    int3 leaf;
+    int bucket;
+  };
+  Array<LeafBucket> pairs(pairs_by_bucket.total_size());
+  threading::parallel_for(buckets.index_range(), 256, [&](const IndexRange range) {
+    for (const int64_t bucket : range) {
+      const Bounds<int3> &bounds = bucket_leaf_bounds[bucket];
+      int pair_i = pairs_by_bucket[bucket].first();
+      int3 leaf;
+      for (leaf.x = bounds.min.x; leaf.x <= bounds.max.x; leaf.x += FloatLeaf::DIM) {
+        for (leaf.y = bounds.min.y; leaf.y <= bounds.max.y; leaf.y += FloatLeaf::DIM) {
+          for (leaf.z = bounds.min.z; leaf.z <= bounds.max.z; leaf.z += FloatLeaf::DIM) {
+            pairs[pair_i++] = {leaf, int(bucket)};
+          }
+        }
+      }
+    }
+  });
+  parallel_sort(pairs.begin(), pairs.end(), [](const LeafBucket &a, const LeafBucket &b) {
+    if (a.leaf != b.leaf) {
+      return leaf_less(a.leaf, b.leaf);
+    }
+    return a.bucket < b.bucket;
+  });
+  const IndexMask leaf_starts = IndexMask::from_predicate(
+      pairs.index_range(), GrainSize(4096), memory, [&](const int64_t i) {
+        return i == 0 || pairs[i].leaf != pairs[i - 1].leaf;
+      });
+  Array<int> leaf_offsets(leaf_starts.size() + 1);
+  leaf_starts.to_indices(leaf_offsets.as_mutable_span().drop_back(1));
+  leaf_offsets.last() = int(pairs.size());
+  const OffsetIndices<int> leaves(leaf_offsets);
+
+  /* Rasterize every leaf node independently. */
+  Array<FloatLeaf *> new_leaves(leaves.size(), nullptr);
+  threading::parallel_for(leaves.index_range(), 16, [&](const IndexRange range) {
+    Array<float, FloatLeaf::SIZE> sdf(FloatLeaf::SIZE);
+    for (const int64_t leaf_i : range) {
+      const int3 origin = pairs[leaves[leaf_i].first()].leaf;
+      sdf.fill(half_width);
+      for (const LeafBucket &pair : pairs.as_span().slice(leaves[leaf_i])) {
+        for (const int i : sorted_points.as_span().slice(buckets[pair.bucket])) {
+          rasterize_sphere(sphere_center(i), sphere_radius(i), origin, sdf);
+        }
+      }
+      FloatLeaf *leaf = new FloatLeaf(openvdb::Coord(origin.x, origin.y, origin.z), background);
+      if (finish_leaf(sdf.as_span(), *leaf)) {
+        new_leaves[leaf_i] = leaf;
+      }
+      else {
+        delete leaf;
+      }
+    }
+  });
+  for (FloatLeaf *leaf : new_leaves) {
+    if (leaf) {
+      tree.addLeaf(leaf);
+    }
   }
-};
+}
 
 static openvdb::FloatGrid::Ptr points_to_sdf_grid_impl(const Span<float3> positions,
                                                        const Span<float> radii,
                                                        const float voxel_size)
 {
-  /* Create a new grid that will be filled. #ParticlesToLevelSet requires
-   * the background value to be positive */
-  openvdb::FloatGrid::Ptr new_grid = openvdb::FloatGrid::create(1.0f);
+  openvdb::FloatGrid::Ptr new_grid = openvdb::FloatGrid::create(half_width);
 
   /* Create a narrow-band level set grid based on the positions and radii. */
-  openvdb::tools::ParticlesToLevelSet op{*new_grid};
-  /* Don't ignore particles based on their radius. */
-  op.setRmin(0.0f);
-  op.setRmax(std::numeric_limits<float>::max());
-  OpenVDBParticleList particles{positions, radii, voxel_size};
-  op.rasterizeSpheres(particles);
-  op.finalize();
+  rasterize_spheres(
+      positions,
+      radii,
+      voxel_size,
+      half_width,
+      [](const Span<float> sdf, FloatLeaf &leaf) {
+        bool touched = false;
+        for (const int64_t offset : sdf.index_range()) {
+          const float value = sdf[offset];
+          if (value >= half_width) {
+            continue;
+          }
+          touched = true;
+          if (value <= -half_width) {
+            /* Inside the surface, beyond the narrow band. */
+            leaf.setValueOff(openvdb::Index(offset), -half_width);
+          }
+          else {
+            leaf.setValueOn(openvdb::Index(offset), value);
+          }
+        }
+        return touched;
+      },
+      new_grid->tree());
+  /* Collapse leaf nodes inside the narrow band. */
+  openvdb::tools::pruneLevelSet(new_grid->tree());
 
   new_grid->transform().postScale(voxel_size);
   new_grid->setGridClass(openvdb::GRID_LEVEL_SET);
@@ -93,18 +266,33 @@ bke::VolumeGridData *fog_volume_grid_add_from_points(Volume *volume,
                                                      const float voxel_size,
                                                      const float density)
 {
-  openvdb::FloatGrid::Ptr new_grid = points_to_sdf_grid_impl(positions, radii, voxel_size);
-  new_grid->setGridClass(openvdb::GRID_FOG_VOLUME);
+  openvdb::FloatGrid::Ptr new_grid = openvdb::FloatGrid::create(0.0f);
 
-  /* Convert the level set to a fog volume. This also sets the background value to zero. Inside the
-   * fog there will be a density of 1. */
-  openvdb::tools::sdfToFogVolume(*new_grid);
+  /* Rasterize directly to a fog volume, the same as converting the level set with
+   * #openvdb::tools::sdfToFogVolume. Inside the narrow band the density ramps up linearly, inside
+   * the fog there will be the full density. */
+  rasterize_spheres(
+      positions,
+      radii,
+      voxel_size,
+      0.0f,
+      [&](const Span<float> sdf, FloatLeaf &leaf) {
+        bool touched = false;
+        for (const int64_t offset : sdf.index_range()) {
+          const float fog = std::min(-sdf[offset] / half_width, 1.0f);
+          if (fog > 0.0f) {
+            leaf.setValueOn(openvdb::Index(offset), fog * density);
+            touched = true;
+          }
+        }
+        return touched;
+      },
+      new_grid->tree());
+  /* Collapse leaf nodes inside the fog. */
+  openvdb::tools::prune(new_grid->tree());
 
-  /* Take the desired density into account. */
-  openvdb::tools::foreach (new_grid->beginValueOn(),
-                           [&](const openvdb::FloatGrid::ValueOnIter &iter) {
-                             iter.modifyValue([&](float &value) { value *= density; });
-                           });
+  new_grid->transform().postScale(voxel_size);
+  new_grid->setGridClass(openvdb::GRID_FOG_VOLUME);
 
   return BKE_volume_grid_add_vdb(*volume, name, std::move(new_grid));
 }
@@ -240,11 +240,34 @@ struct GatherTasks {
   ImplicitSharingPtr<const bke::GeometryComponentEditData> first_edit_data;
 };
 
-/** Current offsets while during the gather operation. */
+/**
+ * Current offsets while during the gather operation. These are 64 bit, because the realized
+ * geometry can have more elements than fit into a single geometry, in which case it is split into
+ * chunks with their own start indices.
+ */
 struct GatherOffsets {
-  int pointcloud_offset = 0;
-  MeshElementStartIndices mesh_offsets;
-  CurvesElementStartIndices curves_offsets;
+  int64_t pointcloud_offset = 0;
+  struct {
+    int64_t vertex = 0;
+    int64_t edge = 0;
+    int64_t face = 0;
+    int64_t loop = 0;
+  } mesh_offsets;
+  struct {
+    int64_t point = 0;
+    int64_t curve = 0;
+  } curves_offsets;
+
+  bool fits_in_single_geometry() const
+  {
+    return std::max({pointcloud_offset,
+                     mesh_offsets.vertex,
+                     mesh_offsets.edge,
+                     mesh_offsets.face,
+                     mesh_offsets.loop,
+                     curves_offsets.point,
+                     curves_offsets.curve}) <= std::numeric_limits<int>::max();
+  }
 };
 
 struct GatherTasksInfo {
@@ -645,7 +668,11 @@ static void gather_realize_tasks_recursive(GatherTasksInfo &gather_info,
         if (mesh != nullptr && mesh->verts_num > 0) {
           const int mesh_index = gather_info.meshes.order.index_of(mesh);
           const MeshRealizeInfo &mesh_info = gather_info.meshes.realize_info[mesh_index];
-          gather_info.r_tasks.mesh_tasks.append({gather_info.r_offsets.mesh_offsets,
+          const auto &offsets = gather_info.r_offsets.mesh_offsets;
+          /* Start indices are recomputed per chunk when the offsets don't fit into an int. */
+          const MeshElementStartIndices start_indices{
+              int(offsets.vertex), int(offsets.edge), int(offsets.face), int(offsets.loop)};
+          gather_info.r_tasks.mesh_tasks.append({start_indices,
                                                  &mesh_info,
                                                  base_transform,
                                                  base_instance_context.meshes,
@@ -665,11 +692,12 @@ static void gather_realize_tasks_recursive(GatherTasksInfo &gather_info,
           const int pointcloud_index = gather_info.pointclouds.order.index_of(pointcloud);
           const PointCloudRealizeInfo &pointcloud_info =
               gather_info.pointclouds.realize_info[pointcloud_index];
-          gather_info.r_tasks.pointcloud_tasks.append({gather_info.r_offsets.pointcloud_offset,
-                                                       &pointcloud_info,
-                                                       base_transform,
-                                                       base_instance_context.pointclouds,
-                                                       base_instance_context.id});
+          gather_info.r_tasks.pointcloud_tasks.append(
+              {int(gather_info.r_offsets.pointcloud_offset),
+               &pointcloud_info,
+               base_transform,
+               base_instance_context.pointclouds,
+               base_instance_context.id});
           gather_info.r_offsets.pointcloud_offset += pointcloud->totpoint;
         }
         break;
@@ -680,7 +708,9 @@ static void gather_realize_tasks_recursive(GatherTasksInfo &gather_info,
         if (curves != nullptr && curves->geometry.curve_num > 0) {
           const int curve_index = gather_info.curves.order.index_of(curves);
           const RealizeCurveInfo &curve_info = gather_info.curves.realize_info[curve_index];
-          gather_info.r_tasks.curve_tasks.append({gather_info.r_offsets.curves_offsets,
+          const auto &offsets = gather_info.r_offsets.curves_offsets;
+          const CurvesElementStartIndices start_indices{int(offsets.point), int(offsets.curve)};
+          gather_info.r_tasks.curve_tasks.append({start_indices,
                                                   &curve_info,
                                                   base_transform,
                                                   base_instance_context.curves,
@@ -1966,6 +1996,117 @@ static void propagate_instances_to_keep(
   new_instances_components.replace(new_instances.release(), bke::GeometryOwnershipType::Owned);
 }
 
+/**
+ * Call \a fn for ranges of consecutive tasks with at most \a max_elements elements in total. A task
+ * with more elements than that gets its own range.
+ */
+template<typename Task, typename SizeFn>
+static void foreach_task_chunk(const Span<Task> tasks,
+                               const int64_t max_elements,
+                               const SizeFn &size_fn,
+                               const FunctionRef<void(IndexRange)> fn)
+{
+  int64_t chunk_start = 0;
+  int64_t chunk_size = 0;
+  for (const int64_t i : tasks.index_range()) {
+    const int64_t task_size = size_fn(tasks[i]);
+    if (i > chunk_start && chunk_size + task_size > max_elements) {
+      fn(IndexRange::from_begin_end(chunk_start, i));
+      chunk_start = i;
+      chunk_size = 0;
+    }
+    chunk_size += task_size;
+  }
+  if (!tasks.is_empty()) {
+    fn(IndexRange::from_begin_end(chunk_start, tasks.size()));
+  }
+}
+
+/**
+ * Execute the gathered tasks in chunks of consecutive tasks, see #foreach_task_chunk. The start
+ * indices of the tasks are recomputed for every chunk, so they are local to it.
+ */
+static void execute_realize_tasks_chunked(const RealizeInstancesOptions &options,
+                                          const AllPointCloudsInfo &all_pointclouds_info,
+                                          const AllMeshesInfo &all_meshes_info,
+                                          const AllCurvesInfo &all_curves_info,
+                                          GatherTasks &tasks,
+                                          const int64_t max_chunk_elements,
+                                          const FunctionRef<void(bke::GeometrySet &chunk)> fn)
+{
+  foreach_task_chunk(
+      tasks.pointcloud_tasks.as_span(),
+      max_chunk_elements,
+      [](const RealizePointCloudTask &task) {
+        return int64_t(task.pointcloud_info->pointcloud->totpoint);
+      },
+      [&](const IndexRange range) {
+        MutableSpan<RealizePointCloudTask> chunk_tasks = tasks.pointcloud_tasks.as_mutable_span()
+                                                             .slice(range);
+        int start_index = 0;
+        for (RealizePointCloudTask &task : chunk_tasks) {
+          task.start_index = start_index;
+          start_index += task.pointcloud_info->pointcloud->totpoint;
+        }
+        bke::GeometrySet chunk;
+        execute_realize_pointcloud_tasks(
+            options, all_pointclouds_info, chunk_tasks, all_pointclouds_info.attributes, chunk);
+        fn(chunk);
+      });
+
+  foreach_task_chunk(
+      tasks.mesh_tasks.as_span(),
+      max_chunk_elements,
+      [](const RealizeMeshTask &task) {
+        const Mesh &mesh = *task.mesh_info->mesh;
+        return int64_t(mesh.verts_num) + mesh.edges_num + mesh.faces_num + mesh.corners_num;
+      },
+      [&](const IndexRange range) {
+        MutableSpan<RealizeMeshTask> chunk_tasks = tasks.mesh_tasks.as_mutable_span().slice(
+            range);
+        MeshElementStartIndices start_indices{};
+        for (RealizeMeshTask &task : chunk_tasks) {
+          const Mesh &mesh = *task.mesh_info->mesh;
+          task.start_indices = start_indices;
+          start_indices.vertex += mesh.verts_num;
+          start_indices.edge += mesh.edges_num;
+          start_indices.face += mesh.faces_num;
+          start_indices.loop += mesh.corners_num;
+        }
+        bke::GeometrySet chunk;
+        execute_realize_mesh_tasks(options,
+                                   all_meshes_info,
+                                   chunk_tasks,
+                                   all_meshes_info.attributes,
+                                   all_meshes_info.materials,
+                                   chunk);
+        fn(chunk);
+      });
+
+  foreach_task_chunk(
+      tasks.curve_tasks.as_span(),
+      max_chunk_elements,
+      [](const RealizeCurveTask &task) {
+        const bke::CurvesGeometry &curves = task.curve_info->curves->geometry.wrap();
+        return int64_t(curves.points_num()) + curves.curves_num();
+      },
+      [&](const IndexRange range) {
+        MutableSpan<RealizeCurveTask> chunk_tasks = tasks.curve_tasks.as_mutable_span().slice(
+            range);
+        CurvesElementStartIndices start_indices{};
+        for (RealizeCurveTask &task : chunk_tasks) {
+          const bke::CurvesGeometry &curves = task.curve_info->curves->geometry.wrap();
+          task.start_indices = start_indices;
+          start_indices.point += curves.points_num();
+          start_indices.curve += curves.curves_num();
+        }
+        bke::GeometrySet chunk;
+        execute_realize_curve_tasks(
+            options, all_curves_info, chunk_tasks, all_curves_info.attributes, chunk);
+        fn(chunk);
+      });
+}
+
 bke::GeometrySet realize_instances(bke::GeometrySet geometry_set,
                                    const RealizeInstancesOptions &options)
 {
@@ -2043,28 +2184,50 @@ bke::GeometrySet realize_instances(bke::GeometrySet geometry_set,
                           gather_info.instances.attribute_fallback,
                           new_geometry_set);
 
-  const int64_t total_points_num = get_final_points_num(gather_info.r_tasks);
-  /* This doesn't have to be exact at all, it's just a rough estimate ot make decisions about
-   * multi-threading (overhead). */
-  const int64_t approximate_used_bytes_num = total_points_num * 32;
-  threading::memory_bandwidth_bound_task(approximate_used_bytes_num, [&]() {
-    execute_realize_pointcloud_tasks(options,
-                                     all_pointclouds_info,
-                                     gather_info.r_tasks.pointcloud_tasks,
-                                     all_pointclouds_info.attributes,
-                                     new_geometry_set);
-    execute_realize_mesh_tasks(options,
-                               all_meshes_info,
-                               gather_info.r_tasks.mesh_tasks,
-                               all_meshes_info.attributes,
-                               all_meshes_info.materials,
-                               new_geometry_set);
-    execute_realize_curve_tasks(options,
-                                all_curves_info,
-                                gather_info.r_tasks.curve_tasks,
-                                all_curves_info.attributes,
-                                new_geometry_set);
-  });
+  if (!gather_info.r_offsets.fits_in_single_geometry()) {
+    /* The result has more elements than a single geometry can hold. Realize it in chunks that
+     * each fit, and add them to the output as separate instances. */
+    bke::Instances *chunk_instances = new_geometry_set.get_instances_for_write();
+    if (chunk_instances == nullptr) {
+      chunk_instances = new bke::Instances();
+      new_geometry_set.replace_instances(chunk_instances);
+    }
+    execute_realize_tasks_chunked(options,
+                                  all_pointclouds_info,
+                                  all_meshes_info,
+                                  all_curves_info,
+                                  gather_info.r_tasks,
+                                  std::numeric_limits<int>::max(),
+                                  [&](bke::GeometrySet &chunk) {
+                                    const int handle = chunk_instances->add_reference(
+                                        bke::InstanceReference(std::move(chunk)));
+                                    chunk_instances->add_instance(handle, float4x4::identity());
+                                  });
+  }
+  else {
+    const int64_t total_points_num = get_final_points_num(gather_info.r_tasks);
+    /* This doesn't have to be exact at all, it's just a rough estimate ot make decisions about
+     * multi-threading (overhead). */
+    const int64_t approximate_used_bytes_num = total_points_num * 32;
+    threading::memory_bandwidth_bound_task(approximate_used_bytes_num, [&]() {
+      execute_realize_pointcloud_tasks(options,
+                                       all_pointclouds_info,
+                                       gather_info.r_tasks.pointcloud_tasks,
+                                       all_pointclouds_info.attributes,
+                                       new_geometry_set);
+      execute_realize_mesh_tasks(options,
+                                 all_meshes_info,
+                                 gather_info.r_tasks.mesh_tasks,
+                                 all_meshes_info.attributes,
+                                 all_meshes_info.materials,
+                                 new_geometry_set);
+      execute_realize_curve_tasks(options,
+                                  all_curves_info,
+                                  gather_info.r_tasks.curve_tasks,
+                                  all_curves_info.attributes,
+                                  new_geometry_set);
+    });
+  }
   if (gather_info.r_tasks.first_volume) {
     new_geometry_set.add(*gather_info.r_tasks.first_volume);
   }
@@ -2075,6 +2238,58 @@ bke::GeometrySet realize_instances(bke::GeometrySet geometry_set,
   return new_geometry_set;
 }
 
+void realize_instances_chunked(bke::GeometrySet geometry_set,
+                               const RealizeInstancesOptions &options,
+                               const int64_t max_chunk_elements,
+                               const FunctionRef<void(bke::GeometrySet &chunk)> fn)
+{
+  /* Tasks are gathered like for #realize_instances, but every chunk of tasks is executed
+   * separately. */
+  if (options.keep_original_ids) {
+    remove_id_attribute_from_instances(geometry_set);
+  }
+
+  VariedDepthOptions all_instances;
+  const int instances_num = geometry_set.has_instances() ?
+                                geometry_set.get_instances()->instances_num() :
+                                0;
+  all_instances.depths = VArray<int>::ForSingle(VariedDepthOptions::MAX_DEPTH, instances_num);
+  all_instances.selection = IndexMask(instances_num);
+
+  AllPointCloudsInfo all_pointclouds_info = preprocess_pointclouds(
+      geometry_set, options, all_instances);
+  AllMeshesInfo all_meshes_info = preprocess_meshes(geometry_set, options, all_instances);
+  AllCurvesInfo all_curves_info = preprocess_curves(geometry_set, options, all_instances);
+  OrderedAttributes all_instance_attributes = gather_generic_instance_attributes_to_propagate(
+      geometry_set, options, all_instances);
+
+  const bool create_id_attribute = all_pointclouds_info.create_id_attribute ||
+                                   all_meshes_info.create_id_attribute ||
+                                   all_curves_info.create_id_attribute;
+  Vector<std::unique_ptr<GArray<>>> temporary_arrays;
+  GatherTasksInfo gather_info = {all_pointclouds_info,
+                                 all_meshes_info,
+                                 all_curves_info,
+                                 all_instance_attributes,
+                                 create_id_attribute,
+                                 all_instances.selection,
+                                 all_instances.depths,
+                                 temporary_arrays};
+
+  const float4x4 transform = float4x4::identity();
+  InstanceContext attribute_fallbacks(gather_info);
+  gather_realize_tasks_recursive(
+      gather_info, 0, VariedDepthOptions::MAX_DEPTH, geometry_set, transform, attribute_fallbacks);
+
+  execute_realize_tasks_chunked(options,
+                                all_pointclouds_info,
+                                all_meshes_info,
+                                all_curves_info,
+                                gather_info.r_tasks,
+                                max_chunk_elements,
+                                fn);
+}
+
 /** \} */
 
 }  // namespace blender::geometry
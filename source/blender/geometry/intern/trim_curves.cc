@@ -767,6 +767,18 @@ static void trim_evaluated_curves(const bke::CurvesGeometry &src_curves,
   fill_bezier_data(dst_curves, selection);
   fill_nurbs_data(dst_curves, selection);
 
+  if (transfer_attributes.is_empty()) {
+    return;
+  }
+
+  /* Only NURBS curves are trimmed on the evaluated points. Interpolate with the basis cache
+   * directly, instead of retrieving the evaluation data for every curve and attribute. */
+  src_curves.ensure_can_interpolate_to_evaluated();
+  const Span<bke::curves::nurbs::BasisCache> nurbs_basis_cache =
+      src_curves.runtime->nurbs_basis_cache.data();
+  const VArraySpan<int8_t> nurbs_orders = src_curves.nurbs_orders();
+  const Span<float> nurbs_weights = src_curves.nurbs_weights();
+
   for (bke::AttributeTransferData &attribute : transfer_attributes) {
     bke::attribute_math::convert_to_static_type(attribute.meta_data.data_type, [&](auto dummy) {
       using T = decltype(dummy);
@@ -776,10 +788,15 @@ static void trim_evaluated_curves(const bke::CurvesGeometry &src_curves,
         for (const int64_t curve_i : segment) {
           const IndexRange src_points = src_points_by_curve[curve_i];
 
-          /* Interpolate onto the evaluated point domain and sample the evaluated domain. */
+          /* Interpolate onto the evaluated point domain and sample the evaluated domain. The
+           * buffer is reused for all curves in the segment. */
           evaluated_buffer.reinitialize(sizeof(T) * src_evaluated_points_by_curve[curve_i].size());
           MutableSpan<T> evaluated = evaluated_buffer.as_mutable_span().cast<T>();
-          src_curves.interpolate_to_evaluated(curve_i, attribute.src.slice(src_points), evaluated);
+          bke::curves::nurbs::interpolate_to_evaluated(nurbs_basis_cache[curve_i],
+                                                       nurbs_orders[curve_i],
+                                                       nurbs_weights.slice_safe(src_points),
+                                                       attribute.src.slice(src_points),
+                                                       evaluated);
           sample_interval_linear<T>(evaluated,
                                     attribute.dst.span.typed<T>(),
                                     src_ranges[curve_i],
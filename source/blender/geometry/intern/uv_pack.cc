@@ -11,6 +11,8 @@
 #include "BKE_global.hh"
 
 #include "BLI_array.hh"
+#include "BLI_bit_span_ops.hh"
+#include "BLI_bit_vector.hh"
 #include "BLI_bounds.hh"
 #include "BLI_boxpack_2d.h"
 #include "BLI_convexhull_2d.h"
@@ -22,6 +24,7 @@
 #include "BLI_polyfill_2d.h"
 #include "BLI_polyfill_2d_beautify.h"
 #include "BLI_rect.h"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "DNA_scene_types.h"
@@ -1142,12 +1145,13 @@ class Occupancy {
   void increase_scale(); /* Resize the scale of the bitmap and clear it. */
   void clear();          /* Clear occupancy information. */
 
-  /* Write or Query a triangle on the bitmap. */
+  /* Write or Query a triangle on the bitmap, only tracing the pixels in `rows`. */
   float trace_triangle(const float2 &uv0,
                        const float2 &uv1,
                        const float2 &uv2,
                        const float margin,
-                       const bool write) const;
+                       const bool write,
+                       const IndexRange rows) const;
 
   /* Write or Query an island on the bitmap. */
   float trace_island(const PackIsland *island,
@@ -1156,11 +1160,30 @@ class Occupancy {
                      const float margin,
                      const bool write) const;
 
+  /* Write several islands on the bitmap, in parallel over bands of rows. */
+  void write_islands(const Span<const PackIsland *> islands,
+                     const Span<UVPhi> phis,
+                     const Span<float> scales,
+                     const float margin) const;
+
   int bitmap_radix;              /* Width and Height of `bitmap`. */
   float bitmap_scale_reciprocal; /* == 1.0f / `bitmap_scale`. */
  private:
+  float trace_island(const PackIsland *island,
+                     const UVPhi phi,
+                     const float scale,
+                     const float margin,
+                     const bool write,
+                     const IndexRange rows) const;
+
   mutable Array<float> bitmap_;
 
+  /* One bit per pixel of `bitmap_`, set when the pixel has been written. Queries skip spans of
+   * unwritten pixels a word at a time. Rows start on a new #bits::BitInt so that different rows
+   * can be written from different threads. */
+  mutable BitVector<> written_;
+  int64_t written_row_stride_;
+
   mutable float2 witness_;         /* Witness to a previously known occupied pixel. */
   mutable float witness_distance_; /* Signed distance to nearest placed island. */
   mutable uint triangle_hint_;     /* Hint to a previously suspected overlapping triangle. */
@@ -1171,6 +1194,9 @@ class Occupancy {
 Occupancy::Occupancy(const float initial_scale)
     : bitmap_radix(800), bitmap_(bitmap_radix * bitmap_radix, false)
 {
+  written_row_stride_ = (bitmap_radix + bits::BitsPerInt - 1) / bits::BitsPerInt *
+                        bits::BitsPerInt;
+  written_.resize(written_row_stride_ * bitmap_radix);
   bitmap_scale_reciprocal = 1.0f; /* lint, prevent uninitialized memory access. */
   increase_scale();
   bitmap_scale_reciprocal = bitmap_radix / initial_scale; /* Actually set the value. */
@@ -1186,9 +1212,8 @@ void Occupancy::increase_scale()
 
 void Occupancy::clear()
 {
-  for (int i = 0; i < bitmap_radix * bitmap_radix; i++) {
-    bitmap_[i] = terminal;
-  }
+  bitmap_.fill(terminal);
+  written_.fill(false);
   witness_.x = -1;
   witness_.y = -1;
   witness_distance_ = 0.0f;
@@ -1220,7 +1245,8 @@ float Occupancy::trace_triangle(const float2 &uv0,
                                 const float2 &uv1,
                                 const float2 &uv2,
                                 const float margin,
-                                const bool write) const
+                                const bool write,
+                                const IndexRange rows) const
 {
   const float x0 = min_fff(uv0.x, uv1.x, uv2.x);
   const float y0 = min_fff(uv0.y, uv1.y, uv2.y);
@@ -1228,9 +1254,10 @@ float Occupancy::trace_triangle(const float2 &uv0,
   const float y1 = max_fff(uv0.y, uv1.y, uv2.y);
   float spread = write ? margin * 2 : 0.0f;
   int ix0 = std::max(int(floorf((x0 - spread) * bitmap_scale_reciprocal)), 0);
-  int iy0 = std::max(int(floorf((y0 - spread) * bitmap_scale_reciprocal)), 0);
+  int iy0 = std::max(int(floorf((y0 - spread) * bitmap_scale_reciprocal)), int(rows.first()));
   int ix1 = std::min(int(floorf((x1 + spread) * bitmap_scale_reciprocal + 2)), bitmap_radix);
-  int iy1 = std::min(int(floorf((y1 + spread) * bitmap_scale_reciprocal + 2)), bitmap_radix);
+  int iy1 = std::min(int(floorf((y1 + spread) * bitmap_scale_reciprocal + 2)),
+                     int(rows.one_after_last()));
 
   const float2 uv0s = uv0 * bitmap_scale_reciprocal;
   const float2 uv1s = uv1 * bitmap_scale_reciprocal;
@@ -1253,8 +1280,21 @@ float Occupancy::trace_triangle(const float2 &uv0,
     }
   }
 
+  if (ix0 >= ix1) {
+    return -1.0f; /* Available. */
+  }
+  /* Unwritten pixels are at `terminal`, which queries skip as long as it is above `epsilon`. */
+  const bool skip_unwritten = epsilon < terminal;
+
   /* Iterate in opposite direction to outer search to improve witness effectiveness. */
   for (int y = iy1 - 1; y >= iy0; y--) {
+    const IndexRange row_bits(y * written_row_stride_ + ix0, ix1 - ix0);
+    if (write) {
+      MutableBitSpan(written_).slice(row_bits).set_all();
+    }
+    else if (skip_unwritten && !bits::any_bit_set(BitSpan(written_).slice(row_bits))) {
+      continue;
+    }
     for (int x = ix1 - 1; x >= ix0; x--) {
       float *hotspot = &bitmap_[y * bitmap_radix + x];
       if (!write && *hotspot > epsilon) {
@@ -1311,6 +1351,16 @@ float Occupancy::trace_island(const PackIsland *island,
                               const float scale,
                               const float margin,
                               const bool write) const
+{
+  return trace_island(island, phi, scale, margin, write, IndexRange(bitmap_radix));
+}
+
+float Occupancy::trace_island(const PackIsland *island,
+                              const UVPhi phi,
+                              const float scale,
+                              const float margin,
+                              const bool write,
+                              const IndexRange rows) const
 {
   const float2 diagonal_support = island->get_diagonal_support(scale, phi.rotation, margin);
 
@@ -1341,7 +1391,8 @@ float Occupancy::trace_island(const PackIsland *island,
     mul_v2_m2v2(uv0, matrix, island->triangle_vertices_[j]);
     mul_v2_m2v2(uv1, matrix, island->triangle_vertices_[j + 1]);
     mul_v2_m2v2(uv2, matrix, island->triangle_vertices_[j + 2]);
-    const float extent = trace_triangle(uv0 + delta, uv1 + delta, uv2 + delta, margin, write);
+    const float extent = trace_triangle(
+        uv0 + delta, uv1 + delta, uv2 + delta, margin, write, rows);
 
     if (!write && extent >= 0.0f) {
       triangle_hint_ = j;
@@ -1351,6 +1402,26 @@ float Occupancy::trace_island(const PackIsland *island,
   return -1.0f; /* Available. */
 }
 
+void Occupancy::write_islands(const Span<const PackIsland *> islands,
+                              const Span<UVPhi> phis,
+                              const Span<float> scales,
+                              const float margin) const
+{
+  int64_t vert_count = 0;
+  for (const PackIsland *island : islands) {
+    vert_count += island->triangle_vertices_.size();
+  }
+  /* Writing keeps the minimum distance, which doesn't depend on the order of the writes. So every
+   * band of rows traces all islands independently, and the result is the same as tracing them
+   * one after another. Small writes, e.g. a single island, aren't worth the overhead. */
+  const int64_t grain_size = vert_count < 3 * 1024 ? bitmap_radix : 32;
+  threading::parallel_for(IndexRange(bitmap_radix), grain_size, [&](const IndexRange rows) {
+    for (const int64_t i : islands.index_range()) {
+      trace_island(islands[i], phis[i], scales[i], margin, true, rows);
+    }
+  });
+}
+
 static UVPhi find_best_fit_for_island(const PackIsland *island,
                                       const int scan_line,
                                       const Occupancy &occupancy,
@@ -1658,13 +1729,19 @@ static int64_t pack_island_xatlas(const Span<std::unique_ptr<UVAABBIsland>> isla
       break;
     }
 
-    while (traced_islands < i) {
-      /* Trace an island that's been solved. (Greedy.) */
-      const int64_t island_index = island_indices[traced_islands]->index;
-      PackIsland *island = islands[island_index];
-      const float island_scale = island->can_scale_(params) ? scale : 1.0f;
-      occupancy.trace_island(island, phis[island_index], island_scale, margin, true);
-      traced_islands++;
+    if (traced_islands < i) {
+      /* Trace islands that have been solved. (Greedy.) */
+      Vector<const PackIsland *> traced;
+      Vector<UVPhi> traced_phis;
+      Vector<float> traced_scales;
+      for (; traced_islands < i; traced_islands++) {
+        const int64_t island_index = island_indices[traced_islands]->index;
+        const PackIsland *island = islands[island_index];
+        traced.append(island);
+        traced_phis.append(phis[island_index]);
+        traced_scales.append(island->can_scale_(params) ? scale : 1.0f);
+      }
+      occupancy.write_islands(traced, traced_phis, traced_scales, margin);
     }
 
     PackIsland *island = islands[island_indices[i]->index];
@@ -18,6 +18,7 @@
 #include "BLI_polyfill_2d.h"
 #include "BLI_polyfill_2d_beautify.h"
 #include "BLI_rand.h"
+#include "BLI_task.hh"
 
 #include "GEO_uv_pack.hh"
 
@@ -2956,7 +2957,7 @@ static void p_chart_extrema_verts(PChart *chart, PVert **pin1, PVert **pin2)
   p_chart_pin_positions(chart, pin1, pin2);
 }
 
-static void p_chart_lscm_begin(PChart *chart, bool live, bool abf)
+static void p_chart_lscm_begin(const ParamHandle *handle, PChart *chart, bool live, bool abf)
 {
   BLI_assert(chart->context == nullptr);
 
@@ -3026,6 +3027,10 @@ static void p_chart_lscm_begin(PChart *chart, bool live, bool abf)
   }
 
   chart->context = EIG_linear_least_squares_solver_new(2 * chart->nfaces, 2 * chart->nverts, 1);
+
+  if (handle->lscm_iterative_min_verts > 0 && chart->nverts >= handle->lscm_iterative_min_verts) {
+    EIG_linear_solver_use_conjugate_gradient(chart->context, 1e-10);
+  }
 }
 
 static bool p_chart_lscm_solve(ParamHandle *handle, PChart *chart)
@@ -3956,50 +3961,79 @@ void uv_parametrizer_construct_end(ParamHandle *phandle,
   phandle->state = PHANDLE_STATE_CONSTRUCTED;
 }
 
+/** Solve a chart and fit the result to its pins, returns false if solving failed. */
+static bool p_chart_lscm_solve_and_fit(ParamHandle *handle, PChart *chart)
+{
+  const bool result = p_chart_lscm_solve(handle, chart);
+
+  if (result && !chart->has_pins) {
+    /* Every call to LSCM will eventually call uv_pack, so rotating here might be redundant. */
+    p_chart_rotate_minimum_area(chart);
+  }
+  else if (result && chart->single_pin) {
+    p_chart_rotate_fit_aabb(chart);
+    p_chart_lscm_transform_single_pin(chart);
+  }
+
+  if (!result || !chart->has_pins) {
+    p_chart_lscm_end(chart);
+  }
+
+  return result;
+}
+
 void uv_parametrizer_lscm_begin(ParamHandle *phandle, bool live, bool abf)
 {
   BLI_assert(phandle->state == PHANDLE_STATE_CONSTRUCTED);
   phandle->state = PHANDLE_STATE_LSCM;
 
-  for (int i = 0; i < phandle->ncharts; i++) {
-    for (PFace *f = phandle->charts[i]->faces; f; f = f->nextlink) {
-      p_face_backup_uvs(f);
-    }
-    p_chart_lscm_begin(phandle->charts[i], live, abf);
-  }
+  /* Charts don't share any data, each one builds its own solver. */
+  threading::parallel_for(
+      IndexRange(phandle->ncharts),
+      256,
+      [&](const IndexRange range) {
+        for (const int64_t i : range) {
+          for (PFace *f = phandle->charts[i]->faces; f; f = f->nextlink) {
+            p_face_backup_uvs(f);
+          }
+          p_chart_lscm_begin(phandle, phandle->charts[i], live, abf);
+        }
+      },
+      threading::individual_task_sizes(
+          [&](const int64_t i) { return phandle->charts[i]->nfaces; }));
 }
 
 void uv_parametrizer_lscm_solve(ParamHandle *phandle, int *count_changed, int *count_failed)
 {
   BLI_assert(phandle->state == PHANDLE_STATE_LSCM);
 
-  for (int i = 0; i < phandle->ncharts; i++) {
-    PChart *chart = phandle->charts[i];
-
-    if (!chart->context) {
-      continue;
-    }
-    const bool result = p_chart_lscm_solve(phandle, chart);
-
-    if (result && !chart->has_pins) {
-      /* Every call to LSCM will eventually call uv_pack, so rotating here might be redundant. */
-      p_chart_rotate_minimum_area(chart);
-    }
-    else if (result && chart->single_pin) {
-      p_chart_rotate_fit_aabb(chart);
-      p_chart_lscm_transform_single_pin(chart);
-    }
-
-    if (!result || !chart->has_pins) {
-      p_chart_lscm_end(chart);
-    }
+  enum class SolveResult : int8_t { Skipped, Changed, Failed };
+  Array<SolveResult> results(phandle->ncharts);
+
+  threading::parallel_for(
+      IndexRange(phandle->ncharts),
+      256,
+      [&](const IndexRange range) {
+        for (const int64_t i : range) {
+          PChart *chart = phandle->charts[i];
+          if (!chart->context) {
+            results[i] = SolveResult::Skipped;
+            continue;
+          }
+          results[i] = p_chart_lscm_solve_and_fit(phandle, chart) ? SolveResult::Changed :
+                                                                    SolveResult::Failed;
+        }
+      },
+      threading::individual_task_sizes(
+          [&](const int64_t i) { return phandle->charts[i]->nfaces; }));
 
-    if (result) {
+  for (const SolveResult result : results) {
+    if (result == SolveResult::Changed) {
       if (count_changed != nullptr) {
         *count_changed += 1;
       }
     }
-    else {
+    else if (result == SolveResult::Failed) {
       if (count_failed != nullptr) {
         *count_failed += 1;
       }
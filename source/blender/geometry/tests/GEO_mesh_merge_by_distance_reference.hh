@@ -0,0 +1,22 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "BLI_span.hh"
+
+struct Mesh;
+
+namespace blender::geometry::tests {
+
+/**
+ * The serial #mesh_merge_verts from before vertex welding was multi-threaded. The results of the
+ * multi-threaded version must be identical.
+ */
+Mesh *mesh_merge_verts_reference(const Mesh &mesh,
+                                 MutableSpan<int> vert_dest_map,
+                                 int vert_dest_map_len,
+                                 bool do_mix_vert_data);
+
+}  // namespace blender::geometry::tests
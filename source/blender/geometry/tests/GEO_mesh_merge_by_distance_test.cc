@@ -0,0 +1,304 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_spatial_hash.hh"
+#include "BLI_task.hh"
+
+#include "BKE_attribute.hh"
+#include "BKE_idtype.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.hh"
+
+#include "DNA_mesh_types.h"
+
+#include "GEO_mesh_merge_by_distance.hh"
+#include "GEO_mesh_merge_by_distance_reference.hh"
+#include "GEO_mesh_primitive_grid.hh"
+
+namespace blender::geometry::tests {
+
+class MeshMergeByDistanceTest : public ::testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+template<typename T>
+static void expect_attributes_identical(const Mesh &a,
+                                        const Mesh &b,
+                                        const StringRef name,
+                                        const bke::AttrDomain domain)
+{
+  const VArraySpan<T> values_a = *a.attributes().lookup<T>(name, domain);
+  const VArraySpan<T> values_b = *b.attributes().lookup<T>(name, domain);
+  EXPECT_EQ(values_a, values_b) << name;
+}
+
+static void expect_meshes_identical(const Mesh &a, const Mesh &b)
+{
+  EXPECT_EQ(a.vert_positions(), b.vert_positions());
+  EXPECT_EQ(a.edges(), b.edges());
+  EXPECT_EQ(a.face_offsets(), b.face_offsets());
+  EXPECT_EQ(a.corner_verts(), b.corner_verts());
+  EXPECT_EQ(a.corner_edges(), b.corner_edges());
+  expect_attributes_identical<float2>(a, b, "uv", bke::AttrDomain::Corner);
+}
+
+/**
+ * Create a mesh from faces given by their vertex indices, with the edges of the faces added after
+ * the \a loose_edges. Every domain gets an attribute with distinct values, so the results show
+ * which elements were kept and how the merged ones were mixed.
+ */
+static Mesh *create_mesh(const Span<float3> positions,
+                         const Span<int> face_sizes,
+                         const Span<int> corner_verts,
+                         const Span<int2> loose_edges = {})
+{
+  Mesh *mesh = BKE_mesh_new_nomain(
+      positions.size(), loose_edges.size(), face_sizes.size(), corner_verts.size());
+  mesh->vert_positions_for_write().copy_from(positions);
+  mesh->edges_for_write().copy_from(loose_edges);
+  MutableSpan<int> face_offsets = mesh->face_offsets_for_write();
+  face_offsets.drop_back(1).copy_from(face_sizes);
+  offset_indices::accumulate_counts_to_offsets(face_offsets);
+  mesh->corner_verts_for_write().copy_from(corner_verts);
+  bke::mesh_calc_edges(*mesh, true, false);
+
+  bke::MutableAttributeAccessor attributes = mesh->attributes_for_write();
+  const auto add_attribute = [&](const StringRef name, const bke::AttrDomain domain) {
+    bke::SpanAttributeWriter<float> attribute =
+        attributes.lookup_or_add_for_write_only_span<float>(name, domain);
+    for (const int i : attribute.span.index_range()) {
+      attribute.span[i] = float(i) * 0.75f + 1.0f;
+    }
+    attribute.finish();
+  };
+  add_attribute("vert_value", bke::AttrDomain::Point);
+  add_attribute("edge_value", bke::AttrDomain::Edge);
+  add_attribute("face_value", bke::AttrDomain::Face);
+  bke::SpanAttributeWriter<float2> uv = attributes.lookup_or_add_for_write_only_span<float2>(
+      "uv", bke::AttrDomain::Corner);
+  for (const int i : uv.span.index_range()) {
+    uv.span[i] = float2(float(i) * 0.125f, float(i % 3) * 0.5f);
+  }
+  uv.finish();
+  return mesh;
+}
+
+/**
+ * Merge the vertices with #mesh_merge_verts and with the serial version from before it was
+ * multi-threaded, and check that the results are identical, with and without mixing of custom
+ * data. Returns the result of #mesh_merge_verts with mixed custom data.
+ */
+static Mesh *expect_merge_verts_matches_reference(const Mesh &mesh, const Span<int> vert_dest_map)
+{
+  int vert_dest_map_len = 0;
+  for (const int i : vert_dest_map.index_range()) {
+    vert_dest_map_len += !ELEM(vert_dest_map[i], -1, i);
+  }
+
+  Mesh *mixed_result = nullptr;
+  for (const bool do_mix_data : {true, false}) {
+    Array<int> map = vert_dest_map;
+    Mesh *result = mesh_merge_verts(mesh, map, vert_dest_map_len, do_mix_data);
+    map = vert_dest_map;
+    Mesh *reference = mesh_merge_verts_reference(mesh, map, vert_dest_map_len, do_mix_data);
+
+    expect_meshes_identical(*result, *reference);
+    expect_attributes_identical<float>(*result, *reference, "vert_value", bke::AttrDomain::Point);
+    expect_attributes_identical<float>(*result, *reference, "edge_value", bke::AttrDomain::Edge);
+    expect_attributes_identical<float>(*result, *reference, "face_value", bke::AttrDomain::Face);
+
+    BKE_id_free(nullptr, reference);
+    if (do_mix_data) {
+      mixed_result = result;
+    }
+    else {
+      BKE_id_free(nullptr, result);
+    }
+  }
+  return mixed_result;
+}
+
+TEST_F(MeshMergeByDistanceTest, ChainedDoubles)
+{
+  /* A 2x2 grid of quads that don't share vertices. Four copies of the center vertex are merged
+   * into one, and the targets of the groups have lower and higher indices than their sources. */
+  const Array<float3> positions = {
+      {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {1, 0, 0}, {2, 0, 0}, {2, 1, 0}, {1, 1, 0},
+      {0, 1, 0}, {1, 1, 0}, {1, 2, 0}, {0, 2, 0}, {1, 1, 0}, {2, 1, 0}, {2, 2, 0}, {1, 2, 0}};
+  const Array<int> face_sizes = {4, 4, 4, 4};
+  const Array<int> corner_verts = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+  Mesh *mesh = create_mesh(positions, face_sizes, corner_verts);
+
+  Array<int> vert_dest_map(mesh->verts_num, -1);
+  for (const int i : {2, 7, 9}) {
+    vert_dest_map[i] = 12;
+  }
+  vert_dest_map[4] = 1;
+  vert_dest_map[3] = 8;
+  vert_dest_map[13] = 6;
+  vert_dest_map[10] = 15;
+
+  Mesh *result = expect_merge_verts_matches_reference(*mesh, vert_dest_map);
+  EXPECT_EQ(result->verts_num, 9);
+  EXPECT_EQ(result->edges_num, 12);
+  EXPECT_EQ(result->faces_num, 4);
+  EXPECT_EQ(result->corners_num, 16);
+
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshMergeByDistanceTest, CollapsedEdges)
+{
+  /* A quad that loses a corner, a triangle that collapses to a point and a loose edge that
+   * collapses. */
+  const Array<float3> positions = {{0, 0, 0},
+                                   {0.001f, 0, 0},
+                                   {1, 1, 0},
+                                   {0, 1, 0},
+                                   {3, 0, 0},
+                                   {3.001f, 0, 0},
+                                   {3, 0.001f, 0},
+                                   {5, 0, 0},
+                                   {5, 0.001f, 0}};
+  const Array<int> face_sizes = {4, 3};
+  const Array<int> corner_verts = {0, 1, 2, 3, 4, 5, 6};
+  const Array<int2> loose_edges = {{7, 8}};
+  Mesh *mesh = create_mesh(positions, face_sizes, corner_verts, loose_edges);
+
+  Array<int> vert_dest_map(mesh->verts_num, -1);
+  vert_dest_map[0] = 0;
+  vert_dest_map[1] = 0;
+  vert_dest_map[4] = 4;
+  vert_dest_map[5] = 4;
+  vert_dest_map[6] = 4;
+  vert_dest_map[7] = 7;
+  vert_dest_map[8] = 7;
+
+  Mesh *result = expect_merge_verts_matches_reference(*mesh, vert_dest_map);
+  EXPECT_EQ(result->verts_num, 5);
+  EXPECT_EQ(result->edges_num, 3);
+  EXPECT_EQ(result->faces_num, 1);
+  EXPECT_EQ(result->corners_num, 3);
+
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshMergeByDistanceTest, DoubledFaces)
+{
+  /* Three copies of a quad, the last one with flipped winding, and a triangle attached to the
+   * first copy. The copies become doubles of the first quad. */
+  const Array<float3> positions = {{0, 0, 0},
+                                   {1, 0, 0},
+                                   {1, 1, 0},
+                                   {0, 1, 0},
+                                   {0, 0, 0},
+                                   {1, 0, 0},
+                                   {1, 1, 0},
+                                   {0, 1, 0},
+                                   {0, 0, 0},
+                                   {1, 0, 0},
+                                   {1, 1, 0},
+                                   {0, 1, 0},
+                                   {1, 0, 0},
+                                   {1, 1, 0},
+                                   {2, 0.5f, 0}};
+  const Array<int> face_sizes = {4, 4, 4, 3};
+  const Array<int> corner_verts = {0, 1, 2, 3, 4, 5, 6, 7, 11, 10, 9, 8, 12, 14, 13};
+  Mesh *mesh = create_mesh(positions, face_sizes, corner_verts);
+
+  Array<int> vert_dest_map(mesh->verts_num, -1);
+  for (const int i : IndexRange(4)) {
+    vert_dest_map[i] = i;
+    vert_dest_map[i + 4] = i;
+    vert_dest_map[i + 8] = i;
+  }
+  vert_dest_map[12] = 1;
+  vert_dest_map[13] = 2;
+
+  Mesh *result = expect_merge_verts_matches_reference(*mesh, vert_dest_map);
+  EXPECT_EQ(result->verts_num, 5);
+  EXPECT_EQ(result->edges_num, 6);
+  EXPECT_EQ(result->faces_num, 2);
+  EXPECT_EQ(result->corners_num, 7);
+
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshMergeByDistanceTest, SplitFace)
+{
+  /* A hexagon with two opposite vertices merged, which splits it into two faces. */
+  const Array<float3> positions = {
+      {0, 0, 0}, {1, 0.5f, 0}, {2, 0, 0}, {2, 2, 0}, {1, 0.5f, 0}, {0, 2, 0}};
+  const Array<int> face_sizes = {6};
+  const Array<int> corner_verts = {0, 1, 2, 3, 4, 5};
+  Mesh *mesh = create_mesh(positions, face_sizes, corner_verts);
+
+  Array<int> vert_dest_map(mesh->verts_num, -1);
+  vert_dest_map[1] = 1;
+  vert_dest_map[4] = 1;
+
+  Mesh *result = expect_merge_verts_matches_reference(*mesh, vert_dest_map);
+  EXPECT_EQ(result->verts_num, 5);
+
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshMergeByDistanceTest, GridMatchesReference)
+{
+  /* Chains of vertices closer than the merge distance, with the merge map found the same way as
+   * #mesh_merge_by_distance_all. The grid is large enough to be processed by multiple threads. */
+  Mesh *mesh = create_grid_mesh(256, 256, 2.55f, 2.55f, bke::AttributeIDRef("uv"));
+  const float merge_distance = 0.015f;
+  const IndexMask selection(mesh->verts_num);
+  const Span<float3> positions = mesh->vert_positions();
+
+  Array<int> vert_dest_map(mesh->verts_num, -1);
+  const SpatialHash hash(positions, selection, merge_distance);
+  spatial_hash_calc_duplicates(hash, positions, selection, merge_distance, vert_dest_map);
+
+  Mesh *result = expect_merge_verts_matches_reference(*mesh, vert_dest_map);
+  EXPECT_LT(result->verts_num, mesh->verts_num);
+
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+#ifdef WITH_TBB
+TEST_F(MeshMergeByDistanceTest, ParallelMatchesSerial)
+{
+  /* The merge distance is larger than the spacing of the grid, so chains of vertices merge and
+   * the positions and UVs of many elements are mixed. The grid is large enough to be processed
+   * by multiple threads. */
+  Mesh *mesh = create_grid_mesh(256, 256, 2.55f, 2.55f, bke::AttributeIDRef("uv"));
+  const float merge_distance = 0.015f;
+  const IndexMask selection(mesh->verts_num);
+
+  std::optional<Mesh *> serial;
+  tbb::task_arena single_thread_arena(1);
+  single_thread_arena.execute(
+      [&]() { serial = mesh_merge_by_distance_all(*mesh, selection, merge_distance); });
+  std::optional<Mesh *> parallel = mesh_merge_by_distance_all(*mesh, selection, merge_distance);
+
+  ASSERT_TRUE(serial.has_value());
+  ASSERT_TRUE(parallel.has_value());
+  EXPECT_LT((*parallel)->verts_num, mesh->verts_num);
+  expect_meshes_identical(**serial, **parallel);
+
+  BKE_id_free(nullptr, *serial);
+  BKE_id_free(nullptr, *parallel);
+  BKE_id_free(nullptr, mesh);
+}
+#endif
+
+}  // namespace blender::geometry::tests
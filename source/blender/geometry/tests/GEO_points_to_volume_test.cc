@@ -0,0 +1,259 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_math_base.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+#include "BLI_timeit.hh"
+
+#include "BKE_idtype.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_volume.hh"
+#include "BKE_volume_grid.hh"
+
+#include "DNA_volume_types.h"
+
+#include "GEO_points_to_volume.hh"
+
+#ifdef WITH_OPENVDB
+#  include <openvdb/openvdb.h>
+#  include <openvdb/tools/LevelSetUtil.h>
+#  include <openvdb/tools/ParticlesToLevelSet.h>
+#  include <openvdb/tools/ValueTransformer.h>
+
+namespace blender::geometry::tests {
+
+/* Reference implementation, the points to volume conversion before leaf nodes were rasterized
+ * independently. */
+
+/* Implements the interface required by #openvdb::tools::ParticlesToLevelSet. */
+class OpenVDBParticleList {
+ public:
+  using PosType = openvdb::Vec3R;
+
+ private:
+  Span<float3> positions_;
+  Span<float> radii_;
+  float voxel_size_inv_;
+
+ public:
+  OpenVDBParticleList(const Span<float3> positions,
+                      const Span<float> radii,
+                      const float voxel_size)
+      : positions_(positions), radii_(radii), voxel_size_inv_(math::rcp(voxel_size))
+  {
+  }
+
+  size_t size() const
+  {
+    return size_t(positions_.size());
+  }
+
+  void getPos(size_t n, openvdb::Vec3R &xyz) const
+  {
+    float3 pos = positions_[n] * voxel_size_inv_;
+    pos -= float3(0.5f);
+    xyz = &pos.x;
+  }
+
+  void getPosRad(size_t n, openvdb::Vec3R &xyz, openvdb::Real &radius) const
+  {
+    this->getPos(n, xyz);
+    radius = radii_[n] * voxel_size_inv_;
+  }
+};
+
+static openvdb::FloatGrid::Ptr reference_sdf_grid(const Span<float3> positions,
+                                                  const Span<float> radii,
+                                                  const float voxel_size)
+{
+  openvdb::FloatGrid::Ptr grid = openvdb::FloatGrid::create(1.0f);
+  openvdb::tools::ParticlesToLevelSet op{*grid};
+  op.setRmin(0.0f);
+  op.setRmax(std::numeric_limits<float>::max());
+  OpenVDBParticleList particles{positions, radii, voxel_size};
+  op.rasterizeSpheres(particles);
+  op.finalize();
+  grid->transform().postScale(voxel_size);
+  grid->setGridClass(openvdb::GRID_LEVEL_SET);
+  return grid;
+}
+
+static openvdb::FloatGrid::Ptr reference_fog_grid(const Span<float3> positions,
+                                                  const Span<float> radii,
+                                                  const float voxel_size,
+                                                  const float density)
+{
+  openvdb::FloatGrid::Ptr grid = reference_sdf_grid(positions, radii, voxel_size);
+  grid->setGridClass(openvdb::GRID_FOG_VOLUME);
+  openvdb::tools::sdfToFogVolume(*grid);
+  openvdb::tools::foreach (grid->beginValueOn(), [&](const openvdb::FloatGrid::ValueOnIter &iter) {
+    iter.modifyValue([&](float &value) { value *= density; });
+  });
+  return grid;
+}
+
+/**
+ * Compare the value and active state of every voxel in the active bounds of both grids, with a
+ * margin of one voxel. Tiles and leaf nodes with the same voxels are considered equal.
+ */
+static void expect_grids_equal(const openvdb::FloatGrid &grid,
+                               const openvdb::FloatGrid &expected,
+                               const float epsilon)
+{
+  EXPECT_EQ(grid.background(), expected.background());
+  EXPECT_EQ(grid.getGridClass(), expected.getGridClass());
+  EXPECT_EQ(grid.transform(), expected.transform());
+  EXPECT_EQ(grid.activeVoxelCount(), expected.activeVoxelCount());
+
+  openvdb::CoordBBox bounds = grid.evalActiveVoxelBoundingBox();
+  bounds.expand(expected.evalActiveVoxelBoundingBox());
+  bounds.expand(1);
+  openvdb::FloatGrid::ConstAccessor accessor = grid.getConstAccessor();
+  openvdb::FloatGrid::ConstAccessor expected_accessor = expected.getConstAccessor();
+  int mismatches = 0;
+  for (const openvdb::Coord &coord : bounds) {
+    const bool active = accessor.isValueOn(coord);
+    const float value = accessor.getValue(coord);
+    const bool expected_active = expected_accessor.isValueOn(coord);
+    const float expected_value = expected_accessor.getValue(coord);
+    if (active != expected_active || std::abs(value - expected_value) > epsilon) {
+      /* Only report the first few differences. */
+      if (mismatches++ < 10) {
+        ADD_FAILURE() << "Voxel " << coord << ": " << value << (active ? " (on)" : " (off)")
+                      << ", expected " << expected_value
+                      << (expected_active ? " (on)" : " (off)");
+      }
+    }
+  }
+  EXPECT_EQ(mismatches, 0);
+}
+
+class PointsToVolumeTest : public ::testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+    BKE_volumes_init();
+  }
+
+  void expect_same_as_reference(const Span<float3> positions,
+                                const Span<float> radii,
+                                const float voxel_size)
+  {
+    const float epsilon = 1e-5f;
+    {
+      bke::VolumeGrid<float> sdf_grid = points_to_sdf_grid(positions, radii, voxel_size);
+      bke::VolumeTreeAccessToken tree_token;
+      const openvdb::FloatGrid &grid = sdf_grid.grid(tree_token);
+      expect_grids_equal(grid, *reference_sdf_grid(positions, radii, voxel_size), epsilon);
+    }
+    {
+      const float density = 0.5f;
+      Volume *volume = static_cast<Volume *>(BKE_id_new_nomain(ID_VO, nullptr));
+      bke::VolumeGridData *fog_grid = fog_volume_grid_add_from_points(
+          volume, "density", positions, radii, voxel_size, density);
+      bke::VolumeTreeAccessToken tree_token;
+      const openvdb::FloatGrid &grid = static_cast<const openvdb::FloatGrid &>(
+          fog_grid->grid(tree_token));
+      expect_grids_equal(
+          grid, *reference_fog_grid(positions, radii, voxel_size, density), epsilon);
+      BKE_id_free(nullptr, volume);
+    }
+  }
+};
+
+TEST_F(PointsToVolumeTest, SinglePoint)
+{
+  const Array<float3> positions = {float3(0.3f, 0.1f, 0.7f)};
+  const Array<float> radii = {0.5f};
+  this->expect_same_as_reference(positions, radii, 0.1f);
+}
+
+TEST_F(PointsToVolumeTest, MixedRadii)
+{
+  RandomNumberGenerator rng(42);
+  Array<float3> positions(200);
+  Array<float> radii(200);
+  for (const int i : positions.index_range()) {
+    positions[i] = float3(rng.get_float(), rng.get_float(), rng.get_float()) * 4.0f;
+    /* From less than half a voxel to several voxels. */
+    radii[i] = rng.get_float() * 0.5f + 0.01f;
+  }
+  this->expect_same_as_reference(positions, radii, 0.1f);
+}
+
+TEST_F(PointsToVolumeTest, ZeroRadius)
+{
+  const Array<float3> positions = {
+      float3(0.0f), float3(1.03f, 0.52f, 0.21f), float3(1.1f, 0.5f, 0.2f)};
+  const Array<float> radii = {0.0f, 0.0f, 0.3f};
+  this->expect_same_as_reference(positions, radii, 0.1f);
+}
+
+TEST_F(PointsToVolumeTest, RadiusLargerThanLeaf)
+{
+  /* Spheres spanning many leaf nodes of 8 voxels, the inner ones are pruned to tiles. */
+  const Array<float3> positions = {float3(0.0f), float3(2.5f, 0.4f, -0.3f)};
+  const Array<float> radii = {2.5f, 1.2f};
+  this->expect_same_as_reference(positions, radii, 0.1f);
+}
+
+TEST_F(PointsToVolumeTest, NegativeCoordinates)
+{
+  /* Points on both sides of leaf node and voxel boundaries at the origin. */
+  const Array<float3> positions = {float3(-0.05f, -0.05f, -0.05f),
+                                   float3(-3.21f, 0.77f, -1.6f),
+                                   float3(-12.8f, -12.8f, -12.8f),
+                                   float3(0.79f, -0.81f, 0.0f)};
+  const Array<float> radii = {0.2f, 0.35f, 0.6f, 0.1f};
+  this->expect_same_as_reference(positions, radii, 0.1f);
+}
+
+TEST_F(PointsToVolumeTest, Empty)
+{
+  bke::VolumeGrid<float> sdf_grid = points_to_sdf_grid({}, {}, 0.1f);
+  bke::VolumeTreeAccessToken tree_token;
+  const openvdb::FloatGrid &grid = sdf_grid.grid(tree_token);
+  EXPECT_TRUE(grid.empty());
+}
+
+/* Disable benchmark by default. */
+#  if 0
+TEST_F(PointsToVolumeTest, Benchmark)
+{
+  RandomNumberGenerator rng(0);
+  for (const int points_num : {10000, 1000000}) {
+    Array<float3> positions(points_num);
+    Array<float> radii(points_num);
+    for (const int i : positions.index_range()) {
+      positions[i] = float3(rng.get_float(), rng.get_float(), rng.get_float()) * 10.0f;
+      radii[i] = rng.get_float() * 0.05f + 0.01f;
+    }
+    {
+      SCOPED_TIMER(std::to_string(points_num) + " points, ParticlesToLevelSet");
+      reference_sdf_grid(positions, radii, 0.01f);
+    }
+    {
+      SCOPED_TIMER(std::to_string(points_num) + " points, SDF grid");
+      points_to_sdf_grid(positions, radii, 0.01f);
+    }
+    {
+      SCOPED_TIMER(std::to_string(points_num) + " points, sdfToFogVolume");
+      reference_fog_grid(positions, radii, 0.01f, 1.0f);
+    }
+    {
+      SCOPED_TIMER(std::to_string(points_num) + " points, fog grid");
+      Volume *volume = static_cast<Volume *>(BKE_id_new_nomain(ID_VO, nullptr));
+      fog_volume_grid_add_from_points(volume, "density", positions, radii, 0.01f, 1.0f);
+      BKE_id_free(nullptr, volume);
+    }
+  }
+}
+#  endif
+
+}  // namespace blender::geometry::tests
+#endif
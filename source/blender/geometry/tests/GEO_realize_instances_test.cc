@@ -0,0 +1,104 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_math_matrix.hh"
+
+#include "BKE_idtype.hh"
+#include "BKE_instances.hh"
+#include "BKE_mesh.hh"
+#include "BKE_pointcloud.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_pointcloud_types.h"
+
+#include "GEO_mesh_primitive_cuboid.hh"
+#include "GEO_realize_instances.hh"
+
+namespace blender::geometry::tests {
+
+class RealizeInstancesTest : public ::testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+static bke::GeometrySet create_instanced_geometry(const int instances_num)
+{
+  PointCloud *pointcloud = BKE_pointcloud_new_nomain(5);
+  MutableSpan<float3> point_positions = pointcloud->positions_for_write();
+  for (const int i : point_positions.index_range()) {
+    point_positions[i] = float3(i, 0.0f, 0.0f);
+  }
+  Mesh *mesh = create_cuboid_mesh(float3(1.0f), 3, 2, 2);
+
+  bke::Instances *instances = new bke::Instances();
+  const int mesh_handle = instances->add_reference(
+      bke::InstanceReference(bke::GeometrySet::from_mesh(mesh)));
+  const int pointcloud_handle = instances->add_reference(
+      bke::InstanceReference(bke::GeometrySet::from_pointcloud(pointcloud)));
+  for (const int i : IndexRange(instances_num)) {
+    const float4x4 transform = math::from_location<float4x4>(float3(0.0f, i, 0.0f));
+    instances->add_instance(i % 3 == 0 ? pointcloud_handle : mesh_handle, transform);
+  }
+  return bke::GeometrySet::from_instances(instances);
+}
+
+TEST_F(RealizeInstancesTest, ChunkedMatchesJoined)
+{
+  const bke::GeometrySet geometry = create_instanced_geometry(20);
+  const RealizeInstancesOptions options;
+  const bke::GeometrySet expected = realize_instances(geometry, options);
+  const Mesh &expected_mesh = *expected.get_mesh();
+  const PointCloud &expected_pointcloud = *expected.get_pointcloud();
+
+  Vector<float3> mesh_positions;
+  Vector<int> corner_verts;
+  Vector<float3> point_positions;
+  int edges_num = 0;
+  int faces_num = 0;
+  int chunks_num = 0;
+  realize_instances_chunked(geometry, options, 100, [&](bke::GeometrySet &chunk) {
+    chunks_num++;
+    if (const Mesh *mesh = chunk.get_mesh()) {
+      const int vert_offset = mesh_positions.size();
+      mesh_positions.extend(mesh->vert_positions());
+      for (const int vert : mesh->corner_verts()) {
+        corner_verts.append(vert + vert_offset);
+      }
+      edges_num += mesh->edges_num;
+      faces_num += mesh->faces_num;
+    }
+    if (const PointCloud *pointcloud = chunk.get_pointcloud()) {
+      point_positions.extend(pointcloud->positions());
+    }
+  });
+
+  EXPECT_GT(chunks_num, 2);
+  EXPECT_EQ(mesh_positions.as_span(), expected_mesh.vert_positions());
+  EXPECT_EQ(corner_verts.as_span(), expected_mesh.corner_verts());
+  EXPECT_EQ(edges_num, expected_mesh.edges_num);
+  EXPECT_EQ(faces_num, expected_mesh.faces_num);
+  EXPECT_EQ(point_positions.as_span(), expected_pointcloud.positions());
+}
+
+TEST_F(RealizeInstancesTest, ChunkLargerThanLimit)
+{
+  /* Every instance is larger than the limit, so each one gets its own chunk. */
+  const bke::GeometrySet geometry = create_instanced_geometry(6);
+  const RealizeInstancesOptions options;
+  int mesh_chunks_num = 0;
+  int pointcloud_chunks_num = 0;
+  realize_instances_chunked(geometry, options, 1, [&](bke::GeometrySet &chunk) {
+    mesh_chunks_num += chunk.has_mesh();
+    pointcloud_chunks_num += chunk.has_pointcloud();
+  });
+  EXPECT_EQ(mesh_chunks_num, 4);
+  EXPECT_EQ(pointcloud_chunks_num, 2);
+}
+
+}  // namespace blender::geometry::tests
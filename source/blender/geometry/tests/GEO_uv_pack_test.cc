@@ -0,0 +1,95 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_task.hh"
+#include "BLI_timeit.hh"
+
+#include "GEO_uv_pack.hh"
+
+namespace blender::geometry::tests {
+
+struct PackResult {
+  float scale;
+  Vector<float2> translations;
+  Vector<float> angles;
+};
+
+static void add_rectangle(PackIsland &island, const float2 min, const float2 max)
+{
+  island.add_triangle(min, float2(max.x, min.y), max);
+  island.add_triangle(min, max, float2(min.x, max.y));
+}
+
+/* L-shaped islands of varying size and proportions, which don't fill their bounding boxes so the
+ * concave packer places them into each other. */
+static PackResult pack_island_corpus(const int islands_num, const UVPackIsland_Params &params)
+{
+  Vector<std::unique_ptr<PackIsland>> islands;
+  for (const int i : IndexRange(islands_num)) {
+    std::unique_ptr<PackIsland> island = std::make_unique<PackIsland>();
+    const float width = 0.2f + 0.05f * (i % 7);
+    const float height = 0.1f + 0.07f * (i % 5);
+    const float thickness = 0.3f * std::min(width, height);
+    add_rectangle(*island, float2(0.0f), float2(width, thickness));
+    add_rectangle(*island, float2(0.0f, thickness), float2(thickness, height));
+    island->caller_index = i;
+    islands.append(std::move(island));
+  }
+
+  Vector<PackIsland *> island_ptrs;
+  for (std::unique_ptr<PackIsland> &island : islands) {
+    island_ptrs.append(island.get());
+  }
+
+  PackResult result;
+  result.scale = pack_islands(island_ptrs, params);
+  for (const PackIsland *island : island_ptrs) {
+    result.translations.append(island->pre_translate);
+    result.angles.append(island->angle);
+  }
+  return result;
+}
+
+static UVPackIsland_Params concave_params()
+{
+  UVPackIsland_Params params;
+  params.shape_method = ED_UVPACK_SHAPE_CONCAVE;
+  params.rotate_method = ED_UVPACK_ROTATION_ANY;
+  params.margin = 0.01f;
+  return params;
+}
+
+#ifdef WITH_TBB
+TEST(uv_pack, ParallelMatchesSerial)
+{
+  /* Islands are written to the occupancy bitmap in parallel over bands of rows, which must give
+   * the same layout as writing them from a single thread. */
+  const UVPackIsland_Params params = concave_params();
+
+  PackResult serial;
+  tbb::task_arena single_thread_arena(1);
+  single_thread_arena.execute([&]() { serial = pack_island_corpus(200, params); });
+  const PackResult parallel = pack_island_corpus(200, params);
+
+  EXPECT_EQ(serial.scale, parallel.scale);
+  EXPECT_EQ(serial.translations, parallel.translations);
+  EXPECT_EQ(serial.angles, parallel.angles);
+}
+#endif
+
+/* Disable benchmark by default. */
+#if 0
+TEST(uv_pack, Benchmark)
+{
+  const UVPackIsland_Params params = concave_params();
+  for (const int islands_num : {100, 1000, 5000}) {
+    SCOPED_TIMER(std::to_string(islands_num) + " islands");
+    pack_island_corpus(islands_num, params);
+  }
+}
+#endif
+
+}  // namespace blender::geometry::tests
@@ -0,0 +1,74 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_math_vector_types.hh"
+
+#include "GEO_uv_parametrizer.hh"
+
+namespace blender::geometry::tests {
+
+/* Unwrap a wavy grid of quads as a single chart with LSCM, and return the UV of every corner. */
+static Array<float2> unwrap_wavy_grid(const int resolution, const int lscm_iterative_min_verts)
+{
+  const int verts_x = resolution + 1;
+  Array<float3> positions(verts_x * verts_x);
+  for (const int y : IndexRange(verts_x)) {
+    for (const int x : IndexRange(verts_x)) {
+      positions[y * verts_x + x] = float3(
+          x * 0.1f, y * 0.1f, 0.2f * std::sin(x * 0.3f) * std::cos(y * 0.2f));
+    }
+  }
+
+  Array<float2> uvs(resolution * resolution * 4, float2(0.0f));
+
+  ParamHandle *handle = new ParamHandle();
+  handle->lscm_iterative_min_verts = lscm_iterative_min_verts;
+  for (const int y : IndexRange(resolution)) {
+    for (const int x : IndexRange(resolution)) {
+      const int face = y * resolution + x;
+      const int v = y * verts_x + x;
+      const ParamKey vkeys[4] = {
+          ParamKey(v), ParamKey(v + 1), ParamKey(v + verts_x + 1), ParamKey(v + verts_x)};
+      const float *co[4];
+      float *uv[4];
+      for (const int i : IndexRange(4)) {
+        co[i] = positions[vkeys[i]];
+        uv[i] = uvs[face * 4 + i];
+      }
+      const bool pin[4] = {false, false, false, false};
+      const bool select[4] = {false, false, false, false};
+      uv_parametrizer_face_add(handle, face, 4, vkeys, co, uv, pin, select);
+    }
+  }
+
+  uv_parametrizer_construct_end(handle, false, false, nullptr);
+  uv_parametrizer_lscm_begin(handle, false, false);
+  int count_changed = 0;
+  int count_failed = 0;
+  uv_parametrizer_lscm_solve(handle, &count_changed, &count_failed);
+  uv_parametrizer_lscm_end(handle);
+  uv_parametrizer_flush(handle);
+  delete handle;
+
+  EXPECT_EQ(count_changed, 1);
+  EXPECT_EQ(count_failed, 0);
+  return uvs;
+}
+
+TEST(uv_parametrizer, LSCMConjugateGradientMatchesFactorization)
+{
+  const Array<float2> factorized = unwrap_wavy_grid(40, 0);
+  const Array<float2> iterative = unwrap_wavy_grid(40, 1);
+
+  ASSERT_EQ(factorized.size(), iterative.size());
+  for (const int i : factorized.index_range()) {
+    EXPECT_NEAR(factorized[i].x, iterative[i].x, 1e-4f);
+    EXPECT_NEAR(factorized[i].y, iterative[i].y, 1e-4f);
+  }
+}
+
+}  // namespace blender::geometry::tests
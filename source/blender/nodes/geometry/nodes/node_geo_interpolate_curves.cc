@@ -6,6 +6,7 @@
 
 #include "BLI_math_vector.hh"
 
+#include "BLI_enumerable_thread_specific.hh"
 #include "BLI_kdtree.h"
 #include "BLI_length_parameterize.hh"
 #include "BLI_math_rotation.h"
@@ -135,24 +136,49 @@ static void find_neighbor_guides(const Span<float3> positions,
                                  MutableSpan<float> r_all_neighbor_weights,
                                  MutableSpan<int> r_all_neighbor_counts)
 {
+  /* Look up the tree and the number of guides of every group once, instead of for every child,
+   * and use a buffer per thread for the query results instead of one per child. */
+  IndexMaskMemory memory;
+  VectorSet<int> group_ids;
+  const Vector<IndexMask, 4> children_by_group = IndexMask::from_group_ids(
+      point_group_ids, memory, group_ids);
+  Array<const KDTree_3d *> kdtree_by_group(group_ids.size());
+  Array<int> neighbors_to_find_by_group(group_ids.size());
+  Array<int> group_index_by_child(positions.size());
+  threading::parallel_for(group_ids.index_range(), 1, [&](const IndexRange range) {
+    for (const int group_i : range) {
+      const int group = group_ids[group_i];
+      kdtree_by_group[group_i] = kdtrees.lookup_default(group, nullptr);
+
+      const int num_guides_in_group = guides_by_group.lookup(group).size();
+      /* Finding an additional neighbor that currently has weight zero is necessary to ensure that
+       * curves close by but with different guides still look similar. Otherwise there can be
+       * visible artifacts. */
+      const bool use_extra_neighbor = num_guides_in_group > max_neighbor_count;
+      neighbors_to_find_by_group[group_i] = max_neighbor_count + use_extra_neighbor;
+
+      index_mask::masked_fill(
+          group_index_by_child.as_mutable_span(), group_i, children_by_group[group_i]);
+    }
+  });
+
+  threading::EnumerableThreadSpecific<Array<KDTreeNearest_3d>> nearest_per_thread(
+      [&]() { return Array<KDTreeNearest_3d>(max_neighbor_count + 1); });
+
   threading::parallel_for(positions.index_range(), 128, [&](const IndexRange range) {
     for (const int child_curve_i : range) {
       const float3 &position = positions[child_curve_i];
-      const int group = point_group_ids[child_curve_i];
-      const KDTree_3d *kdtree = kdtrees.lookup_default(group, nullptr);
+      const int group_i = group_index_by_child[child_curve_i];
+      const KDTree_3d *kdtree = kdtree_by_group[group_i];
       if (kdtree == nullptr) {
         r_all_neighbor_counts[child_curve_i] = 0;
         continue;
       }
 
-      const int num_guides_in_group = guides_by_group.lookup(group).size();
-      /* Finding an additional neighbor that currently has weight zero is necessary to ensure that
-       * curves close by but with different guides still look similar. Otherwise there can be
-       * visible artifacts. */
-      const bool use_extra_neighbor = num_guides_in_group > max_neighbor_count;
-      const int neighbors_to_find = max_neighbor_count + use_extra_neighbor;
-
-      Vector<KDTreeNearest_3d, 16> nearest_n(neighbors_to_find);
+      const int neighbors_to_find = neighbors_to_find_by_group[group_i];
+      const bool use_extra_neighbor = neighbors_to_find > max_neighbor_count;
+      MutableSpan<KDTreeNearest_3d> nearest_n =
+          nearest_per_thread.local().as_mutable_span().take_front(neighbors_to_find);
       const int num_neighbors = BLI_kdtree_3d_find_nearest_n(
           kdtree, position, nearest_n.data(), neighbors_to_find);
       if (num_neighbors == 0) {
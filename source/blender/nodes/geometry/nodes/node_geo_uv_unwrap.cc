@@ -82,6 +82,8 @@ static VArray<float3> construct_uv_gvarray(const Mesh &mesh,
   Array<float3> uv(corner_verts.size(), float3(0));
 
   geometry::ParamHandle *handle = new geometry::ParamHandle();
+  /* Factorizing the LSCM system of very large charts takes a lot of memory and time. */
+  handle->lscm_iterative_min_verts = 100000;
   selection.foreach_index([&](const int face_index) {
     const IndexRange face = faces[face_index];
     Array<geometry::ParamKey, 16> mp_vkeys(face.size());
@@ -81,6 +81,23 @@ bool RE_bake_engine(struct Render *re,
                     int pass_filter,
                     float result[]);
 
+/**
+ * Bake multiple objects in a single render engine session on one dependency graph. The engine is
+ * updated before every object, which lets engines with persistent data keep their synchronized
+ * scene. #RE_bake_engine is equivalent to baking a single object between #RE_bake_engine_begin
+ * and #RE_bake_engine_end.
+ */
+bool RE_bake_engine_begin(struct Render *re, struct Depsgraph *depsgraph);
+bool RE_bake_engine_object(struct Render *re,
+                           struct Object *object,
+                           int object_id,
+                           const BakePixel pixel_array[],
+                           const BakeTargets *targets,
+                           eScenePassType pass_type,
+                           int pass_filter,
+                           float result[]);
+void RE_bake_engine_end(struct Render *re);
+
 /* `bake.cc` */
 
 int RE_pass_depth(eScenePassType pass_type);
@@ -742,15 +742,7 @@ bool RE_bake_has_engine(const Render *re)
   return (type->bake != nullptr);
 }
 
-bool RE_bake_engine(Render *re,
-                    Depsgraph *depsgraph,
-                    Object *object,
-                    const int object_id,
-                    const BakePixel pixel_array[],
-                    const BakeTargets *targets,
-                    const eScenePassType pass_type,
-                    const int pass_filter,
-                    float result[])
+bool RE_bake_engine_begin(Render *re, Depsgraph *depsgraph)
 {
   RenderEngineType *type = RE_engines_find(re->r.engine);
   RenderEngine *engine;
@@ -777,8 +769,27 @@ bool RE_bake_engine(Render *re,
 
   if (type->bake) {
     engine->depsgraph = depsgraph;
+  }
+
+  return true;
+}
+
+bool RE_bake_engine_object(Render *re,
+                           Object *object,
+                           const int object_id,
+                           const BakePixel pixel_array[],
+                           const BakeTargets *targets,
+                           const eScenePassType pass_type,
+                           const int pass_filter,
+                           float result[])
+{
+  RenderEngine *engine = re->engine;
+  RenderEngineType *type = engine->type;
 
-    /* update is only called so we create the engine.session */
+  if (type->bake) {
+    /* Update is only called so we create the engine.session. This happens for every object,
+     * since finishing the previous object may have freed the synchronized scene when persistent
+     * data is disabled. */
     if (type->update) {
       type->update(engine, re->main, engine->depsgraph);
     }
@@ -804,10 +815,24 @@ bool RE_bake_engine(Render *re,
     }
 
     memset(&engine->bake, 0, sizeof(engine->bake));
+  }
 
-    engine->depsgraph = nullptr;
+  if (BKE_reports_contain(re->reports, RPT_ERROR)) {
+    G.is_break = true;
+  }
+
+  return true;
+}
+
+void RE_bake_engine_end(Render *re)
+{
+  RenderEngine *engine = re->engine;
+
+  if (!engine) {
+    return;
   }
 
+  engine->depsgraph = nullptr;
   engine->flag &= ~RE_ENGINE_RENDERING;
 
   engine_depsgraph_free(engine);
@@ -818,8 +843,25 @@ bool RE_bake_engine(Render *re,
   if (BKE_reports_contain(re->reports, RPT_ERROR)) {
     G.is_break = true;
   }
+}
 
-  return true;
+bool RE_bake_engine(Render *re,
+                    Depsgraph *depsgraph,
+                    Object *object,
+                    const int object_id,
+                    const BakePixel pixel_array[],
+                    const BakeTargets *targets,
+                    const eScenePassType pass_type,
+                    const int pass_filter,
+                    float result[])
+{
+  bool ok = RE_bake_engine_begin(re, depsgraph);
+  if (ok) {
+    ok = RE_bake_engine_object(
+        re, object, object_id, pixel_array, targets, pass_type, pass_filter, result);
+  }
+  RE_bake_engine_end(re);
+  return ok;
 }
 
 /* Render */
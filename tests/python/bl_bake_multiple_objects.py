@@ -0,0 +1,84 @@
+# SPDX-FileCopyrightText: 2024 Blender Authors
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+# ./blender.bin --background --factory-startup --python tests/python/bl_bake_multiple_objects.py
+import unittest
+
+import bpy
+
+
+IMAGE_SIZE = 32
+COLORS = (
+    (1.0, 0.0, 0.0),
+    (0.0, 1.0, 0.0),
+    (0.0, 0.0, 1.0),
+)
+
+
+class TestBakeMultipleObjects(unittest.TestCase):
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+
+        scene = bpy.context.scene
+        scene.render.engine = 'CYCLES'
+        scene.cycles.device = 'CPU'
+        scene.cycles.samples = 1
+        scene.render.bake.target = 'IMAGE_TEXTURES'
+        scene.render.bake.use_selected_to_active = False
+
+        self.images = []
+        for i, color in enumerate(COLORS):
+            bpy.ops.mesh.primitive_plane_add(location=(i * 3.0, 0.0, 0.0))
+            ob = bpy.context.active_object
+
+            image = bpy.data.images.new("Bake{:d}".format(i), IMAGE_SIZE, IMAGE_SIZE, float_buffer=True)
+            self.images.append(image)
+
+            material = bpy.data.materials.new("Emit{:d}".format(i))
+            material.use_nodes = True
+            nodes = material.node_tree.nodes
+            nodes.clear()
+            emission = nodes.new('ShaderNodeEmission')
+            emission.inputs["Color"].default_value = (*color, 1.0)
+            output = nodes.new('ShaderNodeOutputMaterial')
+            material.node_tree.links.new(emission.outputs["Emission"], output.inputs["Surface"])
+            image_node = nodes.new('ShaderNodeTexImage')
+            image_node.image = image
+            nodes.active = image_node
+            ob.data.materials.append(material)
+
+        for ob in scene.objects:
+            ob.select_set(True)
+
+    def bake_and_check(self):
+        result = bpy.ops.object.bake(type='EMIT')
+        self.assertEqual(result, {'FINISHED'})
+
+        # Every object was baked into its own image, not only the first one.
+        center = ((IMAGE_SIZE // 2) * IMAGE_SIZE + IMAGE_SIZE // 2) * 4
+        for image, color in zip(self.images, COLORS):
+            pixel = image.pixels[center:center + 3]
+            for value, expected in zip(pixel, color):
+                self.assertAlmostEqual(value, expected, places=3, msg=image.name)
+
+    def test_bake(self):
+        self.bake_and_check()
+
+    def test_bake_persistent_data(self):
+        bpy.context.scene.render.use_persistent_data = True
+        self.bake_and_check()
+
+    def test_bake_tiled(self):
+        # Tiles are written to disk and read back when finishing each object.
+        scene = bpy.context.scene
+        scene.cycles.use_auto_tile = True
+        scene.cycles.tile_size = 8
+        self.bake_and_check()
+
+
+if __name__ == '__main__':
+    import sys
+
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()